@@ -1,74 +1,306 @@
 #define ALICE_NO_ENTRY_POINT 1
 #include "main.cpp"
 
+/*
+Desync analyzer for OOS dumps (see sys::state::debug_save_oos_dump).
+
+	save_editor <dump 1> <dump 2>
+		lists, for every record that differs, the entity index, the property and both values of each mismatching element
+
+	save_editor -bisect <directory 1> <directory 2>
+		both directories hold one dump per tick (matched by the date at the end of the file name); finds the first tick at which
+		the dumps diverge and lists its differences as above
+
+Paths are relative to the oos directory.
+*/
+
+struct dump_record {
+	std::string_view object;
+	std::string_view property;
+	std::string_view type;
+	std::byte const* data_start = nullptr;
+	std::byte const* data_end = nullptr;
+};
+
+struct dump_index {
+	std::vector<dump_record> records; // in file order
+	ankerl::unordered_dense::map<std::string, uint32_t> by_name; // "object.property" -> index into records
+	ankerl::unordered_dense::map<std::string_view, uint32_t> object_sizes;
+};
+
+dump_index index_dump(simple_fs::file_contents const& contents) {
+	dump_index result;
+	auto const* start = reinterpret_cast<std::byte const*>(contents.data);
+	dcon::for_each_record(start, start + contents.file_size, [&](dcon::record_header const& header, std::byte const* data_start, std::byte const* data_end) {
+		dump_record r;
+		r.object = std::string_view{ header.object_name_start, header.object_name_end };
+		r.property = std::string_view{ header.property_name_start, header.property_name_end };
+		r.type = std::string_view{ header.type_name_start, header.type_name_end };
+		r.data_start = data_start;
+		r.data_end = data_end;
+		if(r.property == "_size" && data_end - data_start == ptrdiff_t(sizeof(uint32_t))) {
+			uint32_t count = 0;
+			std::memcpy(&count, data_start, sizeof(uint32_t));
+			result.object_sizes.insert_or_assign(r.object, count);
+		}
+		result.by_name.insert_or_assign(std::string(r.object) + "." + std::string(r.property), uint32_t(result.records.size()));
+		result.records.push_back(r);
+	});
+	return result;
+}
+
+template<typename T>
+std::string element_to_string(std::byte const* p) {
+	T v;
+	std::memcpy(&v, p, sizeof(T));
+	if constexpr(std::is_floating_point_v<T>) {
+		char buffer[64];
+		std::snprintf(buffer, sizeof(buffer), "%.9g", double(v));
+		return buffer;
+	} else {
+		return std::to_string(v);
+	}
+}
+
+std::string element_to_string(std::string_view type, std::byte const* p, size_t element_size) {
+	if(type == "float" && element_size == sizeof(float))
+		return element_to_string<float>(p);
+	if(type == "double" && element_size == sizeof(double))
+		return element_to_string<double>(p);
+	if(type == "int8_t" && element_size == 1)
+		return element_to_string<int8_t>(p);
+	if(type == "int16_t" && element_size == 2)
+		return element_to_string<int16_t>(p);
+	if(type == "int32_t" && element_size == 4)
+		return element_to_string<int32_t>(p);
+	if(type == "int64_t" && element_size == 8)
+		return element_to_string<int64_t>(p);
+	// ids, dates, enums and the like: unsigned integers of their stored width
+	switch(element_size) {
+	case 1:
+		return element_to_string<uint8_t>(p);
+	case 2:
+		return element_to_string<uint16_t>(p);
+	case 4:
+		return element_to_string<uint32_t>(p);
+	case 8:
+		return element_to_string<uint64_t>(p);
+	default:
+		break;
+	}
+	std::string result;
+	char buffer[4];
+	for(size_t i = 0; i < element_size; ++i) {
+		std::snprintf(buffer, sizeof(buffer), "%02x", unsigned(p[i]));
+		result += buffer;
+	}
+	return result;
+}
+
+// appends a description of every mismatching element to out, returns the number of mismatching elements
+uint32_t diff_record(dump_record const& a, dump_record const& b, uint32_t count_a, uint32_t count_b, std::string& out) {
+	auto size_a = size_t(a.data_end - a.data_start);
+	auto size_b = size_t(b.data_end - b.data_start);
+	if(size_a == size_b && std::memcmp(a.data_start, b.data_start, size_a) == 0)
+		return 0;
+
+	std::string name = std::string(a.object) + "." + std::string(a.property) + " (" + std::string(a.type) + ")";
+	uint32_t mismatches = 0;
+
+	if(count_a != count_b) {
+		out += name + ": " + std::to_string(count_a) + " / " + std::to_string(count_b) + " entities\n";
+		++mismatches;
+	}
+	auto count = std::min(count_a, count_b);
+
+	if((a.type == "bool" || a.type == "bitfield") && count > 0 && size_a == (count_a + 7) / 8 && size_b == (count_b + 7) / 8) {
+		for(uint32_t i = 0; i < count; ++i) {
+			bool va = (uint8_t(a.data_start[i / 8]) >> (i % 8)) & 1;
+			bool vb = (uint8_t(b.data_start[i / 8]) >> (i % 8)) & 1;
+			if(va != vb) {
+				out += std::string(a.object) + "[" + std::to_string(i) + "]." + std::string(a.property) + ": " + (va ? "true" : "false") + " / " + (vb ? "true" : "false") + "\n";
+				++mismatches;
+			}
+		}
+		return mismatches;
+	}
+
+	if(count > 0 && count_a > 0 && count_b > 0 && size_a % count_a == 0 && size_b % count_b == 0 && size_a / count_a == size_b / count_b) {
+		auto element_size = size_a / count_a;
+		for(uint32_t i = 0; i < count; ++i) {
+			auto pa = a.data_start + i * element_size;
+			auto pb = b.data_start + i * element_size;
+			if(std::memcmp(pa, pb, element_size) != 0) {
+				out += std::string(a.object) + "[" + std::to_string(i) + "]." + std::string(a.property) + ": "
+					+ element_to_string(a.type, pa, element_size) + " / " + element_to_string(b.type, pb, element_size) + "\n";
+				++mismatches;
+			}
+		}
+		return mismatches;
+	}
+
+	// variable sized data (arrays, pools): report the differing byte ranges
+	auto common = std::min(size_a, size_b);
+	size_t i = 0;
+	while(i < common) {
+		if(a.data_start[i] != b.data_start[i]) {
+			size_t first = i;
+			while(i < common && a.data_start[i] != b.data_start[i])
+				++i;
+			out += name + ": bytes [" + std::to_string(first) + ", " + std::to_string(i) + ") differ\n";
+			++mismatches;
+		} else {
+			++i;
+		}
+	}
+	if(size_a != size_b) {
+		out += name + ": " + std::to_string(size_a) + " / " + std::to_string(size_b) + " bytes\n";
+		++mismatches;
+	}
+	return mismatches;
+}
+
+uint32_t object_size(dump_index const& d, std::string_view object) {
+	if(auto it = d.object_sizes.find(object); it != d.object_sizes.end())
+		return it->second;
+	return 0; // unknown: compared byte by byte
+}
+
+// compares the records of both dumps in parallel and prints the differences in the order of the first dump
+uint32_t diff_dumps(dump_index const& a, dump_index const& b, bool print) {
+	std::vector<std::string> outputs(a.records.size());
+	std::vector<uint32_t> counts(a.records.size(), 0);
+	concurrency::parallel_for(size_t(0), a.records.size(), [&](size_t i) {
+		auto const& ra = a.records[i];
+		auto it = b.by_name.find(std::string(ra.object) + "." + std::string(ra.property));
+		if(it == b.by_name.end()) {
+			outputs[i] = std::string(ra.object) + "." + std::string(ra.property) + ": only in the first dump\n";
+			counts[i] = 1;
+			return;
+		}
+		auto const& rb = b.records[it->second];
+		counts[i] = diff_record(ra, rb, object_size(a, ra.object), object_size(b, rb.object), outputs[i]);
+	});
+
+	uint32_t total = 0;
+	for(size_t i = 0; i < outputs.size(); ++i) {
+		total += counts[i];
+		if(print && !outputs[i].empty())
+			std::printf("%s", outputs[i].c_str());
+	}
+	for(auto const& rb : b.records) {
+		if(a.by_name.find(std::string(rb.object) + "." + std::string(rb.property)) == a.by_name.end()) {
+			++total;
+			if(print)
+				std::printf("%.*s.%.*s: only in the second dump\n", int(rb.object.size()), rb.object.data(), int(rb.property.size()), rb.property.data());
+		}
+	}
+	return total;
+}
+
+// dumps are named Party-TAG-year-month-day.bin; the key sorts by that date
+uint32_t dump_date_key(native_string const& name) {
+	auto utf8 = simple_fs::native_to_utf8(name);
+	auto dot = utf8.rfind('.');
+	if(dot != std::string::npos)
+		utf8 = utf8.substr(0, dot);
+	uint32_t parts[3] = { 0, 0, 0 };
+	for(int32_t i = 2; i >= 0; --i) {
+		auto dash = utf8.rfind('-');
+		auto part = dash == std::string::npos ? utf8 : utf8.substr(dash + 1);
+		parts[i] = uint32_t(std::strtoul(part.c_str(), nullptr, 10));
+		if(dash == std::string::npos)
+			break;
+		utf8 = utf8.substr(0, dash);
+	}
+	return parts[0] * 10000 + parts[1] * 100 + parts[2];
+}
+
+struct tick_dumps {
+	uint32_t date_key = 0;
+	simple_fs::unopened_file first;
+	simple_fs::unopened_file second;
+};
+
+int bisect(native_string_view dir_1, native_string_view dir_2) {
+	auto oos_dir = simple_fs::get_or_create_oos_directory();
+	auto files_1 = simple_fs::list_files(simple_fs::open_directory(oos_dir, dir_1), NATIVE(".bin"));
+	auto files_2 = simple_fs::list_files(simple_fs::open_directory(oos_dir, dir_2), NATIVE(".bin"));
+
+	std::vector<tick_dumps> ticks;
+	for(auto& f1 : files_1) {
+		auto key = dump_date_key(simple_fs::get_file_name(f1));
+		for(auto& f2 : files_2) {
+			if(dump_date_key(simple_fs::get_file_name(f2)) == key) {
+				ticks.push_back(tick_dumps{ key, f1, f2 });
+				break;
+			}
+		}
+	}
+	std::sort(ticks.begin(), ticks.end(), [](tick_dumps const& a, tick_dumps const& b) { return a.date_key < b.date_key; });
+	if(ticks.empty()) {
+		std::printf("No matching dumps\n");
+		return EXIT_FAILURE;
+	}
+
+	auto differs = [&](tick_dumps const& t, bool print) {
+		auto file_1 = simple_fs::open_file(t.first);
+		auto file_2 = simple_fs::open_file(t.second);
+		if(!file_1 || !file_2)
+			return true;
+		auto contents_1 = simple_fs::view_contents(*file_1);
+		auto contents_2 = simple_fs::view_contents(*file_2);
+		if(!print && contents_1.file_size == contents_2.file_size && std::memcmp(contents_1.data, contents_2.data, contents_1.file_size) == 0)
+			return false;
+		return diff_dumps(index_dump(contents_1), index_dump(contents_2), print) != 0;
+	};
+
+	// once the states have diverged they stay diverged, so the first diverging tick can be found by bisection
+	size_t first = 0;
+	size_t last = ticks.size(); // ticks[last] is known to diverge, if it exists
+	while(first < last) {
+		auto mid = first + (last - first) / 2;
+		if(differs(ticks[mid], false))
+			last = mid;
+		else
+			first = mid + 1;
+	}
+	if(first == ticks.size()) {
+		std::printf("All %u ticks match\n", uint32_t(ticks.size()));
+		return EXIT_SUCCESS;
+	}
+	std::printf("First diverging tick: %s / %s\n", simple_fs::native_to_utf8(simple_fs::get_file_name(ticks[first].first)).c_str(),
+		simple_fs::native_to_utf8(simple_fs::get_file_name(ticks[first].second)).c_str());
+	differs(ticks[first], true);
+	return EXIT_FAILURE;
+}
+
 int main(int argc, char **argv) {
 	if(argc <= 2)
 		return EXIT_FAILURE;
 
-	// 
+	if(std::string_view(argv[1]) == "-bisect") {
+		if(argc <= 3)
+			return EXIT_FAILURE;
+		return bisect(simple_fs::utf8_to_native(argv[2]), simple_fs::utf8_to_native(argv[3]));
+	}
+
 	auto dir = simple_fs::get_or_create_oos_directory();
 
 	auto oos_file_1 = open_file(dir, simple_fs::utf8_to_native(argv[1]));
 	if(!bool(oos_file_1))
 		return EXIT_FAILURE;
-	auto contents_1 = simple_fs::view_contents(*oos_file_1);
-	auto const* start_1 = reinterpret_cast<uint8_t const*>(contents_1.data);
-	auto end_1 = start_1 + contents_1.file_size;
-
 	auto oos_file_2 = open_file(dir, simple_fs::utf8_to_native(argv[2]));
 	if(!bool(oos_file_2))
 		return EXIT_FAILURE;
-	auto contents_2 = simple_fs::view_contents(*oos_file_2);
-	auto const* start_2 = reinterpret_cast<uint8_t const*>(contents_2.data);
-	auto end_2 = start_2 + contents_2.file_size;
-
-	dcon::for_each_record(reinterpret_cast<const std::byte*>(start_1), reinterpret_cast<const std::byte*>(end_1), [&](dcon::record_header const& header_1, std::byte const* data_start_1, std::byte const* data_end_1) {
-		dcon::for_each_record(reinterpret_cast<const std::byte*>(start_2), reinterpret_cast<const std::byte*>(end_2), [&](dcon::record_header const& header_2, std::byte const* data_start_2, std::byte const* data_end_2) {
-			auto obj1 = std::string_view{ header_1.object_name_start, header_1.object_name_end };
-			auto obj2 = std::string_view{ header_2.object_name_start, header_2.object_name_end };
-			if(obj1 == obj2) {
-				auto pop1 = std::string_view{ header_1.property_name_start, header_1.property_name_end };
-				auto pop2 = std::string_view{ header_2.property_name_start, header_2.property_name_end };
-				if(pop1 == pop2) {
-					auto size1 = data_end_1 - data_start_1;
-					auto size2 = data_end_2 - data_start_2;
-					auto offset1 = data_start_1 - reinterpret_cast<const std::byte*>(start_1);
-					auto offset2 = data_start_2 - reinterpret_cast<const std::byte*>(start_2);
-					bool match = true;
-					//
-					if(size1 != size2) {
-						std::printf("%s.%s.%s:", header_1.object_name_start, header_1.property_name_start, header_1.type_name_start);
-						std::printf("Size mismatch (%u/%u)\n", static_cast<unsigned int>(offset1), static_cast<unsigned int>(offset2));
-						match = false;
-					}
-					//
-					if(std::memcmp(data_start_1, data_start_2, std::min(size1, size2))) {
-						std::printf("%s.%s.%s:", header_1.object_name_start, header_1.property_name_start, header_1.type_name_start);
-						std::printf("Data mismatch (%u/%u)", static_cast<unsigned int>(offset1), static_cast<unsigned int>(offset2));
-
-						auto p1 = data_start_1;
-						auto p2 = data_start_2;
-						for(; *p1 == *p2; p1++, p2++);
-						std::printf("<@+%u> ->\n", static_cast<unsigned int>(p1 - data_start_1));
-
-						std::printf("<");
-						for(int32_t i = -8; i < 8; i++)
-							std::printf("%x ", p1[i]);
-						std::printf(">\n<");
-						for(int32_t i = -8; i < 8; i++)
-							std::printf("%x ", p2[i]);
-						std::printf(">\n");
-
-						match = false;
-					}
-					//
-					if(!match) {
-						std::printf("*NOT MATCHING*\n");
-					}
-				}
-			}
-		});
-	});
+
+	auto index_1 = index_dump(simple_fs::view_contents(*oos_file_1));
+	auto index_2 = index_dump(simple_fs::view_contents(*oos_file_2));
+	auto mismatches = diff_dumps(index_1, index_2, true);
+	if(mismatches != 0) {
+		std::printf("*NOT MATCHING* (%u differences)\n", mismatches);
+		return EXIT_FAILURE;
+	}
 	std::printf("Kosher! Finished! ^-^\n");
 	return EXIT_SUCCESS;
 }
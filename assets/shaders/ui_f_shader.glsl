@@ -9,12 +9,14 @@ layout (location = 0) out vec4 frag_color;
 
 layout (binding = 0) uniform sampler2D texture_sampler;
 layout (binding = 1) uniform sampler2D secondary_texture_sampler;
+layout (binding = 2) uniform sampler2DArray atlas_sampler;
 layout (location = 2) uniform vec4 d_rect;
 layout (location = 6) uniform float border_size;
 layout (location = 7) uniform vec3 inner_color;
 layout (location = 10) uniform vec4 subrect;
 
 layout (location = 11) uniform float gamma;
+layout (location = 12) uniform float atlas_layer;
 vec4 gamma_correct(vec4 colour) {
 	return vec4(pow(colour.rgb, vec3(1.f / gamma)), colour.a);
 }
@@ -60,6 +62,17 @@ vec4 use_mask(vec2 tc) {
 	return vec4(texture(texture_sampler, tc).rgb, texture(secondary_texture_sampler, tc).a);
 }
 		
+layout(index = 17) subroutine(font_function_class)
+vec4 atlas_no_filter(vec2 tc) {
+	return texture(atlas_sampler, vec3(tc.x * subrect.y + subrect.x, tc.y * subrect.a + subrect.z, atlas_layer));
+}
+
+layout(index = 18) subroutine(font_function_class)
+vec4 atlas_use_mask(vec2 tc) {
+	vec3 atlas_tc = vec3(tc.x * subrect.y + subrect.x, tc.y * subrect.a + subrect.z, atlas_layer);
+	return vec4(texture(atlas_sampler, atlas_tc).rgb, texture(secondary_texture_sampler, tc).a);
+}
+		
 layout(index = 7) subroutine(font_function_class)
 vec4 progress_bar(vec2 tc) {
 	return mix( texture(texture_sampler, tc), texture(secondary_texture_sampler, tc), step(border_size, tc.x));
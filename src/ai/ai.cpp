@@ -4,6 +4,32 @@
 
 namespace ai {
 
+/*
+The AI command buffer: the expensive part of an AI pass (trigger evaluation, scoring candidates) runs in parallel against the
+state as it was at the start of the pass, and each thread records the actions it would take instead of performing them. The
+recorded commands are then sorted by their own ordering and applied serially, so that the outcome does not depend on how the
+work was scheduled. Commands that can be invalidated by an earlier command in the same pass are re-validated when applied.
+*/
+template<typename T>
+class command_buffer {
+	concurrency::combinable<std::vector<T>> per_thread;
+public:
+	void push(T const& c) {
+		per_thread.local().push_back(c);
+	}
+	template<typename F>
+	void apply(F&& f) {
+		auto total_vector = per_thread.combine([](auto& a, auto& b) {
+			std::vector<T> result(a.begin(), a.end());
+			result.insert(result.end(), b.begin(), b.end());
+			return result;
+		});
+		std::sort(total_vector.begin(), total_vector.end());
+		for(auto const& c : total_vector)
+			f(c);
+	}
+};
+
 float estimate_strength(sys::state& state, dcon::nation_id n) {
 	float value = state.world.nation_get_military_score(n);
 	for(auto subj : state.world.nation_get_overlord_as_ruler(n))
@@ -319,9 +345,19 @@ void explain_ai_access_reasons(sys::state& state, dcon::nation_id target, text::
 	text::add_line_with_condition(state, contents, "ai_access_1", ai_will_grant_access(state, target, state.local_player_nation), indent);
 }
 
+struct research_command {
+	dcon::nation_id n;
+	dcon::technology_id t;
+
+	bool operator<(research_command const& other) const noexcept {
+		return n.value < other.n.value;
+	}
+};
+
 void update_ai_research(sys::state& state) {
 	auto ymd_date = state.current_date.to_ymd(state.start_date);
 	auto year = uint32_t(ymd_date.year);
+	command_buffer<research_command> commands;
 	concurrency::parallel_for(uint32_t(0), state.world.nation_size(), [&](uint32_t id) {
 		dcon::nation_id n{ dcon::nation_id::value_base_t(id) };
 
@@ -376,9 +412,13 @@ void update_ai_research(sys::state& state) {
 		});
 
 		if(!potential.empty()) {
-			state.world.nation_set_current_research(n, potential[0].id);
+			commands.push(research_command{ n, potential[0].id });
 		}
 	});
+
+	commands.apply([&](research_command const& c) {
+		state.world.nation_set_current_research(c.n, c.t);
+	});
 }
 
 void initialize_ai_tech_weights(sys::state& state) {
@@ -556,19 +596,38 @@ void identify_focuses(sys::state& state) {
 	}
 }
 
+struct focus_command {
+	dcon::nation_id n;
+	dcon::state_instance_id si;
+	dcon::national_focus_id f;
+	uint32_t sequence = 0;
+
+	bool operator<(focus_command const& other) const noexcept {
+		return n != other.n ? (n.value < other.n.value) : (sequence < other.sequence);
+	}
+};
+
 void update_focuses(sys::state& state) {
 	for(auto si : state.world.in_state_instance) {
 		if(!si.get_nation_from_state_ownership().get_is_player_controlled())
 			si.set_owner_focus(dcon::national_focus_id{});
 	}
 
-	for(auto n : state.world.in_nation) {
+	/*
+	Each nation only ever touches its own states, so the choices are made in parallel and recorded; a later choice for the
+	same state overrides an earlier one, which the sequence number preserves when the commands are applied.
+	*/
+	command_buffer<focus_command> commands;
+
+	concurrency::parallel_for(uint32_t(0), state.world.nation_size(), [&](uint32_t id) {
+		auto n = fatten(state.world, dcon::nation_id{ dcon::nation_id::value_base_t(id) });
 		if(n.get_is_player_controlled())
-			continue;
+			return;
 		if(n.get_owned_province_count() == 0)
-			continue;
+			return;
 
-		n.set_state_from_flashpoint_focus(dcon::state_instance_id{});
+		uint32_t sequence = 0;
+		commands.push(focus_command{ n, dcon::state_instance_id{}, dcon::national_focus_id{}, sequence++ });
 
 		auto num_focuses_total = nations::max_national_focuses(state, n);
 		if(num_focuses_total <= 0)
@@ -578,8 +637,7 @@ void update_focuses(sys::state& state) {
 		auto clergy_frac = n.get_demographics(demographics::to_key(state, state.culture_definitions.clergy)) / n.get_demographics(demographics::total);
 		bool max_clergy = clergy_frac >= base_opt;
 
-		static std::vector<dcon::state_instance_id> ordered_states;
-		ordered_states.clear();
+		std::vector<dcon::state_instance_id> ordered_states;
 		for(auto si : n.get_state_ownership()) {
 			ordered_states.push_back(si.get_state().id);
 		}
@@ -595,7 +653,7 @@ void update_focuses(sys::state& state) {
 		for(uint32_t i = 0; num_focuses_total > 0 && i < ordered_states.size(); ++i) {
 			if(max_clergy) {
 				if(threatened) {
-					state.world.state_instance_set_owner_focus(ordered_states[i], state.national_definitions.soldier_focus);
+					commands.push(focus_command{ n, ordered_states[i], state.national_definitions.soldier_focus, sequence++ });
 					--num_focuses_total;
 				} else {
 					auto total = state.world.state_instance_get_demographics(ordered_states[i], demographics::total);
@@ -603,7 +661,7 @@ void update_focuses(sys::state& state) {
 					auto pwfrac = state.world.state_instance_get_demographics(ordered_states[i], demographics::to_key(state, state.culture_definitions.primary_factory_worker)) / total;
 					auto swfrac = state.world.state_instance_get_demographics(ordered_states[i], demographics::to_key(state, state.culture_definitions.secondary_factory_worker)) / total;
 					if(cfrac < state.defines.max_clergy_for_literacy * 0.8f) {
-						state.world.state_instance_set_owner_focus(ordered_states[i], state.national_definitions.clergy_focus);
+						commands.push(focus_command{ n, ordered_states[i], state.national_definitions.clergy_focus, sequence++ });
 						--num_focuses_total;
 					}
 				}
@@ -611,7 +669,7 @@ void update_focuses(sys::state& state) {
 				// If we haven't maxxed out clergy on this state, then our number 1 priority is to maximize clergy
 				auto cfrac = state.world.state_instance_get_demographics(ordered_states[i], demographics::to_key(state, state.culture_definitions.clergy)) / state.world.state_instance_get_demographics(ordered_states[i], demographics::total);
 				if(cfrac < base_opt * 1.2f) {
-					state.world.state_instance_set_owner_focus(ordered_states[i], state.national_definitions.clergy_focus);
+					commands.push(focus_command{ n, ordered_states[i], state.national_definitions.clergy_focus, sequence++ });
 					--num_focuses_total;
 				}
 			}
@@ -632,12 +690,12 @@ void update_focuses(sys::state& state) {
 			if(pw_employed >= pw_num && int8_t(pw_frac * 100.f) != int8_t(ideal_pwfrac * 100.f)) {
 				// Keep balance between ratio of factory workers
 				// we will only promote primary workers if none are unemployed
-				state.world.state_instance_set_owner_focus(ordered_states[i], state.national_definitions.secondary_factory_worker_focus);
+				commands.push(focus_command{ n, ordered_states[i], state.national_definitions.secondary_factory_worker_focus, sequence++ });
 				--num_focuses_total;
 			} else if(sw_employed >= sw_num && int8_t(sw_frac * 100.f) != int8_t(ideal_swfrac * 100.f)) {
 				// Keep balance between ratio of factory workers
 				// we will only promote secondary workers if none are unemployed
-				state.world.state_instance_set_owner_focus(ordered_states[i], state.national_definitions.primary_factory_worker_focus);
+				commands.push(focus_command{ n, ordered_states[i], state.national_definitions.primary_factory_worker_focus, sequence++ });
 				--num_focuses_total;
 			} else {
 				/* If we are a civilized nation, and we allow pops to operate on the economy
@@ -645,25 +703,48 @@ void update_focuses(sys::state& state) {
 				   build new factories for us */
 				auto rules = n.get_combined_issue_rules();
 				if(n.get_is_civilized() && (rules & (issue_rule::pop_build_factory | issue_rule::pop_build_factory_invest | issue_rule::pop_expand_factory | issue_rule::pop_expand_factory_invest | issue_rule::pop_open_factory | issue_rule::pop_open_factory_invest)) != 0) {
-					state.world.state_instance_set_owner_focus(ordered_states[i], state.national_definitions.capitalist_focus);
+					commands.push(focus_command{ n, ordered_states[i], state.national_definitions.capitalist_focus, sequence++ });
 				} else {
-					state.world.state_instance_set_owner_focus(ordered_states[i], state.national_definitions.aristocrat_focus);
+					commands.push(focus_command{ n, ordered_states[i], state.national_definitions.aristocrat_focus, sequence++ });
 				}
 				--num_focuses_total;
 			}
 		}
-	}
+	});
+
+	commands.apply([&](focus_command const& c) {
+		if(c.si)
+			state.world.state_instance_set_owner_focus(c.si, c.f);
+		else
+			state.world.nation_set_state_from_flashpoint_focus(c.n, dcon::state_instance_id{});
+	});
 }
 
+struct decision_command {
+	dcon::decision_id d;
+	dcon::nation_id n;
+
+	bool operator<(decision_command const& other) const noexcept {
+		return d != other.d ? (d.value < other.d.value) : (n.value < other.n.value);
+	}
+};
+
 void take_ai_decisions(sys::state& state) {
-	for(auto d : state.world.in_decision) {
-		auto e = d.get_effect();
-		if(!e)
-			continue;
+	/*
+	The potential, allow and ai_will_do triggers of every decision are evaluated in parallel against the state at the start of
+	the pass. The candidates are then taken serially in (decision, nation) order; since an earlier decision may change whether a
+	later one is still possible, potential and allow are checked again right before the effect is executed.
+	*/
+	command_buffer<decision_command> commands;
+
+	concurrency::parallel_for(uint32_t(0), state.world.decision_size(), [&](uint32_t i) {
+		dcon::decision_id d{ dcon::decision_id::value_base_t(i) };
+		if(!state.world.decision_get_effect(d))
+			return;
 
-		auto potential = d.get_potential();
-		auto allow = d.get_allow();
-		auto ai_will_do = d.get_ai_will_do();
+		auto potential = state.world.decision_get_potential(d);
+		auto allow = state.world.decision_get_allow(d);
+		auto ai_will_do = state.world.decision_get_ai_will_do(d);
 
 		ve::execute_serial_fast<dcon::nation_id>(state.world.nation_size(), [&](auto ids) {
 			ve::vbitfield_type filter_a = potential
@@ -680,33 +761,42 @@ void take_ai_decisions(sys::state& state) {
 					: filter_c;
 
 				ve::apply([&](dcon::nation_id n, bool passed_filter) {
-					if(passed_filter) {
-						auto second_validity = potential
-							? trigger::evaluate(state, potential, trigger::to_generic(n), trigger::to_generic(n), 0)
-							: true;
-						second_validity = second_validity && (allow
-							? trigger::evaluate(state, allow, trigger::to_generic(n), trigger::to_generic(n), 0)
-							: true);
-						if(second_validity) {
-							effect::execute(state, e, trigger::to_generic(n), trigger::to_generic(n), 0, uint32_t(state.current_date.value),
-										uint32_t(n.index() << 4 ^ d.id.index()));
-
-							notification::post(state, notification::message{
-								[e, n, did = d.id, when = state.current_date](sys::state& state, text::layout_base& contents) {
-									text::add_line(state, contents, "msg_decision_1", text::variable_type::x, n, text::variable_type::y, state.world.decision_get_name(did));
-									text::add_line(state, contents, "msg_decision_2");
-									ui::effect_description(state, contents, e, trigger::to_generic(n), trigger::to_generic(n), 0, uint32_t(when.value), uint32_t(n.index() << 4 ^ did.index()));
-								},
-								"msg_decision_title",
-								n, dcon::nation_id{}, dcon::nation_id{},
-								sys::message_base_type::decision
-							});
-						}
-					}
+					if(passed_filter)
+						commands.push(decision_command{ d, n });
 				}, ids, filter_b);
 			}
 		});
-	}
+	});
+
+	commands.apply([&](decision_command const& c) {
+		auto d = c.d;
+		auto n = c.n;
+		auto e = state.world.decision_get_effect(d);
+		auto potential = state.world.decision_get_potential(d);
+		auto allow = state.world.decision_get_allow(d);
+
+		auto second_validity = potential
+			? trigger::evaluate(state, potential, trigger::to_generic(n), trigger::to_generic(n), 0)
+			: true;
+		second_validity = second_validity && (allow
+			? trigger::evaluate(state, allow, trigger::to_generic(n), trigger::to_generic(n), 0)
+			: true);
+		if(second_validity) {
+			effect::execute(state, e, trigger::to_generic(n), trigger::to_generic(n), 0, uint32_t(state.current_date.value),
+						uint32_t(n.index() << 4 ^ d.index()));
+
+			notification::post(state, notification::message{
+				[e, n, did = d, when = state.current_date](sys::state& state, text::layout_base& contents) {
+					text::add_line(state, contents, "msg_decision_1", text::variable_type::x, n, text::variable_type::y, state.world.decision_get_name(did));
+					text::add_line(state, contents, "msg_decision_2");
+					ui::effect_description(state, contents, e, trigger::to_generic(n), trigger::to_generic(n), 0, uint32_t(when.value), uint32_t(n.index() << 4 ^ did.index()));
+				},
+				"msg_decision_title",
+				n, dcon::nation_id{}, dcon::nation_id{},
+				sys::message_base_type::decision
+			});
+		}
+	});
 }
 
 float estimate_pop_party_support(sys::state& state, dcon::nation_id n, dcon::political_party_id pid) {
@@ -811,27 +901,50 @@ void get_desired_factory_types(sys::state& state, dcon::nation_id nid, std::vect
 	}
 }
 
+struct construction_command {
+	dcon::nation_id n;
+	uint32_t sequence = 0;
+	dcon::state_instance_id si;
+	dcon::province_id p;
+	dcon::factory_type_id factory_type;
+	economy::province_building_type building_type = economy::province_building_type::railroad;
+	bool is_upgrade = false;
+
+	bool operator<(construction_command const& other) const noexcept {
+		return n != other.n ? (n.value < other.n.value) : (sequence < other.sequence);
+	}
+};
+
 void update_ai_econ_construction(sys::state& state) {
-	for(auto n : state.world.in_nation) {
+	/*
+	A nation only places projects in its own states and provinces, so the projects are chosen in parallel and recorded. The
+	only project that a nation's later choices in the same pass depend on is a factory upgrade in a state it has already
+	started one of the same type in, which is tracked locally. The projects are then created serially in nation order and in
+	the order in which they were chosen, so that the construction ids come out the same as when this ran serially.
+	*/
+	command_buffer<construction_command> commands;
+
+	concurrency::parallel_for(uint32_t(0), state.world.nation_size(), [&](uint32_t id) {
+		auto n = fatten(state.world, dcon::nation_id{ dcon::nation_id::value_base_t(id) });
 		// skip over: non ais, dead nations, and nations that aren't making money
 		if(n.get_is_player_controlled() || n.get_owned_province_count() == 0 || !n.get_is_civilized())
-			continue;
+			return;
 		if(n.get_spending_level() < 1.0f || n.get_last_treasury() >= n.get_stockpiles(economy::money))
-			continue;
+			return;
+
+		uint32_t sequence = 0;
 
 		auto treasury = n.get_stockpiles(economy::money);
 		int32_t max_projects = std::max(8, int32_t(treasury / 8000.0f));
 		auto rules = n.get_combined_issue_rules();
 
 		if((rules & issue_rule::expand_factory) != 0 || (rules & issue_rule::build_factory) != 0) {
-			static::std::vector<dcon::factory_type_id> desired_types;
-			desired_types.clear();
+			std::vector<dcon::factory_type_id> desired_types;
 			get_desired_factory_types(state, n, desired_types);
 
 			// desired types filled: try to construct or upgrade
 			if(!desired_types.empty()) {
-				static std::vector<dcon::state_instance_id> ordered_states;
-				ordered_states.clear();
+				std::vector<dcon::state_instance_id> ordered_states;
 				for(auto si : n.get_state_ownership()) {
 					if(si.get_state().get_capital().get_is_colonial() == false)
 						ordered_states.push_back(si.get_state().id);
@@ -857,6 +970,7 @@ void update_ai_econ_construction(sys::state& state) {
 						if(pw_employed >= pw_num && pw_num > 0.0f)
 							continue; // no spare workers
 
+						std::vector<dcon::factory_type_id> started_upgrades;
 						province::for_each_province_in_state_instance(state, si, [&](dcon::province_id p) {
 							for(auto fac : state.world.province_get_factory_location(p)) {
 								auto type = fac.get_factory().get_building_type();
@@ -864,7 +978,7 @@ void update_ai_econ_construction(sys::state& state) {
 									&& fac.get_factory().get_level() < uint8_t(255) && fac.get_factory().get_primary_employment() >= 0.9f
 									&& std::find(desired_types.begin(), desired_types.end(), type) != desired_types.end()) {
 
-									auto ug_in_progress = false;
+									auto ug_in_progress = std::find(started_upgrades.begin(), started_upgrades.end(), type) != started_upgrades.end();
 									for(auto c : state.world.state_instance_get_state_building_construction(si)) {
 										if(c.get_type() == type) {
 											ug_in_progress = true;
@@ -872,10 +986,8 @@ void update_ai_econ_construction(sys::state& state) {
 										}
 									}
 									if(!ug_in_progress) {
-										auto new_up = fatten(state.world, state.world.force_create_state_building_construction(si, n));
-										new_up.set_is_pop_project(false);
-										new_up.set_is_upgrade(true);
-										new_up.set_type(type);
+										commands.push(construction_command{ n, sequence++, si, dcon::province_id{}, type, economy::province_building_type::railroad, true });
+										started_upgrades.push_back(type);
 
 										--max_projects;
 										return;
@@ -937,10 +1049,7 @@ void update_ai_econ_construction(sys::state& state) {
 							}
 							if(present_in_location) {
 								if((rules & issue_rule::expand_factory) != 0) {
-									auto new_up = fatten(state.world, state.world.force_create_state_building_construction(si, n));
-									new_up.set_is_pop_project(false);
-									new_up.set_is_upgrade(true);
-									new_up.set_type(type_selection);
+									commands.push(construction_command{ n, sequence++, si, dcon::province_id{}, type_selection, economy::province_building_type::railroad, true });
 									--max_projects;
 								}
 								continue;
@@ -949,10 +1058,7 @@ void update_ai_econ_construction(sys::state& state) {
 							// else -- try to build -- must have room
 							int32_t num_factories = economy::state_factory_count(state, si, n);
 							if(num_factories < int32_t(state.defines.factories_per_state)) {
-								auto new_up = fatten(state.world, state.world.force_create_state_building_construction(si, n));
-								new_up.set_is_pop_project(false);
-								new_up.set_is_upgrade(false);
-								new_up.set_type(type_selection);
+								commands.push(construction_command{ n, sequence++, si, dcon::province_id{}, type_selection, economy::province_building_type::railroad, false });
 								--max_projects;
 								continue;
 							} else {
@@ -963,8 +1069,7 @@ void update_ai_econ_construction(sys::state& state) {
 			} // END if(!desired_types.empty()) {
 		} // END  if((rules & issue_rule::expand_factory) != 0 || (rules & issue_rule::build_factory) != 0)
 
-		static std::vector<dcon::province_id> project_provs;
-		project_provs.clear();
+		std::vector<dcon::province_id> project_provs;
 
 		// try naval bases
 		if(max_projects > 0) {
@@ -1000,12 +1105,7 @@ void update_ai_econ_construction(sys::state& state) {
 					return a.index() < b.index();
 			});
 			if(!project_provs.empty()) {
-				auto si = state.world.province_get_state_membership(project_provs[0]);
-				if(si)
-					si.set_naval_base_is_taken(true);
-				auto new_rr = fatten(state.world, state.world.force_create_province_building_construction(project_provs[0], n));
-				new_rr.set_is_pop_project(false);
-				new_rr.set_type(uint8_t(economy::province_building_type::naval_base));
+				commands.push(construction_command{ n, sequence++, dcon::state_instance_id{}, project_provs[0], dcon::factory_type_id{}, economy::province_building_type::naval_base, false });
 				--max_projects;
 			}
 		}
@@ -1047,9 +1147,7 @@ void update_ai_econ_construction(sys::state& state) {
 						return a.index() < b.index();
 				});
 				for(uint32_t j = 0; j < project_provs.size() && max_projects > 0; ++j) {
-					auto new_proj = fatten(state.world, state.world.force_create_province_building_construction(project_provs[j], n));
-					new_proj.set_is_pop_project(false);
-					new_proj.set_type(uint8_t(econ_buildable[i].type));
+					commands.push(construction_command{ n, sequence++, dcon::state_instance_id{}, project_provs[j], dcon::factory_type_id{}, econ_buildable[i].type, false });
 					--max_projects;
 				}
 			}
@@ -1088,13 +1186,29 @@ void update_ai_econ_construction(sys::state& state) {
 			});
 
 			for(uint32_t i = 0; i < project_provs.size() && max_projects > 0; ++i) {
-				auto new_rr = fatten(state.world, state.world.force_create_province_building_construction(project_provs[i], n));
-				new_rr.set_is_pop_project(false);
-				new_rr.set_type(uint8_t(economy::province_building_type::fort));
+				commands.push(construction_command{ n, sequence++, dcon::state_instance_id{}, project_provs[i], dcon::factory_type_id{}, economy::province_building_type::fort, false });
 				--max_projects;
 			}
 		}
-	}
+	});
+
+	commands.apply([&](construction_command const& c) {
+		if(c.si) {
+			auto new_up = fatten(state.world, state.world.force_create_state_building_construction(c.si, c.n));
+			new_up.set_is_pop_project(false);
+			new_up.set_is_upgrade(c.is_upgrade);
+			new_up.set_type(c.factory_type);
+		} else {
+			if(c.building_type == economy::province_building_type::naval_base) {
+				auto si = state.world.province_get_state_membership(c.p);
+				if(si)
+					state.world.state_instance_set_naval_base_is_taken(si, true);
+			}
+			auto new_proj = fatten(state.world, state.world.force_create_province_building_construction(c.p, c.n));
+			new_proj.set_is_pop_project(false);
+			new_proj.set_type(uint8_t(c.building_type));
+		}
+	});
 }
 
 void update_ai_colonial_investment(sys::state& state) {
@@ -1214,10 +1328,27 @@ void civilize(sys::state& state) {
 	}
 }
 
+struct reform_command {
+	dcon::nation_id n;
+	dcon::issue_option_id iss;
+	dcon::reform_option_id r;
+
+	bool operator<(reform_command const& other) const noexcept {
+		return n.value < other.n.value;
+	}
+};
+
 void take_reforms(sys::state& state) {
-	for(auto n : state.world.in_nation) {
+	/*
+	Weighing the issues by pop support is the expensive part, and it only reads the nation being considered, so it is done in
+	parallel; the chosen issue or reform is then enacted serially in nation order, after checking that it can still be taken.
+	*/
+	command_buffer<reform_command> commands;
+
+	concurrency::parallel_for(uint32_t(0), state.world.nation_size(), [&](uint32_t id) {
+		auto n = fatten(state.world, dcon::nation_id{ dcon::nation_id::value_base_t(id) });
 		if(n.get_is_player_controlled() || n.get_owned_province_count() == 0)
-			continue;
+			return;
 
 		if(n.get_is_civilized()) { // political & social
 			// Enact social policies to deter Jacobin rebels from overruning the country
@@ -1251,7 +1382,7 @@ void take_reforms(sys::state& state) {
 				});
 			}
 			if(iss) {
-				nations::enact_issue(state, n, iss);
+				commands.push(reform_command{ n, iss, dcon::reform_option_id{} });
 			}
 		} else { // military and economic
 			dcon::reform_option_id cheap_r;
@@ -1280,10 +1411,21 @@ void take_reforms(sys::state& state) {
 			}
 
 			if(cheap_r && cheap_cost <= n.get_research_points()) {
-				nations::enact_reform(state, n, cheap_r);
+				commands.push(reform_command{ n, dcon::issue_option_id{}, cheap_r });
 			}
 		}
-	}
+	});
+
+	commands.apply([&](reform_command const& c) {
+		if(c.iss) {
+			if(command::can_enact_issue(state, c.n, c.iss))
+				nations::enact_issue(state, c.n, c.iss);
+		} else if(c.r) {
+			auto reform = state.world.reform_option_get_parent_reform(c.r);
+			if(state.world.nation_get_reforms(c.n, reform).id != c.r)
+				nations::enact_reform(state, c.n, c.r);
+		}
+	});
 }
 
 bool will_be_crisis_primary_attacker(sys::state& state, dcon::nation_id n) {
@@ -3640,8 +3782,9 @@ void distribute_guards(sys::state& state, dcon::nation_id n) {
 		if(c.get_province() == cap)
 			cls = province_class::border;
 
-		for(auto padj : c.get_province().get_province_adjacency()) {
-			auto other = padj.get_connected_provinces(0) == c.get_province() ? padj.get_connected_provinces(1) : padj.get_connected_provinces(0);
+		auto& graph = state.province_definitions.adjacency;
+		for(auto i = graph.offsets[c.get_province().id.index()]; i < graph.offsets[c.get_province().id.index() + 1]; ++i) {
+			auto other = fatten(state.world, graph.neighbors[i]);
 			auto n_controller = other.get_nation_from_province_control();
 			auto ovr = n_controller.get_overlord_as_subject().get_ruler();
 
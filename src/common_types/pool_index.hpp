@@ -0,0 +1,149 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <algorithm>
+#include <type_traits>
+#include "unordered_dense.h"
+
+/*
+Interning indices for the append-only pools (trigger_data, effect_data, text_data). Scripts are committed to these pools by
+searching for an existing copy of the new sequence first, which used to mean a std::search over the whole pool for every
+fragment, making scenario building quadratic in the amount of script.
+
+first_occurrence_index::find returns exactly what that std::search returned -- the position of the first occurrence of the
+sequence anywhere in the pool, including occurrences inside or across previously committed sequences -- so the keys and
+bytes produced do not change. The index catches up with the pool lazily, so it only costs something for pools that are
+actually searched. It assumes that the pool is only appended to; if the pool shrinks the index is rebuilt.
+*/
+
+namespace pool_index {
+
+template<typename T>
+class first_occurrence_index {
+	static_assert(sizeof(T) <= 4);
+	static constexpr uint32_t gram = uint32_t(8 / sizeof(T)); // number of symbols packed into one 64 bit key
+
+	struct chain {
+		int32_t head = -1;
+		int32_t tail = -1;
+		uint32_t count = 0;
+	};
+
+	ankerl::unordered_dense::map<uint64_t, int32_t> short_first[gram - 1]; // first position of each sequence shorter than a gram
+	ankerl::unordered_dense::map<uint64_t, chain> chains; // positions starting with each gram, in increasing order
+	std::vector<int32_t> next_same;
+	uint32_t first = 0;
+	uint32_t indexed = 0;
+
+	static uint64_t pack(T const* values, uint32_t count) {
+		uint64_t key = 0;
+		for(uint32_t i = 0; i < count; ++i)
+			key |= uint64_t(std::make_unsigned_t<T>(values[i])) << (i * sizeof(T) * 8);
+		return key;
+	}
+
+	void sync(std::vector<T> const& pool) {
+		auto size = uint32_t(pool.size());
+		if(size < indexed)
+			clear();
+		if(size == indexed)
+			return;
+		next_same.resize(size, -1);
+		for(uint32_t length = 1; length <= gram; ++length) {
+			// positions whose sequence of this length has been completed by the data added since the last sync
+			uint32_t from = std::max(first, indexed + 1 >= length ? indexed + 1 - length : 0);
+			for(uint32_t p = from; p + length <= size; ++p) {
+				auto key = pack(pool.data() + p, length);
+				if(length < gram) {
+					short_first[length - 1].try_emplace(key, int32_t(p));
+				} else {
+					auto& c = chains[key];
+					if(c.tail >= 0)
+						next_same[c.tail] = int32_t(p);
+					else
+						c.head = int32_t(p);
+					c.tail = int32_t(p);
+					++c.count;
+				}
+			}
+		}
+		indexed = size;
+	}
+
+public:
+	// positions before start_at are never returned (the trigger and effect pools keep a placeholder at position 0)
+	explicit first_occurrence_index(uint32_t start_at = 0) : first(start_at) { }
+
+	void clear() {
+		for(auto& m : short_first)
+			m.clear();
+		chains.clear();
+		next_same.clear();
+		indexed = 0;
+	}
+	// like clear, but also frees the memory held by the index
+	void release() {
+		*this = first_occurrence_index(first);
+	}
+
+	// returns -1 if the sequence does not occur in the pool
+	int32_t find(std::vector<T> const& pool, T const* values, uint32_t count) {
+		sync(pool);
+		if(count == 0)
+			return -1;
+		if(count < gram) {
+			auto it = short_first[count - 1].find(pack(values, count));
+			return it != short_first[count - 1].end() ? it->second : -1;
+		}
+
+		// follow the shortest chain among the grams contained in the sequence
+		chain const* best = nullptr;
+		uint32_t best_offset = 0;
+		for(uint32_t offset = 0; offset + gram <= count; ++offset) {
+			auto it = chains.find(pack(values + offset, gram));
+			if(it == chains.end())
+				return -1;
+			if(!best || it->second.count < best->count) {
+				best = &it->second;
+				best_offset = offset;
+			}
+		}
+		for(int32_t p = best->head; p >= 0; p = next_same[p]) {
+			if(uint32_t(p) < first + best_offset)
+				continue;
+			auto start = uint32_t(p) - best_offset;
+			if(start + count > pool.size())
+				break;
+			if(std::equal(values, values + count, pool.data() + start))
+				return int32_t(start);
+		}
+		return -1;
+	}
+};
+
+// maps the start position of each committed sequence back to the index it was given in the indices vector
+class key_index {
+	ankerl::unordered_dense::map<int32_t, int32_t> index_of;
+	uint32_t indexed = 0;
+
+public:
+	void clear() {
+		index_of.clear();
+		indexed = 0;
+	}
+	// like clear, but also frees the memory held by the index
+	void release() {
+		*this = key_index{};
+	}
+	// returns -1 if no committed sequence starts at this position
+	int32_t find(std::vector<int32_t> const& indices, int32_t start) {
+		if(indices.size() < indexed)
+			clear();
+		for(; indexed < indices.size(); ++indexed)
+			index_of.try_emplace(indices[indexed], int32_t(indexed));
+		auto it = index_of.find(start);
+		return it != index_of.end() ? it->second : -1;
+	}
+};
+
+} // namespace pool_index
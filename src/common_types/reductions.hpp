@@ -0,0 +1,122 @@
+#pragma once
+#include <cstdint>
+#include <algorithm>
+#include <vector>
+#include "dcon_generated.hpp"
+
+/*
+Reproducible floating point sums. Floating point addition is not associative, so a sum computed by several threads normally
+depends on how the work was divided between them, which is why most of the simulation sums serially. The functions here
+instead split the values into blocks of a fixed size, sum each block in a fixed pairwise order, and then combine the block
+results in a fixed pairwise order. The result only depends on the number of values (and the values themselves), so it is
+bit-identical whether the blocks are summed serially, by concurrency::parallel_for, or by any other number of threads.
+
+Note that the result is not the same as that of a plain left-to-right loop; code that switches to these functions changes
+its results once, and then stays deterministic.
+*/
+
+namespace reduction {
+
+inline constexpr uint32_t block_size = 512; // must be a multiple of ve::vector_size
+inline constexpr uint32_t leaf_size = 8;
+
+inline constexpr uint32_t block_count(uint32_t count) noexcept {
+	return (count + block_size - 1) / block_size;
+}
+
+// sums [first, last) by splitting the range at the largest power of two below its length
+template<typename F>
+float pairwise_sum(uint32_t first, uint32_t last, F const& value_at) {
+	if(last - first <= leaf_size) {
+		float sum = 0.0f;
+		for(uint32_t i = first; i < last; ++i)
+			sum += float(value_at(i));
+		return sum;
+	}
+	uint32_t half = 1;
+	while(half * 2 < last - first)
+		half *= 2;
+	return pairwise_sum(first, first + half, value_at) + pairwise_sum(first + half, last, value_at);
+}
+
+inline float combine_partials(std::vector<float> const& partials) {
+	return pairwise_sum(uint32_t(0), uint32_t(partials.size()), [&](uint32_t i) { return partials[i]; });
+}
+
+template<typename F>
+float block_sum(uint32_t count, uint32_t block, F const& value_at) {
+	return pairwise_sum(block * block_size, std::min(count, (block + 1) * block_size), value_at);
+}
+
+/*
+for_each_block is called as for_each_block(number_of_blocks, body) and must call body(b) exactly once for every block b;
+it may do so in any order and from any number of threads.
+*/
+template<typename F, typename E>
+float sum(uint32_t count, F const& value_at, E&& for_each_block) {
+	std::vector<float> partials(block_count(count), 0.0f);
+	for_each_block(uint32_t(partials.size()), [&](uint32_t b) { partials[b] = block_sum(count, b, value_at); });
+	return combine_partials(partials);
+}
+
+template<typename F>
+float sum(uint32_t count, F const& value_at) {
+	return sum(count, value_at, [](uint32_t blocks, auto const& body) {
+		for(uint32_t b = 0; b < blocks; ++b)
+			body(b);
+	});
+}
+
+template<typename F>
+float parallel_sum(uint32_t count, F const& value_at) {
+	return sum(count, value_at, [](uint32_t blocks, auto const& body) { concurrency::parallel_for(uint32_t(0), blocks, body); });
+}
+
+/*
+Vector variants: value_at is called with ve::contiguous_tags<TAG> (or ve::partial_contiguous_tags<TAG> for the last, partial
+group) and returns a ve::fp_vector. Within a block each lane is accumulated in order and the lanes are then added with
+reduce(); lanes past the end of the range are discarded, so value_at does not need to pad its result with zeros.
+*/
+template<typename TAG, typename F>
+float vector_block_sum(uint32_t count, uint32_t block, F const& value_at) {
+	uint32_t first = block * block_size;
+	uint32_t last = std::min(count, first + block_size);
+	ve::fp_vector acc;
+	uint32_t i = first;
+	for(; i + ve::vector_size <= last; i += ve::vector_size) {
+		acc = acc + value_at(ve::contiguous_tags<TAG>(i));
+	}
+	if(i < last) {
+		auto tail = value_at(ve::partial_contiguous_tags<TAG>(i, last - i));
+		acc = acc + ve::apply([last](TAG id, float v) { return uint32_t(id.index()) < last ? v : 0.0f; },
+			ve::contiguous_tags<TAG>(i), tail);
+	}
+	return acc.reduce();
+}
+
+template<typename TAG, typename F, typename E>
+float vector_sum(uint32_t count, F const& value_at, E&& for_each_block) {
+	std::vector<float> partials(block_count(count), 0.0f);
+	for_each_block(uint32_t(partials.size()), [&](uint32_t b) { partials[b] = vector_block_sum<TAG>(count, b, value_at); });
+	return combine_partials(partials);
+}
+
+template<typename TAG, typename F>
+float vector_sum(uint32_t count, F const& value_at) {
+	return vector_sum<TAG>(count, value_at, [](uint32_t blocks, auto const& body) {
+		for(uint32_t b = 0; b < blocks; ++b)
+			body(b);
+	});
+}
+
+template<typename TAG, typename F>
+float parallel_vector_sum(uint32_t count, F const& value_at) {
+	return vector_sum<TAG>(count, value_at, [](uint32_t blocks, auto const& body) { concurrency::parallel_for(uint32_t(0), blocks, body); });
+}
+
+template<typename TAG>
+float buffer_sum(ve::vectorizable_buffer<float, TAG> const& values, uint32_t count) {
+	return vector_sum<TAG>(count, [&](auto ids) { return values.get(ids); });
+}
+
+} // namespace reduction
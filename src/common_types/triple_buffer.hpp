@@ -0,0 +1,42 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+
+/*
+Hands whole copies of some data from one writing thread to one reading thread without either ever waiting. Of the three
+buffers, the writer owns one, the reader owns another, and the third holds the most recently published copy. publish
+swaps the writer's buffer with the published one, and acquire swaps the reader's buffer with the published one if it is
+newer than what the reader already has; each swap is a single atomic exchange. The reader therefore always sees a buffer
+that was completely written, and the writer never writes into the buffer the reader is looking at.
+*/
+
+template<typename T>
+class triple_buffer {
+	static constexpr uint8_t index_mask = 3;
+	static constexpr uint8_t fresh = 4; // the published buffer has not been acquired yet
+
+	T buffers[3];
+	std::atomic<uint8_t> published = 1;
+	uint8_t writing = 0;
+	uint8_t reading = 2;
+
+public:
+	// writer side
+	T& write_buffer() {
+		return buffers[writing];
+	}
+	void publish() {
+		writing = published.exchange(uint8_t(writing | fresh), std::memory_order::acq_rel) & index_mask;
+	}
+
+	// reader side; returns false, and keeps the current read buffer, if nothing new has been published
+	bool acquire() {
+		if((published.load(std::memory_order::acquire) & fresh) == 0)
+			return false;
+		reading = published.exchange(reading, std::memory_order::acq_rel) & index_mask;
+		return true;
+	}
+	T const& read_buffer() const {
+		return buffers[reading];
+	}
+};
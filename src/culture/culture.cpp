@@ -908,34 +908,75 @@ float effective_technology_cost(sys::state& state, uint32_t current_year, dcon::
 				 (1.0f - std::max(0.0f, float(int32_t(current_year) - availability_year) / state.defines.tech_year_span));
 }
 
+struct research_completion {
+	dcon::nation_id n;
+	dcon::technology_id t;
+	float cost = 0.0f;
+
+	bool operator<(research_completion const& other) const noexcept {
+		return n.value < other.n.value;
+	}
+};
+
 void update_research(sys::state& state, uint32_t current_year) {
-	for(auto n : state.world.in_nation) {
-		if(n.get_owned_province_count() != 0 && n.get_current_research()) {
-			if(n.get_active_technologies(n.get_current_research())) {
-				n.set_current_research(dcon::technology_id{});
-			} else {
-				auto cost = effective_technology_cost(state, current_year, n, n.get_current_research());
-				if(n.get_research_points() >= cost) {
-					n.get_research_points() -= cost;
-					apply_technology(state, n, n.get_current_research());
-
-					notification::post(state, notification::message{
-						[t = n.get_current_research()](sys::state& state, text::layout_base& contents) {
-							text::add_line(state, contents, "msg_tech_1", text::variable_type::x, state.world.technology_get_name(t));
-							ui::technology_description(state, contents, t);
-						},
-						"msg_tech_title",
-						n, dcon::nation_id{}, dcon::nation_id{},
-						sys::message_base_type::tech
-					});
+	/*
+	Costs are computed against the state at the start of the tick in parallel, and the completed technologies are then applied
+	serially in nation order, so that the result does not depend on how the work was scheduled.
+	*/
+	concurrency::combinable<std::vector<research_completion>> completed;
 
-					n.set_current_research(dcon::technology_id{});
-				}
+	concurrency::parallel_for(uint32_t(0), state.world.nation_size(), [&](uint32_t i) {
+		dcon::nation_id n{ dcon::nation_id::value_base_t(i) };
+		auto current = state.world.nation_get_current_research(n);
+		if(state.world.nation_get_owned_province_count(n) == 0 || !current)
+			return;
+
+		if(state.world.nation_get_active_technologies(n, current)) {
+			completed.local().push_back(research_completion{ n, dcon::technology_id{}, 0.0f });
+		} else {
+			auto cost = effective_technology_cost(state, current_year, n, current);
+			if(state.world.nation_get_research_points(n) >= cost) {
+				completed.local().push_back(research_completion{ n, current, cost });
 			}
 		}
+	});
+
+	auto total_vector = completed.combine([](auto& a, auto& b) {
+		std::vector<research_completion> result(a.begin(), a.end());
+		result.insert(result.end(), b.begin(), b.end());
+		return result;
+	});
+	std::sort(total_vector.begin(), total_vector.end());
+
+	for(auto& c : total_vector) {
+		auto n = fatten(state.world, c.n);
+		if(c.t) {
+			n.get_research_points() -= c.cost;
+			apply_technology(state, n, c.t);
+
+			notification::post(state, notification::message{
+				[t = c.t](sys::state& state, text::layout_base& contents) {
+					text::add_line(state, contents, "msg_tech_1", text::variable_type::x, state.world.technology_get_name(t));
+					ui::technology_description(state, contents, t);
+				},
+				"msg_tech_title",
+				n, dcon::nation_id{}, dcon::nation_id{},
+				sys::message_base_type::tech
+			});
+		}
+		n.set_current_research(dcon::technology_id{});
 	}
 }
 
+struct invention_discovery {
+	dcon::nation_id n;
+	dcon::invention_id i;
+
+	bool operator<(invention_discovery const& other) const noexcept {
+		return other.i != i ? (i.value < other.i.value) : (n.value < other.n.value);
+	}
+};
+
 void discover_inventions(sys::state& state) {
 	/*
 	Inventions have a chance to be discovered on the 1st of every month. The invention chance modifier is computed additively, and
@@ -943,9 +984,18 @@ void discover_inventions(sys::state& state) {
 	discovered, the discoverer gains that amount of shared prestige / the number of times it has been discovered (including the
 	current time).
 	*/
-	for(auto inv : state.world.in_invention) {
-		auto lim = inv.get_limit();
-		auto odds = inv.get_chance();
+
+	/*
+	The limits and chances of every invention are evaluated in parallel against the state at the start of the tick; the
+	discoveries are gathered per thread and then applied serially in (invention, nation) order. An invention discovered in
+	this pass thus can only unlock other inventions from the next pass onwards.
+	*/
+	concurrency::combinable<std::vector<invention_discovery>> discoveries;
+
+	concurrency::parallel_for(uint32_t(0), state.world.invention_size(), [&](uint32_t i) {
+		dcon::invention_id inv{ dcon::invention_id::value_base_t(i) };
+		auto lim = state.world.invention_get_limit(inv);
+		auto odds = state.world.invention_get_chance(inv);
 		assert(odds);
 		if(lim) {
 			ve::execute_serial_fast<dcon::nation_id>(state.world.nation_size(), [&](auto nids) {
@@ -959,19 +1009,9 @@ void discover_inventions(sys::state& state) {
 					ve::apply(
 							[&](dcon::nation_id n, float chance, bool allow_discovery) {
 								if(allow_discovery) {
-									auto random = rng::get_random(state, uint32_t(inv.id.index()) << 5 ^ uint32_t(n.index()));
+									auto random = rng::get_random(state, uint32_t(inv.index()) << 5 ^ uint32_t(n.index()));
 									if(int32_t(random % 100) < int32_t(chance)) {
-										apply_invention(state, n, inv);
-
-										notification::post(state, notification::message{
-											[inv](sys::state& state, text::layout_base& contents) {
-												text::add_line(state, contents, "msg_inv_1", text::variable_type::x, state.world.invention_get_name(inv));
-												ui::invention_description(state, contents, inv, 0);
-											},
-											"msg_inv_title",
-											n, dcon::nation_id{}, dcon::nation_id{},
-											sys::message_base_type::invention
-										});
+										discoveries.local().push_back(invention_discovery{ n, inv });
 									}
 								}
 							},
@@ -988,19 +1028,9 @@ void discover_inventions(sys::state& state) {
 					ve::apply(
 							[&](dcon::nation_id n, float chance, bool block_discovery) {
 								if(!block_discovery) {
-									auto random = rng::get_random(state, uint32_t(inv.id.index()) << 5 ^ uint32_t(n.index()));
+									auto random = rng::get_random(state, uint32_t(inv.index()) << 5 ^ uint32_t(n.index()));
 									if(int32_t(random % 100) < int32_t(chance)) {
-										apply_invention(state, n, inv);
-
-										notification::post(state, notification::message{
-											[inv](sys::state& state, text::layout_base& contents) {
-												text::add_line(state, contents, "msg_inv_1", text::variable_type::x, state.world.invention_get_name(inv));
-												ui::invention_description(state, contents, inv, 0);
-											},
-											"msg_inv_title",
-											n, dcon::nation_id{}, dcon::nation_id{},
-											sys::message_base_type::invention
-										});
+										discoveries.local().push_back(invention_discovery{ n, inv });
 									}
 								}
 							},
@@ -1008,6 +1038,27 @@ void discover_inventions(sys::state& state) {
 				}
 			});
 		}
+	});
+
+	auto total_vector = discoveries.combine([](auto& a, auto& b) {
+		std::vector<invention_discovery> result(a.begin(), a.end());
+		result.insert(result.end(), b.begin(), b.end());
+		return result;
+	});
+	std::sort(total_vector.begin(), total_vector.end());
+
+	for(auto& d : total_vector) {
+		apply_invention(state, d.n, d.i);
+
+		notification::post(state, notification::message{
+			[inv = d.i](sys::state& state, text::layout_base& contents) {
+				text::add_line(state, contents, "msg_inv_1", text::variable_type::x, state.world.invention_get_name(inv));
+				ui::invention_description(state, contents, inv, 0);
+			},
+			"msg_inv_title",
+			d.n, dcon::nation_id{}, dcon::nation_id{},
+			sys::message_base_type::invention
+		});
 	}
 }
 
@@ -186,8 +186,44 @@ bool movement_is_valid(sys::state& state, dcon::movement_id m) {
 	return false;
 }
 
+enum class movement_action : uint8_t {
+	none, leave, join_issue, join_independence
+};
+struct movement_choice {
+	movement_action action = movement_action::none;
+	dcon::issue_option_id option;
+	dcon::national_identity_id independence;
+};
+
 void update_pop_movement_membership(sys::state& state) {
-	state.world.for_each_pop([&](dcon::pop_id p) {
+	/*
+	Membership is decided in two passes. First, in parallel and without touching the game state, every pop picks what it
+	would do. Then the choices are applied serially in pop order, which is where movements get created, so a later pop
+	finds the movement created by an earlier pop exactly as it would when processing pops one at a time.
+	*/
+
+	// the issue options a nation's pops may rally behind depend only on the nation, so gather them once per nation
+	std::vector<std::vector<dcon::issue_option_id>> nation_options(state.world.nation_size());
+	concurrency::parallel_for(uint32_t(0), state.world.nation_size(), [&](uint32_t i) {
+		dcon::nation_id owner{ dcon::nation_id::value_base_t(i) };
+		if(state.world.nation_get_owned_province_count(owner) == 0)
+			return;
+		auto& options = nation_options[i];
+		state.world.for_each_issue_option([&](dcon::issue_option_id io) {
+			auto parent = state.world.issue_option_get_parent_issue(io);
+			dcon::issue_option_id co = state.world.nation_get_issues(owner, parent);
+			if(co != io && (state.world.issue_get_issue_type(parent) == uint8_t(culture::issue_type::social) || state.world.issue_get_issue_type(parent) == uint8_t(culture::issue_type::political))) { // filter out currently active issue
+				// is this issue possible to get by law?
+				if(state.world.issue_get_is_next_step_only(parent) == false || co.index() + 1 == io.index() || co.index() - 1 == io.index()) {
+					options.push_back(io);
+				}
+			}
+		});
+	});
+
+	std::vector<movement_choice> choices(state.world.pop_size());
+	concurrency::parallel_for(uint32_t(0), state.world.pop_size(), [&](uint32_t i) {
+		dcon::pop_id p{ dcon::pop_id::value_base_t(i) };
 		auto owner = nations::owner_of_pop(state, p);
 		// pops not in a nation can't be in a movement
 		if(!owner)
@@ -210,27 +246,24 @@ void update_pop_movement_membership(sys::state& state) {
 
 		// -Pops with define : MIL_TO_JOIN_REBEL or greater militancy cannot join a movement
 		if(mil >= state.defines.mil_to_join_rebel) {
-			remove_pop_from_movement(state, p);
+			choices[i].action = movement_action::leave;
 			return;
 		}
 		if(existing_movement) {
-			auto i =
-					state.world.movement_get_associated_issue_option(existing_movement);
-			if(i) {
-				auto support = state.world.pop_get_demographics(p, pop_demographics::to_key(state, i));
+			auto io = state.world.movement_get_associated_issue_option(existing_movement);
+			if(io) {
+				auto support = state.world.pop_get_demographics(p, pop_demographics::to_key(state, io));
 				if(support * 100.0f < state.defines.issue_movement_leave_limit) {
 					// If the pop's support of the issue for an issue-based movement drops below define:ISSUE_MOVEMENT_LEAVE_LIMIT
 					// the pop will leave the movement.
-					remove_pop_from_movement(state, p);
-					return;
+					choices[i].action = movement_action::leave;
 				}
 			} else if(mil < state.defines.nationalist_movement_mil_cap) {
 				// If the pop's militancy falls below define:NATIONALIST_MOVEMENT_MIL_CAP, the pop will leave an independence
 				// movement.
-				remove_pop_from_movement(state, p);
-				return;
+				choices[i].action = movement_action::leave;
 			}
-			// pop still remains in movement, no more work to do
+			// otherwise the pop still remains in movement, no more work to do
 			return;
 		}
 
@@ -246,42 +279,22 @@ void update_pop_movement_membership(sys::state& state) {
 			*/
 			dcon::issue_option_id max_option;
 			float max_support = 0;
-			state.world.for_each_issue_option([&](dcon::issue_option_id io) {
-				auto parent = state.world.issue_option_get_parent_issue(io);
-				auto co = state.world.nation_get_issues(owner, parent);
-				auto allow = state.world.issue_option_get_allow(io);
-				if(co != io && (state.world.issue_get_issue_type(parent) == uint8_t(culture::issue_type::social) || state.world.issue_get_issue_type(parent) == uint8_t(culture::issue_type::political))) { // filter out currently active issue
-					auto sup = state.world.pop_get_demographics(p, pop_demographics::to_key(state, io));
-					if(sup * 100.0f >= state.defines.issue_movement_join_limit && sup > max_support) { // filter out -- above limit thersholds
-						/*
-						then the pop has a chance to join an issue-based movement at probability: issue-support x 9 x define:MOVEMENT_LIT_FACTOR x pop-literacy + issue-support x 9 x define:MOVEMENT_CON_FACTOR x pop-consciousness
-						*/
-
-						// probability test
-						auto fp_prob = 9.0f * sup * (state.defines.movement_lit_factor * lit + state.defines.movement_con_factor * con);
-						auto rvalue = float(uint32_t(rng::get_random(state, (p.value << 3) ^ io.index()) & 0xFFFF)) / float(0x10000);
-						if(rvalue < fp_prob) {
-
-							// is this issue possible to get by law?
-							if(state.world.issue_get_is_next_step_only(parent) == false || co.id.index() + 1 == io.index() || co.id.index() - 1 == io.index()) {
-
-								max_option = io;
-								max_support = sup;
-							}
-						}
+			for(auto io : nation_options[owner.index()]) {
+				auto sup = state.world.pop_get_demographics(p, pop_demographics::to_key(state, io));
+				if(sup * 100.0f >= state.defines.issue_movement_join_limit && sup > max_support) { // filter out -- above limit thersholds
+					// probability test
+					auto fp_prob = 9.0f * sup * (state.defines.movement_lit_factor * lit + state.defines.movement_con_factor * con);
+					auto rvalue = float(uint32_t(rng::get_random(state, (p.value << 3) ^ io.index()) & 0xFFFF)) / float(0x10000);
+					if(rvalue < fp_prob) {
+						max_option = io;
+						max_support = sup;
 					}
 				}
-			});
+			}
 
 			if(max_option) {
-				if(auto m = get_movement_by_position(state, owner, max_option); m) {
-					add_pop_to_movement(state, p, m);
-				} else if(issue_is_valid_for_movement(state, owner, max_option)) {
-					auto new_movement = fatten(state.world, state.world.create_movement());
-					new_movement.set_associated_issue_option(max_option);
-					state.world.try_create_movement_within(new_movement, owner);
-					add_pop_to_movement(state, p, new_movement);
-				}
+				choices[i].action = movement_action::join_issue;
+				choices[i].option = max_option;
 			} else if(!state.world.pop_get_is_primary_or_accepted_culture(p) && mil >= state.defines.nationalist_movement_mil_cap) {
 				/*
 				- If there are no valid issues, the pop has a militancy of at least define:NATIONALIST_MOVEMENT_MIL_CAP, does not
@@ -294,21 +307,53 @@ void update_pop_movement_membership(sys::state& state) {
 				auto pop_culture = state.world.pop_get_culture(p);
 				for(auto c : state.world.province_get_core(pop_location)) {
 					if(c.get_identity().get_primary_culture() == pop_culture) {
-						auto existing_mov = get_movement_by_independence(state, owner, c.get_identity());
-						if(existing_mov) {
-							state.world.try_create_pop_movement_membership(p, existing_mov);
-						} else {
-							auto new_mov = fatten(state.world, state.world.create_movement());
-							new_mov.set_associated_independence(c.get_identity());
-							state.world.try_create_movement_within(new_mov, owner);
-							state.world.try_create_pop_movement_membership(p, new_mov);
-						}
+						choices[i].action = movement_action::join_independence;
+						choices[i].independence = c.get_identity();
 						break;
 					}
 				}
 			}
 		}
 	});
+
+	for(uint32_t i = 0; i < state.world.pop_size(); ++i) {
+		dcon::pop_id p{ dcon::pop_id::value_base_t(i) };
+		auto& c = choices[i];
+		switch(c.action) {
+		case movement_action::none:
+			break;
+		case movement_action::leave:
+			remove_pop_from_movement(state, p);
+			break;
+		case movement_action::join_issue:
+		{
+			auto owner = nations::owner_of_pop(state, p);
+			if(auto m = get_movement_by_position(state, owner, c.option); m) {
+				add_pop_to_movement(state, p, m);
+			} else if(issue_is_valid_for_movement(state, owner, c.option)) {
+				auto new_movement = fatten(state.world, state.world.create_movement());
+				new_movement.set_associated_issue_option(c.option);
+				state.world.try_create_movement_within(new_movement, owner);
+				add_pop_to_movement(state, p, new_movement);
+			}
+			break;
+		}
+		case movement_action::join_independence:
+		{
+			auto owner = nations::owner_of_pop(state, p);
+			auto existing_mov = get_movement_by_independence(state, owner, c.independence);
+			if(existing_mov) {
+				state.world.try_create_pop_movement_membership(p, existing_mov);
+			} else {
+				auto new_mov = fatten(state.world, state.world.create_movement());
+				new_mov.set_associated_independence(c.independence);
+				state.world.try_create_movement_within(new_mov, owner);
+				state.world.try_create_pop_movement_membership(p, new_mov);
+			}
+			break;
+		}
+		}
+	}
 }
 
 void update_movements(sys::state& state) { // updates cached values and then possibly turns movements into rebels
@@ -427,7 +472,354 @@ bool pop_is_compatible_with_rebel_type(sys::state& state, dcon::pop_id p, dcon::
 	return true;
 }
 
+dcon::national_identity_id independence_target_for_pop(sys::state& state, dcon::pop_id p) {
+	auto prov = state.world.pop_get_province_from_pop_location(p);
+	for(auto core : state.world.province_get_core(prov)) {
+		if(!core.get_identity().get_is_not_releasable() && core.get_identity().get_primary_culture() == state.world.pop_get_culture(p))
+			return core.get_identity().id;
+	}
+	return dcon::national_identity_id{};
+}
+
+// whether a new faction of the given type could be formed for the pop, given its independence target
+bool pop_can_form_rebel_type(sys::state& state, dcon::pop_id p, dcon::rebel_type_id rt, dcon::national_identity_id ind_tag) {
+	if(!pop_is_compatible_with_rebel_type(state, p, rt))
+		return false;
+
+	auto accepted = state.world.pop_get_is_primary_or_accepted_culture(p);
+	auto union_tag = state.world.culture_group_get_identity_from_cultural_union_of(
+			state.world.culture_get_group_from_culture_group_membership(state.world.pop_get_culture(p)));
+
+	switch(culture::rebel_defection(state.world.rebel_type_get_defection(rt))) {
+	case culture::rebel_defection::culture:
+	case culture::rebel_defection::culture_group:
+	case culture::rebel_defection::religion:
+	case culture::rebel_defection::any:
+		if(!ind_tag)
+			return false; // no defection possible
+		if(accepted)
+			return false; // can't defect
+		break;
+	case culture::rebel_defection::pan_nationalist:
+		if(!union_tag)
+			return false; // no pan nationalist possible
+		break;
+	default:
+		break;
+	}
+
+	switch(culture::rebel_independence(state.world.rebel_type_get_independence(rt))) {
+	case culture::rebel_independence::culture:
+	case culture::rebel_independence::culture_group:
+	case culture::rebel_independence::religion:
+	case culture::rebel_independence::any:
+	case culture::rebel_independence::colonial:
+		if(!ind_tag)
+			return false; // no defection possible
+		if(accepted)
+			return false; // can't defect
+		break;
+	case culture::rebel_independence::pan_nationalist:
+		if(!union_tag)
+			return false; // no pan nationalist possible
+		if(accepted)
+			return false; // can't defect
+		break;
+	default:
+		break;
+	}
+	return true;
+}
+
+// sets the type and the culture / religion / defection target that a faction of that type formed by the pop would have
+void set_faction_identity(sys::state& state, dcon::rebel_faction_id f, dcon::rebel_type_id rt, dcon::pop_id p, dcon::national_identity_id ind_tag) {
+	state.world.rebel_faction_set_type(f, rt);
+	state.world.rebel_faction_set_defection_target(f, dcon::national_identity_id{});
+	state.world.rebel_faction_set_primary_culture(f, dcon::culture_id{});
+	state.world.rebel_faction_set_primary_culture_group(f, dcon::culture_group_id{});
+	state.world.rebel_faction_set_religion(f, dcon::religion_id{});
+
+	switch(culture::rebel_defection(state.world.rebel_type_get_defection(rt))) {
+	case culture::rebel_defection::culture:
+		state.world.rebel_faction_set_primary_culture(f, state.world.pop_get_culture(p));
+		state.world.rebel_faction_set_defection_target(f, ind_tag);
+		break;
+	case culture::rebel_defection::culture_group:
+		state.world.rebel_faction_set_primary_culture_group(f,
+				state.world.culture_get_group_from_culture_group_membership(state.world.pop_get_culture(p)));
+		state.world.rebel_faction_set_defection_target(f, ind_tag);
+		break;
+	case culture::rebel_defection::religion:
+		state.world.rebel_faction_set_religion(f, state.world.pop_get_religion(p));
+		state.world.rebel_faction_set_defection_target(f, ind_tag);
+		break;
+	case culture::rebel_defection::pan_nationalist: {
+		auto cg = state.world.culture_get_group_from_culture_group_membership(state.world.pop_get_culture(p));
+		auto u = state.world.culture_group_get_identity_from_cultural_union_of(cg);
+		state.world.rebel_faction_set_defection_target(f, u);
+		break;
+	}
+	case culture::rebel_defection::any:
+		state.world.rebel_faction_set_defection_target(f, ind_tag);
+		break;
+	default:
+		break;
+	}
+
+	switch(culture::rebel_independence(state.world.rebel_type_get_independence(rt))) {
+	case culture::rebel_independence::culture:
+		state.world.rebel_faction_set_primary_culture(f, state.world.pop_get_culture(p));
+		state.world.rebel_faction_set_defection_target(f, ind_tag);
+		break;
+	case culture::rebel_independence::culture_group:
+		state.world.rebel_faction_set_primary_culture_group(f,
+				state.world.culture_get_group_from_culture_group_membership(state.world.pop_get_culture(p)));
+		state.world.rebel_faction_set_defection_target(f, ind_tag);
+		break;
+	case culture::rebel_independence::religion:
+		state.world.rebel_faction_set_religion(f, state.world.pop_get_religion(p));
+		state.world.rebel_faction_set_defection_target(f, ind_tag);
+		break;
+	case culture::rebel_independence::pan_nationalist: {
+		auto cg = state.world.culture_get_group_from_culture_group_membership(state.world.pop_get_culture(p));
+		auto u = state.world.culture_group_get_identity_from_cultural_union_of(cg);
+		state.world.rebel_faction_set_defection_target(f, u);
+		break;
+	}
+	case culture::rebel_independence::any:
+		state.world.rebel_faction_set_defection_target(f, ind_tag);
+		break;
+	case culture::rebel_independence::colonial:
+		state.world.rebel_faction_set_defection_target(f, ind_tag);
+		break;
+	default:
+		break;
+	}
+}
+
+dcon::rebel_faction_id create_faction_for_pop(sys::state& state, dcon::rebel_type_id rt, dcon::pop_id p, dcon::nation_id owner) {
+	auto f = state.world.create_rebel_faction();
+	set_faction_identity(state, f, rt, p, independence_target_for_pop(state, p));
+	if(state.world.rebel_type_get_culture_restriction(rt) && !state.world.rebel_faction_get_primary_culture(f)) {
+		state.world.rebel_faction_set_primary_culture(f, state.world.pop_get_culture(p));
+	}
+	if(state.world.rebel_type_get_culture_group_restriction(rt) && !state.world.rebel_faction_get_primary_culture_group(f)) {
+		state.world.rebel_faction_set_primary_culture_group(f, state.world.culture_get_group_from_culture_group_membership(state.world.pop_get_culture(p)));
+	}
+	state.world.try_create_rebellion_within(f, owner);
+	return f;
+}
+
+// true if some spawn chance reads the faction in the from slot; such a chance can only be evaluated against a real faction
+bool spawn_chance_reads_faction(sys::state& state) {
+	for(auto rt : state.world.in_rebel_type) {
+		auto base = state.value_modifiers[rt.get_spawn_chance()];
+		for(uint32_t i = 0; i < base.segments_count; ++i) {
+			auto seg = state.value_modifier_segments[base.first_segment_offset + i];
+			if(seg.condition && size_t(seg.condition.index()) < state.trigger_is_volatile.size() && state.trigger_is_volatile[seg.condition.index()] != 0)
+				return true;
+		}
+	}
+	return false;
+}
+
+enum class rebel_action : uint8_t {
+	none, leave, join_occupier, evaluate
+};
+struct rebel_choice {
+	dcon::rebel_faction_id existing_best;
+	float existing_chance = 0.0f;
+	dcon::rebel_type_id new_type;
+	float new_chance = 0.0f;
+	rebel_action action = rebel_action::none;
+};
+
+// everything faction and rebel type compatibility depends on; the owner and its factions follow from the province
+struct rebel_signature {
+	dcon::province_id location;
+	dcon::culture_id culture;
+	dcon::religion_id religion;
+	dcon::ideology_id ideology;
+	bool accepted = false;
+
+	bool operator==(rebel_signature const& o) const noexcept {
+		return location == o.location && culture == o.culture && religion == o.religion && ideology == o.ideology && accepted == o.accepted;
+	}
+	bool operator<(rebel_signature const& o) const noexcept {
+		if(location != o.location)
+			return location.index() < o.location.index();
+		if(culture != o.culture)
+			return culture.index() < o.culture.index();
+		if(religion != o.religion)
+			return religion.index() < o.religion.index();
+		if(ideology != o.ideology)
+			return ideology.index() < o.ideology.index();
+		return int32_t(accepted) < int32_t(o.accepted);
+	}
+};
+
+rebel_signature signature_of(sys::state& state, dcon::pop_id p) {
+	return rebel_signature{ state.world.pop_get_province_from_pop_location(p), state.world.pop_get_culture(p),
+		state.world.pop_get_religion(p), state.world.pop_get_dominant_ideology(p), state.world.pop_get_is_primary_or_accepted_culture(p) };
+}
+
+void update_pop_rebel_membership_with_scratch_faction(sys::state& state);
+
 void update_pop_rebel_membership(sys::state& state) {
+	if(spawn_chance_reads_faction(state)) {
+		update_pop_rebel_membership_with_scratch_faction(state);
+		return;
+	}
+
+	/*
+	Compatibility with factions and rebel types depends only on the pop's signature, so militant pops are bucketed by
+	signature and each bucket works out its compatible factions and types once. The spawn chances still depend on the
+	individual pop, and are evaluated per pop, in parallel across buckets, without modifying anything. The choices are
+	then applied serially in pop order. A faction created by an earlier pop is considered by the later pops of the same
+	nation at that point, just as it would be when processing pops one at a time.
+	*/
+
+	std::vector<dcon::pop_id> militant;
+	for(auto p : state.world.in_pop) {
+		if(p.get_militancy() >= state.defines.mil_to_join_rebel && nations::owner_of_pop(state, p))
+			militant.push_back(p);
+	}
+	std::vector<rebel_signature> signatures(state.world.pop_size());
+	for(auto p : militant)
+		signatures[p.index()] = signature_of(state, p);
+	std::sort(militant.begin(), militant.end(), [&](dcon::pop_id a, dcon::pop_id b) {
+		if(signatures[a.index()] == signatures[b.index()])
+			return a.index() < b.index();
+		return signatures[a.index()] < signatures[b.index()];
+	});
+	std::vector<uint32_t> bucket_starts;
+	for(uint32_t i = 0; i < militant.size(); ++i) {
+		if(i == 0 || !(signatures[militant[i].index()] == signatures[militant[i - 1].index()]))
+			bucket_starts.push_back(i);
+	}
+	bucket_starts.push_back(uint32_t(militant.size()));
+
+	std::vector<rebel_choice> choices(state.world.pop_size());
+	concurrency::parallel_for(uint32_t(0), uint32_t(bucket_starts.size() - 1), [&](uint32_t b) {
+		auto rep = militant[bucket_starts[b]];
+		auto owner = nations::owner_of_pop(state, rep);
+		auto prov = state.world.pop_get_province_from_pop_location(rep);
+
+		/*
+		- A pop in a province sieged or controlled by rebels will join that faction, if the pop is compatible with the
+		faction.
+		*/
+		auto occupying_faction = state.world.province_get_rebel_faction_from_province_rebel_control(prov);
+		bool joins_occupier = occupying_faction && pop_is_compatible_with_rebel_faction(state, rep, occupying_faction);
+
+		std::vector<dcon::rebel_faction_id> compatible_factions;
+		std::vector<dcon::rebel_type_id> possible_types;
+		if(!joins_occupier) {
+			for(auto rf : state.world.nation_get_rebellion_within(owner)) {
+				if(pop_is_compatible_with_rebel_faction(state, rep, rf.get_rebels()))
+					compatible_factions.push_back(rf.get_rebels());
+			}
+			auto ind_tag = independence_target_for_pop(state, rep);
+			state.world.for_each_rebel_type([&](dcon::rebel_type_id rt) {
+				if(pop_can_form_rebel_type(state, rep, rt, ind_tag))
+					possible_types.push_back(rt);
+			});
+		}
+
+		for(auto i = bucket_starts[b]; i < bucket_starts[b + 1]; ++i) {
+			auto p = militant[i];
+			auto& c = choices[p.index()];
+			auto existing_faction = state.world.pop_get_rebel_faction_from_pop_rebellion_membership(p);
+			if(existing_faction && !pop_is_compatible_with_rebel_faction(state, rep, existing_faction)) {
+				c.action = rebel_action::leave;
+			} else if(joins_occupier) {
+				c.action = rebel_action::join_occupier;
+			} else {
+				/*
+				- Otherwise take all the compatible and possible rebel types. Determine the spawn chance for each of them, by
+				taking the *product* of the modifiers. The pop then joins the type with the greatest chance (that's right, it
+				isn't really a *chance* at all). If that type has a defection type, it joins the faction with the national
+				identity most compatible with it and that type (pan-nationalist go to the union tag, everyone else uses the
+				logic I outline below)
+				*/
+				c.action = rebel_action::evaluate;
+				for(auto f : compatible_factions) {
+					auto chance = state.world.rebel_type_get_spawn_chance(state.world.rebel_faction_get_type(f));
+					auto eval = trigger::evaluate_multiplicative_modifier(state, chance, trigger::to_generic(p),
+							trigger::to_generic(owner), trigger::to_generic(f));
+					if(eval > c.existing_chance) {
+						c.existing_best = f;
+						c.existing_chance = eval;
+					}
+				}
+				for(auto rt : possible_types) {
+					auto chance = state.world.rebel_type_get_spawn_chance(rt);
+					auto eval = trigger::evaluate_multiplicative_modifier(state, chance, trigger::to_generic(p),
+							trigger::to_generic(owner), trigger::to_generic(dcon::rebel_faction_id{}));
+					if(eval > c.new_chance) {
+						c.new_type = rt;
+						c.new_chance = eval;
+					}
+				}
+			}
+		}
+	});
+
+	std::vector<std::pair<dcon::nation_id, dcon::rebel_faction_id>> created_factions;
+	for(auto p : state.world.in_pop) {
+		auto owner = nations::owner_of_pop(state, p);
+		// pops not in a nation can't be in a rebel faction
+		if(!owner)
+			continue;
+
+		if(p.get_militancy() < state.defines.mil_to_join_rebel) { // less than: MIL_TO_JOIN_REBEL will join a rebel_faction -- leave faction
+			if(p.get_rebel_faction_from_pop_rebellion_membership())
+				remove_pop_from_rebel_faction(state, p);
+			continue;
+		}
+
+		auto& c = choices[p.id.index()];
+		switch(c.action) {
+		case rebel_action::none:
+			break;
+		case rebel_action::leave:
+			remove_pop_from_rebel_faction(state, p);
+			break;
+		case rebel_action::join_occupier:
+			add_pop_to_rebel_faction(state, p, p.get_province_from_pop_location().get_rebel_faction_from_province_rebel_control());
+			break;
+		case rebel_action::evaluate:
+		{
+			float greatest_chance = c.existing_chance;
+			dcon::rebel_faction_id f = c.existing_best;
+			for(auto& cf : created_factions) {
+				if(cf.first == owner && pop_is_compatible_with_rebel_faction(state, p, cf.second)) {
+					auto chance = state.world.rebel_type_get_spawn_chance(state.world.rebel_faction_get_type(cf.second));
+					auto eval = trigger::evaluate_multiplicative_modifier(state, chance, trigger::to_generic(p.id),
+							trigger::to_generic(owner), trigger::to_generic(cf.second));
+					if(eval > greatest_chance) {
+						f = cf.second;
+						greatest_chance = eval;
+					}
+				}
+			}
+			if(c.new_chance > greatest_chance) {
+				f = create_faction_for_pop(state, c.new_type, p, owner);
+				created_factions.emplace_back(owner, f);
+				greatest_chance = c.new_chance;
+			}
+			if(greatest_chance > 0) {
+				add_pop_to_rebel_faction(state, p, f);
+			}
+			break;
+		}
+		}
+	}
+}
+
+// the one-pop-at-a-time version, which evaluates spawn chances against a scratch faction; used when the spawn chances
+// read the faction they are evaluated for
+void update_pop_rebel_membership_with_scratch_faction(sys::state& state) {
 	state.world.for_each_pop([&](dcon::pop_id p) {
 		auto owner = nations::owner_of_pop(state, p);
 		// pops not in a nation can't be in a rebel faction
@@ -443,23 +835,11 @@ void update_pop_rebel_membership(sys::state& state) {
 				remove_pop_from_rebel_faction(state, p);
 			} else {
 				auto prov = state.world.pop_get_province_from_pop_location(p);
-				/*
-				- A pop in a province sieged or controlled by rebels will join that faction, if the pop is compatible with the
-				faction.
-				*/
-
 				auto occupying_faction = state.world.province_get_rebel_faction_from_province_rebel_control(prov);
 				if(occupying_faction && pop_is_compatible_with_rebel_faction(state, p, occupying_faction)) {
 					assert(!bool(state.world.province_get_nation_from_province_control(prov)));
 					add_pop_to_rebel_faction(state, p, occupying_faction);
 				} else {
-					/*
-					- Otherwise take all the compatible and possible rebel types. Determine the spawn chance for each of them, by
-					taking the *product* of the modifiers. The pop then joins the type with the greatest chance (that's right, it
-					isn't really a *chance* at all). If that type has a defection type, it joins the faction with the national
-					identity most compatible with it and that type (pan-nationalist go to the union tag, everyone else uses the
-					logic I outline below)
-					*/
 					float greatest_chance = 0.0f;
 					dcon::rebel_faction_id f;
 					for(auto rf : state.world.nation_get_rebellion_within(owner)) {
@@ -475,124 +855,12 @@ void update_pop_rebel_membership(sys::state& state) {
 					}
 
 					dcon::rebel_faction_id temp = state.world.create_rebel_faction();
-					dcon::national_identity_id ind_tag = [&]() {
-						auto prov = state.world.pop_get_province_from_pop_location(p);
-						for(auto core : state.world.province_get_core(prov)) {
-							if(!core.get_identity().get_is_not_releasable() && core.get_identity().get_primary_culture() == state.world.pop_get_culture(p))
-								return core.get_identity().id;
-						}
-						return dcon::national_identity_id{};
-					}();
-
+					auto ind_tag = independence_target_for_pop(state, p);
 					dcon::rebel_type_id max_type;
 
 					state.world.for_each_rebel_type([&](dcon::rebel_type_id rt) {
-						if(pop_is_compatible_with_rebel_type(state, p, rt)) {
-							state.world.rebel_faction_set_type(temp, rt);
-							state.world.rebel_faction_set_defection_target(temp, dcon::national_identity_id{});
-							state.world.rebel_faction_set_primary_culture(temp, dcon::culture_id{});
-							state.world.rebel_faction_set_primary_culture_group(temp, dcon::culture_group_id{});
-							state.world.rebel_faction_set_religion(temp, dcon::religion_id{});
-
-							switch(culture::rebel_defection(state.world.rebel_type_get_defection(rt))) {
-							case culture::rebel_defection::culture:
-								state.world.rebel_faction_set_primary_culture(temp, state.world.pop_get_culture(p));
-								state.world.rebel_faction_set_defection_target(temp, ind_tag);
-								if(!ind_tag)
-									return; // skip -- no defection possible
-								if(state.world.pop_get_is_primary_or_accepted_culture(p))
-									return; // skip -- can't defect
-								break;
-							case culture::rebel_defection::culture_group:
-								state.world.rebel_faction_set_primary_culture_group(temp,
-										state.world.culture_get_group_from_culture_group_membership(state.world.pop_get_culture(p)));
-								state.world.rebel_faction_set_defection_target(temp, ind_tag);
-								if(!ind_tag)
-									return; // skip -- no defection possible
-								if(state.world.pop_get_is_primary_or_accepted_culture(p))
-									return; // skip -- can't defect
-								break;
-							case culture::rebel_defection::religion:
-								state.world.rebel_faction_set_religion(temp, state.world.pop_get_religion(p));
-								state.world.rebel_faction_set_defection_target(temp, ind_tag);
-								if(!ind_tag)
-									return; // skip -- no defection possible
-								if(state.world.pop_get_is_primary_or_accepted_culture(p))
-									return; // skip -- can't defect
-								break;
-							case culture::rebel_defection::pan_nationalist: {
-								auto cg = state.world.culture_get_group_from_culture_group_membership(state.world.pop_get_culture(p));
-								auto u = state.world.culture_group_get_identity_from_cultural_union_of(cg);
-								if(!u)
-									return; // skip -- no pan nationalist possible
-								state.world.rebel_faction_set_defection_target(temp, u);
-								break;
-							}
-							case culture::rebel_defection::any:
-								state.world.rebel_faction_set_defection_target(temp, ind_tag);
-								if(!ind_tag)
-									return; // skip -- no defection possible
-								if(state.world.pop_get_is_primary_or_accepted_culture(p))
-									return; // skip -- can't defect
-								break;
-							default:
-								break;
-							}
-
-							switch(culture::rebel_independence(state.world.rebel_type_get_independence(rt))) {
-							case culture::rebel_independence::culture:
-								state.world.rebel_faction_set_primary_culture(temp, state.world.pop_get_culture(p));
-								state.world.rebel_faction_set_defection_target(temp, ind_tag);
-								if(!ind_tag)
-									return; // skip -- no defection possible
-								if(state.world.pop_get_is_primary_or_accepted_culture(p))
-									return; // skip -- can't defect
-								break;
-							case culture::rebel_independence::culture_group:
-								state.world.rebel_faction_set_primary_culture_group(temp,
-										state.world.culture_get_group_from_culture_group_membership(state.world.pop_get_culture(p)));
-								state.world.rebel_faction_set_defection_target(temp, ind_tag);
-								if(!ind_tag)
-									return; // skip -- no defection possible
-								if(state.world.pop_get_is_primary_or_accepted_culture(p))
-									return; // skip -- can't defect
-								break;
-							case culture::rebel_independence::religion:
-								state.world.rebel_faction_set_religion(temp, state.world.pop_get_religion(p));
-								state.world.rebel_faction_set_defection_target(temp, ind_tag);
-								if(!ind_tag)
-									return; // skip -- no defection possible
-								if(state.world.pop_get_is_primary_or_accepted_culture(p))
-									return; // skip -- can't defect
-								break;
-							case culture::rebel_independence::pan_nationalist: {
-								auto cg = state.world.culture_get_group_from_culture_group_membership(state.world.pop_get_culture(p));
-								auto u = state.world.culture_group_get_identity_from_cultural_union_of(cg);
-								if(!u)
-									return; // skip -- no pan nationalist possible
-								if(state.world.pop_get_is_primary_or_accepted_culture(p))
-									return; // skip -- can't defect
-								state.world.rebel_faction_set_defection_target(temp, u);
-								break;
-							}
-							case culture::rebel_independence::any:
-								state.world.rebel_faction_set_defection_target(temp, ind_tag);
-								if(!ind_tag)
-									return; // skip -- no defection possible
-								if(state.world.pop_get_is_primary_or_accepted_culture(p))
-									return; // skip -- can't defect
-								break;
-							case culture::rebel_independence::colonial:
-								state.world.rebel_faction_set_defection_target(temp, ind_tag);
-								if(!ind_tag)
-									return; // skip -- no defection possible
-								if(state.world.pop_get_is_primary_or_accepted_culture(p))
-									return; // skip -- can't defect
-								break;
-							default:
-								break;
-							}
-
+						if(pop_can_form_rebel_type(state, p, rt, ind_tag)) {
+							set_faction_identity(state, temp, rt, p, ind_tag);
 							auto chance = state.world.rebel_type_get_spawn_chance(rt);
 							auto eval = trigger::evaluate_multiplicative_modifier(state, chance, trigger::to_generic(p),
 									trigger::to_generic(owner), trigger::to_generic(temp));
@@ -604,81 +872,9 @@ void update_pop_rebel_membership(sys::state& state) {
 						}
 					});
 
-					if(f != temp) {
-						state.world.delete_rebel_faction(temp);
-					} else {
-						auto rt = max_type;
-						state.world.rebel_faction_set_type(temp, rt);
-						state.world.rebel_faction_set_defection_target(temp, dcon::national_identity_id{});
-						state.world.rebel_faction_set_primary_culture(temp, dcon::culture_id{});
-						state.world.rebel_faction_set_primary_culture_group(temp, dcon::culture_group_id{});
-						state.world.rebel_faction_set_religion(temp, dcon::religion_id{});
-
-						switch(culture::rebel_defection(state.world.rebel_type_get_defection(rt))) {
-						case culture::rebel_defection::culture:
-							state.world.rebel_faction_set_primary_culture(temp, state.world.pop_get_culture(p));
-							state.world.rebel_faction_set_defection_target(temp, ind_tag);
-							break;
-						case culture::rebel_defection::culture_group:
-							state.world.rebel_faction_set_primary_culture_group(temp,
-									state.world.culture_get_group_from_culture_group_membership(state.world.pop_get_culture(p)));
-							state.world.rebel_faction_set_defection_target(temp, ind_tag);
-							break;
-						case culture::rebel_defection::religion:
-							state.world.rebel_faction_set_religion(temp, state.world.pop_get_religion(p));
-							state.world.rebel_faction_set_defection_target(temp, ind_tag);
-							break;
-						case culture::rebel_defection::pan_nationalist: {
-							auto cg = state.world.culture_get_group_from_culture_group_membership(state.world.pop_get_culture(p));
-							auto u = state.world.culture_group_get_identity_from_cultural_union_of(cg);
-							state.world.rebel_faction_set_defection_target(temp, u);
-							break;
-						}
-						case culture::rebel_defection::any:
-							state.world.rebel_faction_set_defection_target(temp, ind_tag);
-							break;
-						default:
-							break;
-						}
-
-						switch(culture::rebel_independence(state.world.rebel_type_get_independence(rt))) {
-						case culture::rebel_independence::culture:
-							state.world.rebel_faction_set_primary_culture(temp, state.world.pop_get_culture(p));
-							state.world.rebel_faction_set_defection_target(temp, ind_tag);
-							break;
-						case culture::rebel_independence::culture_group:
-							state.world.rebel_faction_set_primary_culture_group(temp,
-									state.world.culture_get_group_from_culture_group_membership(state.world.pop_get_culture(p)));
-							state.world.rebel_faction_set_defection_target(temp, ind_tag);
-							break;
-						case culture::rebel_independence::religion:
-							state.world.rebel_faction_set_religion(temp, state.world.pop_get_religion(p));
-							state.world.rebel_faction_set_defection_target(temp, ind_tag);
-							break;
-						case culture::rebel_independence::pan_nationalist: {
-							auto cg = state.world.culture_get_group_from_culture_group_membership(state.world.pop_get_culture(p));
-							auto u = state.world.culture_group_get_identity_from_cultural_union_of(cg);
-							state.world.rebel_faction_set_defection_target(temp, u);
-							break;
-						}
-						case culture::rebel_independence::any:
-							state.world.rebel_faction_set_defection_target(temp, ind_tag);
-							break;
-						case culture::rebel_independence::colonial:
-							state.world.rebel_faction_set_defection_target(temp, ind_tag);
-							break;
-						default:
-							break;
-						}
-
-						if(state.world.rebel_type_get_culture_restriction(rt) && !state.world.rebel_faction_get_primary_culture(temp)) {
-							state.world.rebel_faction_set_primary_culture(temp, state.world.pop_get_culture(p));
-						}
-						if(state.world.rebel_type_get_culture_group_restriction(rt) && !state.world.rebel_faction_get_primary_culture_group(temp)) {
-							state.world.rebel_faction_set_primary_culture_group(temp, state.world.culture_get_group_from_culture_group_membership(state.world.pop_get_culture(p)));
-						}
-
-						state.world.try_create_rebellion_within(temp, owner);
+					state.world.delete_rebel_faction(temp);
+					if(f == temp) {
+						f = create_faction_for_pop(state, max_type, p, owner);
 					}
 
 					if(greatest_chance > 0) {
@@ -1305,14 +1501,14 @@ void update_armies(sys::state& state) {
 		}
 		dcon::province_fat_id best_prov = location;
 		float best_weight = 0.f;// trigger::evaluate_multiplicative_modifier(state, type.get_movement_evaluation(), trigger::to_generic(best_prov), trigger::to_generic(best_prov), 0);;
-		for(const auto adj : location.get_province_adjacency()) {
-			auto indx = adj.get_connected_provinces(0) != location.id ? 0 : 1;
-			auto prov = adj.get_connected_provinces(indx);
+		auto& graph = state.province_definitions.adjacency;
+		for(auto i = graph.offsets[location.id.index()]; i < graph.offsets[location.id.index() + 1]; ++i) {
+			auto prov = fatten(state.world, graph.neighbors[i]);
 			/* sea province */
 			if(prov.id.index() >= state.province_definitions.first_sea_province.index())
 				continue;
 			/* impassable */
-			if((adj.get_type() & province::border::impassible_bit) != 0)
+			if((graph.types[i] & province::border::impassible_bit) != 0)
 				continue;
 			if(allow_in_area(state, prov, arc.get_controller())) {
 				//float weight = trigger::evaluate_multiplicative_modifier(state, type.get_movement_evaluation(), trigger::to_generic(prov), trigger::to_generic(prov), trigger::to_generic(arc.get_controller()));
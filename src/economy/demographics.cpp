@@ -2,6 +2,7 @@
 #include "dcon_generated.hpp"
 #include "system_state.hpp"
 #include "nations.hpp"
+#include "triggers.hpp"
 
 namespace pop_demographics {
 
@@ -2292,5 +2293,157 @@ void remove_small_pops(sys::state& state) {
 	}
 }
 
+void reorder_pops(sys::state& state, std::vector<dcon::pop_id> const& new_order) {
+	auto count = state.world.pop_size();
+	assert(new_order.size() == count);
+	auto key_count = pop_demographics::size(state);
+
+	// snapshot everything that belongs to a pop so that it can be written back in the new order
+
+	std::vector<dcon::pop_type_id> poptype(count);
+	std::vector<dcon::religion_id> religion(count);
+	std::vector<dcon::culture_id> culture(count);
+	std::vector<float> size(count);
+	std::vector<float> savings(count);
+	std::vector<float> consciousness(count);
+	std::vector<float> militancy(count);
+	std::vector<float> literacy(count);
+	std::vector<float> employment(count);
+	std::vector<float> life_needs(count);
+	std::vector<float> everyday_needs(count);
+	std::vector<float> luxury_needs(count);
+	std::vector<float> political_desire(count);
+	std::vector<float> social_desire(count);
+	std::vector<dcon::ideology_id> dominant_ideology(count);
+	std::vector<dcon::issue_option_id> dominant_issue(count);
+	std::vector<uint8_t> primary_or_accepted(count);
+	std::vector<float> pop_demo(size_t(count) * key_count);
+	std::vector<dcon::province_id> location(count);
+	std::vector<dcon::movement_id> movement(count);
+	std::vector<dcon::rebel_faction_id> faction(count);
+
+	for(uint32_t i = 0; i < count; ++i) {
+		dcon::pop_id p{ dcon::pop_id::value_base_t(i) };
+		poptype[i] = state.world.pop_get_poptype(p);
+		religion[i] = state.world.pop_get_religion(p);
+		culture[i] = state.world.pop_get_culture(p);
+		size[i] = state.world.pop_get_size(p);
+		savings[i] = state.world.pop_get_savings(p);
+		consciousness[i] = state.world.pop_get_consciousness(p);
+		militancy[i] = state.world.pop_get_militancy(p);
+		literacy[i] = state.world.pop_get_literacy(p);
+		employment[i] = state.world.pop_get_employment(p);
+		life_needs[i] = state.world.pop_get_life_needs_satisfaction(p);
+		everyday_needs[i] = state.world.pop_get_everyday_needs_satisfaction(p);
+		luxury_needs[i] = state.world.pop_get_luxury_needs_satisfaction(p);
+		political_desire[i] = state.world.pop_get_political_reform_desire(p);
+		social_desire[i] = state.world.pop_get_social_reform_desire(p);
+		dominant_ideology[i] = state.world.pop_get_dominant_ideology(p);
+		dominant_issue[i] = state.world.pop_get_dominant_issue_option(p);
+		primary_or_accepted[i] = state.world.pop_get_is_primary_or_accepted_culture(p) ? 1 : 0;
+		for(uint32_t k = 0; k < key_count; ++k) {
+			pop_demo[size_t(i) * key_count + k] = state.world.pop_get_demographics(p, dcon::pop_demographics_key{ dcon::pop_demographics_key::value_base_t(k) });
+		}
+		location[i] = state.world.pop_get_province_from_pop_location(p);
+		movement[i] = state.world.pop_get_movement_from_pop_movement_membership(p);
+		faction[i] = state.world.pop_get_rebel_faction_from_pop_rebellion_membership(p);
+	}
+
+	// memberships are unique per pop, so they are dropped here and recreated for the new ids below
+	for(uint32_t i = 0; i < count; ++i) {
+		dcon::pop_id p{ dcon::pop_id::value_base_t(i) };
+		if(auto m = state.world.pop_get_pop_movement_membership(p); m)
+			state.world.delete_pop_movement_membership(m);
+		if(auto m = state.world.pop_get_pop_rebellion_membership(p); m)
+			state.world.delete_pop_rebellion_membership(m);
+	}
+
+	std::vector<dcon::pop_id> old_to_new(count);
+	for(uint32_t i = 0; i < count; ++i) {
+		old_to_new[new_order[i].index()] = dcon::pop_id{ dcon::pop_id::value_base_t(i) };
+	}
+
+	for(uint32_t i = 0; i < count; ++i) {
+		dcon::pop_id p{ dcon::pop_id::value_base_t(i) };
+		auto o = new_order[i].index();
+		state.world.pop_set_poptype(p, poptype[o]);
+		state.world.pop_set_religion(p, religion[o]);
+		state.world.pop_set_culture(p, culture[o]);
+		state.world.pop_set_size(p, size[o]);
+		state.world.pop_set_savings(p, savings[o]);
+		state.world.pop_set_consciousness(p, consciousness[o]);
+		state.world.pop_set_militancy(p, militancy[o]);
+		state.world.pop_set_literacy(p, literacy[o]);
+		state.world.pop_set_employment(p, employment[o]);
+		state.world.pop_set_life_needs_satisfaction(p, life_needs[o]);
+		state.world.pop_set_everyday_needs_satisfaction(p, everyday_needs[o]);
+		state.world.pop_set_luxury_needs_satisfaction(p, luxury_needs[o]);
+		state.world.pop_set_political_reform_desire(p, political_desire[o]);
+		state.world.pop_set_social_reform_desire(p, social_desire[o]);
+		state.world.pop_set_dominant_ideology(p, dominant_ideology[o]);
+		state.world.pop_set_dominant_issue_option(p, dominant_issue[o]);
+		state.world.pop_set_is_primary_or_accepted_culture(p, primary_or_accepted[o] != 0);
+		for(uint32_t k = 0; k < key_count; ++k) {
+			state.world.pop_set_demographics(p, dcon::pop_demographics_key{ dcon::pop_demographics_key::value_base_t(k) }, pop_demo[size_t(o) * key_count + k]);
+		}
+		state.world.pop_set_province_from_pop_location(p, location[o]);
+		if(movement[o])
+			state.world.try_create_pop_movement_membership(p, movement[o]);
+		if(faction[o])
+			state.world.try_create_pop_rebellion_membership(p, faction[o]);
+	}
+
+	// remap the relationships that point at pops from the other side
+	for(auto r : state.world.in_regiment) {
+		if(auto p = r.get_pop_from_regiment_source(); p)
+			r.set_pop_from_regiment_source(old_to_new[p.id.index()]);
+	}
+	for(auto c : state.world.in_province_land_construction) {
+		if(auto p = c.get_pop(); p)
+			c.set_pop(old_to_new[p.id.index()]);
+	}
+
+	// and the pops that pending and postponed events were raised for, which are kept outside of the data container
+	auto remap_slot = [&](int32_t& slot, event::slot_type t) {
+		if(t != event::slot_type::pop)
+			return;
+		auto p = trigger::to_pop(slot);
+		if(p && uint32_t(p.index()) < count)
+			slot = trigger::to_generic(old_to_new[p.index()]);
+	};
+	for(auto* events : { &state.pending_n_event, &state.future_n_event }) {
+		for(auto& e : *events) {
+			remap_slot(e.primary_slot, e.pt);
+			remap_slot(e.from_slot, e.ft);
+		}
+	}
+	for(auto* events : { &state.pending_p_event, &state.future_p_event }) {
+		for(auto& e : *events)
+			remap_slot(e.from_slot, e.ft);
+	}
+}
+
+void compact_pops_by_location(sys::state& state) {
+	auto count = state.world.pop_size();
+	std::vector<dcon::pop_id> new_order(count);
+	for(uint32_t i = 0; i < count; ++i) {
+		new_order[i] = dcon::pop_id{ dcon::pop_id::value_base_t(i) };
+	}
+	// stable on the old index, so the result depends only on the current layout
+	std::stable_sort(new_order.begin(), new_order.end(), [&](dcon::pop_id a, dcon::pop_id b) {
+		return state.world.pop_get_province_from_pop_location(a).index() < state.world.pop_get_province_from_pop_location(b).index();
+	});
+
+	bool already_ordered = true;
+	for(uint32_t i = 0; i < count; ++i) {
+		if(new_order[i].index() != int32_t(i)) {
+			already_ordered = false;
+			break;
+		}
+	}
+	if(!already_ordered)
+		reorder_pops(state, new_order);
+}
+
 
 } // namespace demographics
@@ -170,6 +170,10 @@ void apply_immigration(sys::state& state, uint32_t offset, uint32_t divisions, m
 
 void remove_size_zero_pops(sys::state& state);
 void remove_small_pops(sys::state& state);
+// moves pops so that slot i holds the pop previously stored at new_order[i], remapping every reference to a pop
+void reorder_pops(sys::state& state, std::vector<dcon::pop_id> const& new_order);
+// stores the pops of each province contiguously, in province order
+void compact_pops_by_location(sys::state& state);
 
 float get_monthly_pop_increase(sys::state& state, dcon::pop_id);
 int64_t get_monthly_pop_increase(sys::state& state, dcon::nation_id n);
@@ -1671,15 +1671,10 @@ void update_national_consumption(sys::state& state, dcon::nation_id n,
 	}
 }
 
-void update_pop_consumption(sys::state& state, dcon::nation_id n, dcon::province_id p, ve::vectorizable_buffer<float, dcon::commodity_id> const& effective_prices, float base_demand, float invention_factor) {
-	uint32_t total_commodities = state.world.commodity_size();
-
-	static auto ln_demand_vector = state.world.pop_type_make_vectorizable_float_buffer();
-	state.world.execute_serial_over_pop_type([&](auto ids) { ln_demand_vector.set(ids, ve::fp_vector{}); });
-	static auto en_demand_vector = state.world.pop_type_make_vectorizable_float_buffer();
-	state.world.execute_serial_over_pop_type([&](auto ids) { en_demand_vector.set(ids, ve::fp_vector{}); });
-	static auto lx_demand_vector = state.world.pop_type_make_vectorizable_float_buffer();
-	state.world.execute_serial_over_pop_type([&](auto ids) { lx_demand_vector.set(ids, ve::fp_vector{}); });
+void update_pop_consumption(sys::state& state, dcon::nation_id n, dcon::province_id p,
+		ve::vectorizable_buffer<float, dcon::pop_type_id>& ln_demand_vector,
+		ve::vectorizable_buffer<float, dcon::pop_type_id>& en_demand_vector,
+		ve::vectorizable_buffer<float, dcon::pop_type_id>& lx_demand_vector) {
 
 	// needs_scaling_factor
 
@@ -1723,6 +1718,21 @@ void update_pop_consumption(sys::state& state, dcon::nation_id n, dcon::province
 		en_demand_vector.get(t) += everyday_needs_fraction * total_pop / needs_scaling_factor;
 		lx_demand_vector.get(t) += luxury_needs_fraction * total_pop / needs_scaling_factor;
 	}
+}
+
+void update_pop_needs_demand(sys::state& state, dcon::nation_id n,
+		ve::vectorizable_buffer<float, dcon::pop_type_id> const& ln_demand_vector,
+		ve::vectorizable_buffer<float, dcon::pop_type_id> const& en_demand_vector,
+		ve::vectorizable_buffer<float, dcon::pop_type_id> const& lx_demand_vector,
+		float base_demand, float invention_factor) {
+	/*
+	The demand of a pop type for a commodity is linear in the amount of needs it bought, so the provinces of a nation are
+	summed per pop type first (see update_pop_consumption) and turned into commodity demand once per nation. The needs of
+	all pop types for a single commodity are stored together, so they are processed ve::vector_size pop types at a time and
+	then summed across the lanes; the pop type buffers are padded with zeros, so the number of pop types (or of
+	commodities) does not have to be a multiple of the vector width.
+	*/
+	uint32_t total_commodities = state.world.commodity_size();
 
 	float ln_mul[] = {state.world.nation_get_modifier_values(n, sys::national_mod_offsets::poor_life_needs) + 1.0f,
 			state.world.nation_get_modifier_values(n, sys::national_mod_offsets::middle_life_needs) + 1.0f,
@@ -1736,24 +1746,39 @@ void update_pop_consumption(sys::state& state, dcon::nation_id n, dcon::province
 			state.world.nation_get_modifier_values(n, sys::national_mod_offsets::rich_luxury_needs) + 1.0f,
 	};
 
+	static auto ln_scaled = state.world.pop_type_make_vectorizable_float_buffer();
+	static auto en_scaled = state.world.pop_type_make_vectorizable_float_buffer();
+	static auto lx_scaled = state.world.pop_type_make_vectorizable_float_buffer();
 	state.world.for_each_pop_type([&](dcon::pop_type_id t) {
-		for(uint32_t i = 1; i < total_commodities; ++i) {
-			dcon::commodity_id cid{dcon::commodity_id::value_base_t(i)};
+		auto strata = state.world.pop_type_get_strata(t);
+		ln_scaled.set(t, ln_demand_vector.get(t) * ln_mul[strata]);
+		en_scaled.set(t, en_demand_vector.get(t) * en_mul[strata]);
+		lx_scaled.set(t, lx_demand_vector.get(t) * lx_mul[strata]);
+	});
 
-			auto kf = state.world.commodity_get_key_factory(cid);
-			if(state.world.commodity_get_is_available_from_start(cid) || (kf && state.world.nation_get_active_building(n, kf))) {
-				auto strata = state.world.pop_type_get_strata(t);
+	for(uint32_t i = 1; i < total_commodities; ++i) {
+		dcon::commodity_id cid{dcon::commodity_id::value_base_t(i)};
+
+		auto kf = state.world.commodity_get_key_factory(cid);
+		if(state.world.commodity_get_is_available_from_start(cid) || (kf && state.world.nation_get_active_building(n, kf))) {
+			ve::fp_vector ln_sum;
+			ve::fp_vector en_sum;
+			ve::fp_vector lx_sum;
+			state.world.execute_serial_over_pop_type([&](auto ids) {
+				ln_sum = ln_sum + state.world.pop_type_get_life_needs(ids, cid) * ln_scaled.get(ids);
+				en_sum = en_sum + state.world.pop_type_get_everyday_needs(ids, cid) * en_scaled.get(ids);
+				lx_sum = lx_sum + state.world.pop_type_get_luxury_needs(ids, cid) * lx_scaled.get(ids);
+			});
 
-				state.world.nation_get_real_demand(n, cid) += state.world.pop_type_get_life_needs(t, cid) * ln_demand_vector.get(t) * base_demand * ln_mul[strata] * (state.world.nation_get_life_needs_weights(n, cid) + 1.0f);
+			state.world.nation_get_real_demand(n, cid) += ln_sum.reduce() * base_demand * (state.world.nation_get_life_needs_weights(n, cid) + 1.0f);
 
-				state.world.nation_get_real_demand(n, cid) += state.world.pop_type_get_everyday_needs(t, cid) * en_demand_vector.get(t) * base_demand * invention_factor * en_mul[strata] * (state.world.nation_get_everyday_needs_weights(n, cid) + 1.0f) * en_extra_factor;
+			state.world.nation_get_real_demand(n, cid) += en_sum.reduce() * base_demand * invention_factor * (state.world.nation_get_everyday_needs_weights(n, cid) + 1.0f) * en_extra_factor;
 
-				state.world.nation_get_real_demand(n, cid) += state.world.pop_type_get_luxury_needs(t, cid) * lx_demand_vector.get(t) * base_demand * invention_factor * lx_mul[strata] * (state.world.nation_get_luxury_needs_weights(n, cid) + 1.0f) * lx_extra_factor;
+			state.world.nation_get_real_demand(n, cid) += lx_sum.reduce() * base_demand * invention_factor * (state.world.nation_get_luxury_needs_weights(n, cid) + 1.0f) * lx_extra_factor;
 
-				assert(std::isfinite(state.world.nation_get_real_demand(n, cid)));
-			}
+			assert(std::isfinite(state.world.nation_get_real_demand(n, cid)));
 		}
-	});
+	}
 }
 
 void populate_needs_costs(sys::state& state, ve::vectorizable_buffer<float, dcon::commodity_id> const& effective_prices,
@@ -2187,6 +2212,15 @@ void daily_update(sys::state& state) {
 
 		update_national_artisan_consumption(state, n, effective_prices, artisan_min_wage, mobilization_impact);
 
+		static auto ln_demand_vector = state.world.pop_type_make_vectorizable_float_buffer();
+		static auto en_demand_vector = state.world.pop_type_make_vectorizable_float_buffer();
+		static auto lx_demand_vector = state.world.pop_type_make_vectorizable_float_buffer();
+		state.world.execute_serial_over_pop_type([&](auto ids) {
+			ln_demand_vector.set(ids, ve::fp_vector{});
+			en_demand_vector.set(ids, ve::fp_vector{});
+			lx_demand_vector.set(ids, ve::fp_vector{});
+		});
+
 		for(auto p : state.world.nation_get_province_ownership(n)) {
 			for(auto f : state.world.province_get_factory_location(p.get_province())) {
 				// factory
@@ -2208,9 +2242,11 @@ void daily_update(sys::state& state) {
 			update_province_rgo_consumption(state, p.get_province(), n, mobilization_impact,
 					is_mine ? laborer_min_wage : farmer_min_wage, p.get_province().get_nation_from_province_control() != n);
 
-			update_pop_consumption(state, n, p.get_province(), effective_prices, base_demand, invention_factor);
+			update_pop_consumption(state, n, p.get_province(), ln_demand_vector, en_demand_vector, lx_demand_vector);
 		}
 
+		update_pop_needs_demand(state, n, ln_demand_vector, en_demand_vector, lx_demand_vector, base_demand, invention_factor);
+
 		{
 			// update national spending
 			//
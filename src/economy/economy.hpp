@@ -138,6 +138,15 @@ void regenerate_unsaved_values(sys::state& state);
 void update_rgo_employment(sys::state& state);
 void update_factory_employment(sys::state& state);
 void daily_update(sys::state& state);
+void update_pop_consumption(sys::state& state, dcon::nation_id n, dcon::province_id p,
+		ve::vectorizable_buffer<float, dcon::pop_type_id>& ln_demand_vector,
+		ve::vectorizable_buffer<float, dcon::pop_type_id>& en_demand_vector,
+		ve::vectorizable_buffer<float, dcon::pop_type_id>& lx_demand_vector);
+void update_pop_needs_demand(sys::state& state, dcon::nation_id n,
+		ve::vectorizable_buffer<float, dcon::pop_type_id> const& ln_demand_vector,
+		ve::vectorizable_buffer<float, dcon::pop_type_id> const& en_demand_vector,
+		ve::vectorizable_buffer<float, dcon::pop_type_id> const& lx_demand_vector,
+		float base_demand, float invention_factor);
 void resolve_constructions(sys::state& state);
 
 float stockpile_commodity_daily_increase(sys::state& state, dcon::commodity_id c, dcon::nation_id n);
@@ -17,6 +17,7 @@ int main(int argc, char **argv) {
 			window::emit_error_message(msg, false);
 		}
 #endif
+		native_string replay_log;
 		for(int i = 1; i < argc; ++i) {
 			if(native_string(argv[i]) == NATIVE("-host")) {
 				game_state.network_mode = sys::network_mode_type::host;
@@ -44,6 +45,13 @@ int main(int argc, char **argv) {
 				game_state.network_state.as_v6 = true;
 			} else if(native_string(argv[i]) == NATIVE("-v4")) {
 				game_state.network_state.as_v6 = false;
+			} else if(native_string(argv[i]) == NATIVE("-record")) {
+				game_state.command_log_requested = true;
+			} else if(native_string(argv[i]) == NATIVE("-replay")) {
+				if(i + 1 < argc) {
+					replay_log = native_string(argv[i + 1]);
+					i++;
+				}
 			}
 		}
 
@@ -55,6 +63,12 @@ int main(int argc, char **argv) {
 			return 0;
 		}
 
+		if(!replay_log.empty()) { // headless: replay a recorded command log and exit
+			auto result = command::replay_command_log(game_state, replay_log);
+			command::write_replay_report(game_state, replay_log, result);
+			return (result.loaded && result.checksum_mismatches == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+		}
+
 		network::init(game_state);
 	}
 
@@ -161,6 +161,7 @@ int WINAPI wWinMain(HINSTANCE /*hInstance*/, HINSTANCE /*hPrevInstance*/, LPWSTR
 			}
 #endif
 		} else {
+			native_string replay_log;
 			for(int i = 1; i < num_params; ++i) {
 				if(native_string(parsed_cmd[i]) == NATIVE("-host")) {
 					game_state.network_mode = sys::network_mode_type::host;
@@ -188,6 +189,13 @@ int WINAPI wWinMain(HINSTANCE /*hInstance*/, HINSTANCE /*hPrevInstance*/, LPWSTR
 					game_state.network_state.as_v6 = true;
 				} else if(native_string(parsed_cmd[i]) == NATIVE("-v4")) {
 					game_state.network_state.as_v6 = false;
+				} else if(native_string(parsed_cmd[i]) == NATIVE("-record")) {
+					game_state.command_log_requested = true;
+				} else if(native_string(parsed_cmd[i]) == NATIVE("-replay")) {
+					if(i + 1 < num_params) {
+						replay_log = native_string(parsed_cmd[i + 1]);
+						i++;
+					}
 				}
 			}
 
@@ -199,6 +207,14 @@ int WINAPI wWinMain(HINSTANCE /*hInstance*/, HINSTANCE /*hPrevInstance*/, LPWSTR
 				return 0;
 			}
 
+			if(!replay_log.empty()) { // headless: replay a recorded command log and exit
+				auto result = command::replay_command_log(game_state, replay_log);
+				command::write_replay_report(game_state, replay_log, result);
+				LocalFree(parsed_cmd);
+				CoUninitialize();
+				return (result.loaded && result.checksum_mismatches == 0) ? 0 : 1;
+			}
+
 			network::init(game_state);
 		}
 		LocalFree(parsed_cmd);
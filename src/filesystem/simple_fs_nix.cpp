@@ -438,6 +438,28 @@ void write_file(directory const& dir, native_string_view file_name, char const*
 	}
 }
 
+void append_file(directory const& dir, native_string_view file_name, char const* file_data, uint32_t file_size) {
+	if(dir.parent_system)
+		std::abort();
+
+	native_string full_path = dir.relative_path + NATIVE('/') + native_string(file_name);
+
+	mode_t mode = S_IRWXU | S_IRGRP | S_IXGRP | S_IROTH | S_IXOTH;
+	int file_handle = open(full_path.c_str(), O_WRONLY | O_CREAT | O_APPEND, mode);
+	if(file_handle != -1) {
+		ssize_t written = 0;
+		int64_t size_remaining = file_size;
+		do {
+			written = write(file_handle, file_data, size_t(size_remaining));
+			file_data += written;
+			size_remaining -= written;
+		} while(written >= 0 && size_remaining > 0);
+
+		fsync(file_handle);
+		close(file_handle);
+	}
+}
+
 file_contents view_contents(file const& f) {
 	return f.content;
 }
@@ -2001,12 +2001,12 @@ void take_decision(sys::state& state, dcon::nation_id source, dcon::decision_id
 bool can_take_decision(sys::state& state, dcon::nation_id source, dcon::decision_id d) {
 	{
 		auto condition = state.world.decision_get_potential(d);
-		if(condition && !trigger::evaluate(state, condition, trigger::to_generic(source), trigger::to_generic(source), 0))
+		if(condition && !trigger::evaluate_memoized(state, condition, trigger::to_generic(source), trigger::to_generic(source), 0))
 			return false;
 	}
 	{
 		auto condition = state.world.decision_get_allow(d);
-		if(condition && !trigger::evaluate(state, condition, trigger::to_generic(source), trigger::to_generic(source), 0))
+		if(condition && !trigger::evaluate_memoized(state, condition, trigger::to_generic(source), trigger::to_generic(source), 0))
 			return false;
 	}
 	return true;
@@ -4720,9 +4720,14 @@ bool can_perform_command(sys::state& state, payload& c) {
 	return false;
 }
 
+void log_command(sys::state& state, payload& c);
+
 void execute_command(sys::state& state, payload& c) {
+	trigger::invalidate_memoized_results(state);
 	if(!can_perform_command(state, c))
 		return;
+	if(state.command_log.recording)
+		log_command(state, c);
 	switch(c.type) {
 	case command_type::invalid:
 		std::abort(); // invalid command
@@ -5116,6 +5121,160 @@ void execute_command(sys::state& state, payload& c) {
 	}
 }
 
+/*
+Command log format: a header naming the save the recording started from, followed by a stream of entries. Every entry starts
+with its log_entry_type; commands, checksums and the end marker are followed by the date they applied on. Commands are stored
+with the trailing zero bytes of their data trimmed (payloads are always zeroed before being filled in), which keeps most of them
+to a handful of bytes.
+*/
+constexpr uint32_t command_log_magic = 0x474F4C43; // "CLOG"
+constexpr uint32_t command_log_version = 1;
+
+enum class log_entry_type : uint8_t {
+	command = 1, // date, command type, source, data length, data
+	tick = 2, // single_game_tick was called
+	checksum = 3, // date, save checksum taken before the tick
+	batch_end = 4, // execute_pending_commands finished a batch and updated the derived values
+	end = 5, // date, recording was stopped
+};
+
+template<typename T>
+void log_write(std::vector<uint8_t>& out, T const& v) {
+	auto old_size = out.size();
+	out.resize(old_size + sizeof(T));
+	std::memcpy(out.data() + old_size, &v, sizeof(T));
+}
+
+struct log_reader {
+	uint8_t const* position = nullptr;
+	uint8_t const* end = nullptr;
+
+	template<typename T>
+	bool read(T& v) {
+		if(end - position < ptrdiff_t(sizeof(T)))
+			return false;
+		std::memcpy(&v, position, sizeof(T));
+		position += sizeof(T);
+		return true;
+	}
+	bool read_bytes(void* dest, size_t count) {
+		if(end - position < ptrdiff_t(count))
+			return false;
+		std::memcpy(dest, position, count);
+		position += count;
+		return true;
+	}
+};
+
+bool is_logged_command(command_type t) {
+	switch(t) {
+	case command_type::invalid:
+	case command_type::advance_tick: // recorded as a tick entry
+	case command_type::save_game:
+	case command_type::notify_save_loaded:
+	case command_type::notify_player_oos:
+	case command_type::notify_stop_game:
+	case command_type::notify_pause_game:
+	case command_type::chat_message:
+		return false;
+	default:
+		return true;
+	}
+}
+
+void log_command(sys::state& state, payload& c) {
+	if(!is_logged_command(c.type))
+		return;
+	auto data = reinterpret_cast<uint8_t const*>(&c.data);
+	uint16_t length = uint16_t(sizeof(c.data));
+	while(length > 0 && data[length - 1] == 0)
+		--length;
+
+	auto& out = state.command_log.pending;
+	log_write(out, log_entry_type::command);
+	log_write(out, state.current_date.value);
+	log_write(out, c.type);
+	log_write(out, c.source.value);
+	log_write(out, length);
+	out.insert(out.end(), data, data + length);
+}
+
+void flush_command_log(sys::state& state) {
+	auto& log = state.command_log;
+	if(log.pending.empty())
+		return;
+	auto sdir = simple_fs::get_or_create_save_game_directory();
+	simple_fs::append_file(sdir, log.file_name, reinterpret_cast<char const*>(log.pending.data()), uint32_t(log.pending.size()));
+	log.pending.clear();
+}
+
+void start_command_log(sys::state& state) {
+	auto& log = state.command_log;
+	if(log.recording)
+		return;
+
+	auto save_name = sys::make_save_file_name(state);
+	sys::write_save_file(state, save_name);
+
+	log.file_name = save_name.substr(0, save_name.size() - 4) + NATIVE(".cmdlog"); // replaces .bin
+	log.pending.clear();
+
+	auto save_name_utf8 = simple_fs::native_to_utf8(save_name);
+	log_write(log.pending, command_log_magic);
+	log_write(log.pending, command_log_version);
+	log_write(log.pending, uint32_t(sizeof(payload)));
+	log_write(log.pending, state.scenario_checksum);
+	log_write(log.pending, uint16_t(save_name_utf8.size()));
+	log.pending.insert(log.pending.end(), save_name_utf8.begin(), save_name_utf8.end());
+
+	auto sdir = simple_fs::get_or_create_save_game_directory();
+	simple_fs::write_file(sdir, log.file_name, reinterpret_cast<char const*>(log.pending.data()), uint32_t(log.pending.size()));
+	log.pending.clear();
+	log.recording = true;
+}
+
+void stop_command_log(sys::state& state) {
+	auto& log = state.command_log;
+	if(!log.recording)
+		return;
+	log_write(log.pending, log_entry_type::end);
+	log_write(log.pending, state.current_date.value);
+	flush_command_log(state);
+	log.recording = false;
+}
+
+void update_command_log(sys::state& state) {
+	bool requested = state.command_log_requested.load(std::memory_order::acquire);
+	if(requested && !state.command_log.recording && state.mode == sys::game_mode_type::in_game) {
+		start_command_log(state);
+	} else if(!requested && state.command_log.recording) {
+		stop_command_log(state);
+	}
+}
+
+void log_tick(sys::state& state) {
+	auto& log = state.command_log;
+	if(!log.recording)
+		return;
+	if(log.checksum_interval > 0 && state.current_date.value % log.checksum_interval == 0) {
+		log_write(log.pending, log_entry_type::checksum);
+		log_write(log.pending, state.current_date.value);
+		log_write(log.pending, state.get_save_checksum());
+		flush_command_log(state);
+	}
+	log_write(log.pending, log_entry_type::tick);
+}
+
+void update_after_commands(sys::state& state) {
+	province::update_connected_regions(state);
+	province::update_cached_values(state);
+	nations::update_cached_values(state);
+	trigger::invalidate_memoized_results(state);
+	state.command_generation.fetch_add(1, std::memory_order::release);
+	snapshot::publish(state);
+	state.game_state_updated.store(true, std::memory_order::release);
+}
+
 void execute_pending_commands(sys::state& state) {
 	auto* c = state.incoming_commands.front();
 	bool command_executed = false;
@@ -5127,11 +5286,145 @@ void execute_pending_commands(sys::state& state) {
 	}
 
 	if(command_executed) {
-		province::update_connected_regions(state);
-		province::update_cached_values(state);
-		nations::update_cached_values(state);
-		state.game_state_updated.store(true, std::memory_order::release);
+		if(state.command_log.recording)
+			log_write(state.command_log.pending, log_entry_type::batch_end);
+		update_after_commands(state);
+	}
+}
+
+replay_result replay_command_log(sys::state& state, native_string_view log_name) {
+	replay_result result;
+
+	auto sdir = simple_fs::get_or_create_save_game_directory();
+	auto log_file = simple_fs::open_file(sdir, log_name);
+	if(!log_file)
+		return result;
+	auto contents = simple_fs::view_contents(*log_file);
+	log_reader r{ reinterpret_cast<uint8_t const*>(contents.data), reinterpret_cast<uint8_t const*>(contents.data) + contents.file_size };
+
+	uint32_t magic = 0;
+	uint32_t version = 0;
+	uint32_t payload_size = 0;
+	sys::checksum_key scenario_checksum;
+	uint16_t name_length = 0;
+	if(!r.read(magic) || !r.read(version) || !r.read(payload_size) || !r.read(scenario_checksum) || !r.read(name_length))
+		return result;
+	if(magic != command_log_magic || version != command_log_version || payload_size != uint32_t(sizeof(payload)))
+		return result;
+	if(!state.scenario_checksum.is_equal(scenario_checksum))
+		return result;
+	std::string save_name(name_length, '\0');
+	if(!r.read_bytes(save_name.data(), name_length))
+		return result;
+
+	state.command_log_requested.store(false, std::memory_order::release);
+	state.command_log.recording = false;
+	state.network_mode = sys::network_mode_type::single_player;
+	state.preload();
+	if(!sys::try_read_save_file(state, simple_fs::utf8_to_native(save_name)))
+		return result;
+	// the start save was written mid-session, without compacting the pops; the logged commands and checksums refer to that layout
+	state.command_log.replaying = true;
+	state.fill_unsaved_data();
+	state.command_log.replaying = false;
+	state.mode = sys::game_mode_type::in_game;
+	result.loaded = true;
+
+	log_entry_type type{};
+	while(r.read(type)) {
+		switch(type) {
+		case log_entry_type::command:
+		{
+			sys::date d;
+			payload c;
+			memset(&c, 0, sizeof(payload));
+			uint16_t length = 0;
+			if(!r.read(d.value) || !r.read(c.type) || !r.read(c.source.value) || !r.read(length) || length > sizeof(c.data)
+				|| !r.read_bytes(&c.data, length)) {
+				return result;
+			}
+			if(d != state.current_date && result.checksum_mismatches == 0) {
+				result.first_mismatch = state.current_date;
+				++result.checksum_mismatches;
+			}
+			execute_command(state, c);
+			++result.commands_executed;
+			break;
+		}
+		case log_entry_type::tick:
+		{
+			auto start = std::chrono::steady_clock::now();
+			state.single_game_tick();
+			auto elapsed = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start);
+			result.ticks.push_back(replay_tick{ state.current_date, elapsed.count() });
+			break;
+		}
+		case log_entry_type::checksum:
+		{
+			sys::date d;
+			sys::checksum_key recorded;
+			if(!r.read(d.value) || !r.read(recorded))
+				return result;
+			++result.checksums_checked;
+			if(d != state.current_date || !state.get_save_checksum().is_equal(recorded)) {
+				if(result.checksum_mismatches == 0)
+					result.first_mismatch = state.current_date;
+				++result.checksum_mismatches;
+			}
+			break;
+		}
+		case log_entry_type::batch_end:
+			update_after_commands(state);
+			break;
+		case log_entry_type::end:
+		{
+			sys::date d;
+			if(r.read(d.value) && d == state.current_date)
+				result.completed = true;
+			return result;
+		}
+		default:
+			return result; // unknown entry, the log is damaged
+		}
 	}
+	return result;
+}
+
+void write_replay_report(sys::state& state, native_string_view log_name, replay_result const& result) {
+	std::string out;
+	out += "loaded: " + std::string(result.loaded ? "yes" : "no") + "\n";
+	out += "completed: " + std::string(result.completed ? "yes" : "no") + "\n";
+	out += "commands: " + std::to_string(result.commands_executed) + "\n";
+	out += "checksums: " + std::to_string(result.checksums_checked) + "\n";
+	out += "mismatches: " + std::to_string(result.checksum_mismatches) + "\n";
+	if(result.checksum_mismatches > 0) {
+		auto ymd = result.first_mismatch.to_ymd(state.start_date);
+		out += "first mismatch: " + std::to_string(ymd.year) + "-" + std::to_string(ymd.month) + "-" + std::to_string(ymd.day) + "\n";
+	}
+	if(!result.ticks.empty()) {
+		std::vector<float> sorted;
+		float total = 0.0f;
+		for(auto& t : result.ticks) {
+			sorted.push_back(t.milliseconds);
+			total += t.milliseconds;
+		}
+		std::sort(sorted.begin(), sorted.end());
+		out += "ticks: " + std::to_string(result.ticks.size()) + "\n";
+		out += "total ms: " + std::to_string(total) + "\n";
+		out += "mean ms: " + std::to_string(total / float(sorted.size())) + "\n";
+		out += "median ms: " + std::to_string(sorted[sorted.size() / 2]) + "\n";
+		out += "p95 ms: " + std::to_string(sorted[(sorted.size() * 95) / 100]) + "\n";
+		out += "max ms: " + std::to_string(sorted.back()) + "\n";
+	}
+	out += "\ndate,ms\n";
+	for(auto& t : result.ticks) {
+		auto ymd = t.date.to_ymd(state.start_date);
+		out += std::to_string(ymd.year) + "-" + std::to_string(ymd.month) + "-" + std::to_string(ymd.day) + "," + std::to_string(t.milliseconds) + "\n";
+	}
+
+	auto report_name = native_string(log_name) + NATIVE(".txt");
+	auto sdir = simple_fs::get_or_create_save_game_directory();
+	simple_fs::write_file(sdir, report_name, out.data(), uint32_t(out.size()));
 }
 
 } // namespace command
@@ -815,6 +815,30 @@ void notify_pause_game(sys::state& state, dcon::nation_id source);
 void execute_command(sys::state& state, payload& c);
 void execute_pending_commands(sys::state& state);
 
+// command log: while recording, every command executed on this machine and every tick is appended, together with the date it
+// applied on, to a log next to a save written when the recording started. Replaying the log against that save reproduces the
+// session headlessly, which makes it usable both as a load test and for bisecting desyncs.
+void start_command_log(sys::state& state);
+void stop_command_log(sys::state& state);
+void update_command_log(sys::state& state); // starts or stops recording as requested by state.command_log_requested
+void log_tick(sys::state& state); // called at the start of every tick
+
+struct replay_tick {
+	sys::date date;
+	float milliseconds = 0.0f;
+};
+struct replay_result {
+	std::vector<replay_tick> ticks;
+	uint32_t commands_executed = 0;
+	uint32_t checksums_checked = 0;
+	uint32_t checksum_mismatches = 0;
+	sys::date first_mismatch;
+	bool loaded = false;
+	bool completed = false; // false if the log ended without an end marker, e.g. because the recording game crashed
+};
+replay_result replay_command_log(sys::state& state, native_string_view log_name);
+void write_replay_report(sys::state& state, native_string_view log_name, replay_result const& result);
+
 } // namespace command
 
 #include "cheats.hpp"
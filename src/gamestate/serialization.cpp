@@ -114,6 +114,25 @@ uint8_t* write_compressed_section(uint8_t* ptr_out, uint8_t const* ptr_in, uint3
 	return ptr_out + sizeof(uint32_t) * 2 + section_length;
 }
 
+constexpr inline uint32_t uncompressed_section_marker = 0xFFFFFFFF; // stored in place of the compressed length
+constexpr inline size_t section_page_size = 4096;
+
+// marker, length, padding length, padding, then the data itself starting on a page boundary of the file (and so of its mapping)
+uint8_t* write_uncompressed_section(uint8_t const* file_start, uint8_t* ptr_out, uint8_t const* ptr_in, uint32_t uncompressed_size) {
+	uint32_t marker = uncompressed_section_marker;
+	auto data_offset = size_t(ptr_out - file_start) + sizeof(uint32_t) * 3;
+	uint32_t padding = uint32_t((section_page_size - data_offset % section_page_size) % section_page_size);
+
+	memcpy(ptr_out, &marker, sizeof(uint32_t));
+	memcpy(ptr_out + sizeof(uint32_t), &uncompressed_size, sizeof(uint32_t));
+	memcpy(ptr_out + sizeof(uint32_t) * 2, &padding, sizeof(uint32_t));
+	ptr_out += sizeof(uint32_t) * 3;
+	memset(ptr_out, 0, padding);
+	ptr_out += padding;
+	memcpy(ptr_out, ptr_in, uncompressed_size);
+	return ptr_out + uncompressed_size;
+}
+
 template<typename T>
 uint8_t const* with_decompressed_section(uint8_t const* ptr_in, T const& function) {
 	uint32_t section_length = 0;
@@ -121,6 +140,14 @@ uint8_t const* with_decompressed_section(uint8_t const* ptr_in, T const& functio
 	memcpy(&section_length, ptr_in, sizeof(uint32_t));
 	memcpy(&decompressed_length, ptr_in + sizeof(uint32_t), sizeof(uint32_t));
 
+	if(section_length == uncompressed_section_marker) { // read in place, no decompression buffer
+		uint32_t padding = 0;
+		memcpy(&padding, ptr_in + sizeof(uint32_t) * 2, sizeof(uint32_t));
+		auto data_start = ptr_in + sizeof(uint32_t) * 3 + padding;
+		function(data_start, decompressed_length);
+		return data_start + decompressed_length;
+	}
+
 	uint8_t* temp_buffer = new uint8_t[decompressed_length];
 	// TODO: allocate memory for decompression and decompress into it
 
@@ -288,6 +315,7 @@ uint8_t const* read_scenario_section(uint8_t const* ptr_in, uint8_t const* secti
 	ptr_in = deserialize(ptr_in, state.value_modifier_segments);
 	ptr_in = deserialize(ptr_in, state.value_modifiers);
 	ptr_in = deserialize(ptr_in, state.text_data);
+	state.rebuild_text_terminators();
 	ptr_in = deserialize(ptr_in, state.text_components);
 	ptr_in = deserialize(ptr_in, state.text_sequences);
 	ptr_in = deserialize(ptr_in, state.key_to_text_sequence);
@@ -787,7 +815,7 @@ size_t sizeof_save_section(sys::state& state) {
 	return sz;
 }
 
-void write_scenario_file(sys::state& state, native_string_view name, uint32_t count) {
+void write_scenario_file(sys::state& state, native_string_view name, uint32_t count, scenario_layout layout) {
 	scenario_header header;
 	header.count = count;
 	header.timestamp = uint64_t(std::time(nullptr));
@@ -802,6 +830,8 @@ void write_scenario_file(sys::state& state, native_string_view name, uint32_t co
 	// this is an upper bound, since compacting the data may require less space
 	size_t total_size =
 			sizeof_scenario_header(header) + sizeof_mod_path(simple_fs::extract_state(state.common_fs)) + ZSTD_compressBound(scenario_space) + ZSTD_compressBound(save_space) + sizeof(uint32_t) * 4;
+	if(layout == scenario_layout::mapped)
+		total_size += scenario_space + section_page_size + sizeof(uint32_t);
 
 	uint8_t* temp_buffer = new uint8_t[total_size];
 	uint8_t* buffer_position = temp_buffer;
@@ -818,7 +848,10 @@ void write_scenario_file(sys::state& state, native_string_view name, uint32_t co
 	blake2b(checksum, sizeof(*checksum), temp_scenario_buffer, scenario_space, nullptr, 0);
 	state.scenario_checksum = *checksum;
 
-	buffer_position = write_compressed_section(buffer_position, temp_scenario_buffer, uint32_t(scenario_space));
+	if(layout == scenario_layout::mapped)
+		buffer_position = write_uncompressed_section(temp_buffer, buffer_position, temp_scenario_buffer, uint32_t(scenario_space));
+	else
+		buffer_position = write_compressed_section(buffer_position, temp_scenario_buffer, uint32_t(scenario_space));
 	delete[] temp_scenario_buffer;
 
 	uint8_t* temp_save_buffer = new uint8_t[save_space];
@@ -971,7 +1004,7 @@ std::string make_time_string(uint64_t value) {
 	return result;
 }
 
-void write_save_file(sys::state& state) {
+void write_save_file(sys::state& state, native_string_view name) {
 	save_header header;
 	header.count = state.scenario_counter;
 	header.timestamp = state.scenario_time_stamp;
@@ -997,16 +1030,22 @@ void write_save_file(sys::state& state) {
 
 	auto total_size_used = buffer_position - temp_buffer;
 
-	auto ymd_date = state.current_date.to_ymd(state.start_date);
-	auto base_str = make_time_string(uint64_t(std::time(nullptr))) + "-" + nations::int_to_tag(state.world.national_identity_get_identifying_int(header.tag)) + "-" + std::to_string(ymd_date.year) + "-" + std::to_string(ymd_date.month) + "-" + std::to_string(ymd_date.day) + ".bin";
-
 	auto sdir = simple_fs::get_or_create_save_game_directory();
-	simple_fs::write_file(sdir, simple_fs::utf8_to_native(base_str), reinterpret_cast<char*>(temp_buffer), uint32_t(total_size_used));
+	simple_fs::write_file(sdir, name, reinterpret_cast<char*>(temp_buffer), uint32_t(total_size_used));
 
 	delete[] temp_buffer;
 
 	state.save_list_updated.store(true, std::memory_order::release); // update for ui
 }
+native_string make_save_file_name(sys::state& state) {
+	auto tag = state.world.nation_get_identity_from_identity_holder(state.local_player_nation);
+	auto ymd_date = state.current_date.to_ymd(state.start_date);
+	auto base_str = make_time_string(uint64_t(std::time(nullptr))) + "-" + nations::int_to_tag(state.world.national_identity_get_identifying_int(tag)) + "-" + std::to_string(ymd_date.year) + "-" + std::to_string(ymd_date.month) + "-" + std::to_string(ymd_date.day) + ".bin";
+	return simple_fs::utf8_to_native(base_str);
+}
+void write_save_file(sys::state& state) {
+	write_save_file(state, make_save_file_name(state));
+}
 bool try_read_save_file(sys::state& state, native_string_view name) {
 	auto dir = simple_fs::get_or_create_save_game_directory();
 	auto save_file = open_file(dir, name);
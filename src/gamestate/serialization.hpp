@@ -129,7 +129,7 @@ uint8_t const* deserialize(uint8_t const* ptr_in, ankerl::unordered_dense::map<u
 }
 
 constexpr inline uint32_t save_file_version = 33;
-constexpr inline uint32_t scenario_file_version = 108 + save_file_version;
+constexpr inline uint32_t scenario_file_version = 109 + save_file_version;
 
 struct scenario_header {
 	uint32_t version = scenario_file_version;
@@ -178,12 +178,19 @@ uint8_t* write_save_section(uint8_t* ptr_in, sys::state& state);
 size_t sizeof_scenario_section(sys::state& state);
 size_t sizeof_save_section(sys::state& state);
 
-void write_scenario_file(sys::state& state, native_string_view name, uint32_t count);
+enum class scenario_layout : uint8_t {
+	compressed, // zstd compressed, the smallest file
+	mapped, // scenario section stored uncompressed and page aligned, so that it is read straight from the memory-mapped file
+};
+
+void write_scenario_file(sys::state& state, native_string_view name, uint32_t count, scenario_layout layout = scenario_layout::compressed);
 bool try_read_scenario_file(sys::state& state, native_string_view name);
 bool try_read_scenario_and_save_file(sys::state& state, native_string_view name);
 bool try_read_scenario_as_save_file(sys::state& state, native_string_view name);
 
 void write_save_file(sys::state& state);
+void write_save_file(sys::state& state, native_string_view name);
+native_string make_save_file_name(sys::state& state); // the name write_save_file(state) would use right now
 bool try_read_save_file(sys::state& state, native_string_view name);
 
 } // namespace sys
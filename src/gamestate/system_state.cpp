@@ -6,6 +6,7 @@
 #include "gui_element_base.hpp"
 #include <algorithm>
 #include <functional>
+#include <bit>
 #include "parsers_declarations.hpp"
 #include "gui_console.hpp"
 #include "gui_minimap.hpp"
@@ -83,6 +84,7 @@ void state::state_select(dcon::state_definition_id sdef) {
 void state::on_rbutton_down(int32_t x, int32_t y, key_modifiers mod) {
 	// Lose focus on text
 	ui_state.edit_target = nullptr;
+	++ui_state.content_generation;
 
 	auto belongs_on_map = [&](ui::element_base* b) {
 		while(b != nullptr) {
@@ -156,12 +158,14 @@ void state::on_rbutton_down(int32_t x, int32_t y, key_modifiers mod) {
 void state::on_mbutton_down(int32_t x, int32_t y, key_modifiers mod) {
 	// Lose focus on text
 	ui_state.edit_target = nullptr;
+	++ui_state.content_generation;
 
 	map_state.on_mbuttom_down(x, y, x_size, y_size, mod);
 }
 void state::on_lbutton_down(int32_t x, int32_t y, key_modifiers mod) {
 	// Lose focus on text
 	ui_state.edit_target = nullptr;
+	++ui_state.content_generation;
 
 	if(ui_state.under_mouse != nullptr) {
 		ui_state.under_mouse->impl_on_lbutton_down(*this, ui_state.relative_mouse_location.x,
@@ -207,6 +211,7 @@ void state::on_mbutton_up(int32_t x, int32_t y, key_modifiers mod) {
 	map_state.on_mbuttom_up(x, y, mod);
 }
 void state::on_lbutton_up(int32_t x, int32_t y, key_modifiers mod) {
+	++ui_state.content_generation;
 	is_dragging = false;
 	if(ui_state.drag_target) {
 		on_drag_finished(x, y, mod);
@@ -358,6 +363,7 @@ void state::on_resize(int32_t x, int32_t y, window::window_state win_state) {
 	}
 }
 void state::on_mouse_wheel(int32_t x, int32_t y, key_modifiers mod, float amount) { // an amount of 1.0 is one "click" of the wheel
+	++ui_state.content_generation;
 
 	auto belongs_on_map = [&](ui::element_base* b) {
 		while(b != nullptr) {
@@ -381,6 +387,7 @@ void state::on_mouse_wheel(int32_t x, int32_t y, key_modifiers mod, float amount
 	}
 }
 void state::on_key_down(virtual_key keycode, key_modifiers mod) {
+	++ui_state.content_generation;
 	if(keycode == virtual_key::CONTROL)
 		ui_state.ctrl_held_down = true;
 
@@ -452,15 +459,69 @@ void state::on_key_up(virtual_key keycode, key_modifiers mod) {
 	map_state.on_key_up(keycode, mod);
 }
 void state::on_text(char c) { // c is win1250 codepage value
+	++ui_state.content_generation;
 	if(ui_state.edit_target)
 		ui_state.edit_target->on_text(*this, c);
 }
 
 inline constexpr int32_t tooltip_width = 400;
+// position sensitive tooltips are cached per square of this many pixels rather than per pixel
+inline constexpr int32_t tooltip_position_bucket = 4;
+
+struct tooltip_extent {
+	int32_t used_width = 0;
+	int32_t used_height = 0;
+};
+
+/*
+Lays out a tooltip with fill into ui_state.tooltip, or copies it from tooltip_cache when it was laid out for the same
+source and position with no tick, command, player change, game update or input since.
+*/
+template<typename F>
+tooltip_extent lay_out_tooltip(sys::state& state, void const* source, int32_t x, int32_t y, int16_t max_height, int32_t column_width, F&& fill) {
+	text::layout_cache_key key{ source, x, y, max_height, state.ui_state.content_generation,
+		state.command_generation.load(std::memory_order::acquire), state.current_date.value, state.local_player_nation };
+	if(auto* e = state.tooltip_cache.find(key); e) {
+		state.ui_state.tooltip->internal_layout = e->contents;
+		return tooltip_extent{ e->used_width, e->used_height };
+	}
+	auto container = text::create_columnar_layout(state.ui_state.tooltip->internal_layout,
+			text::layout_parameters{ 16, 16, tooltip_width, max_height, state.ui_state.tooltip_font, 0, text::alignment::left,
+					text::text_color::white, true },
+			column_width);
+	fill(container);
+	auto& e = state.tooltip_cache.replace(key);
+	e.contents = state.ui_state.tooltip->internal_layout;
+	e.used_width = container.used_width;
+	e.used_height = container.used_height;
+	return tooltip_extent{ container.used_width, container.used_height };
+}
+
+void show_element_tooltip(sys::state& state, ui::element_base* source, ui::xy_pair relative_location, int16_t max_height) {
+	// only position sensitive tooltips depend on where in the element the mouse is
+	bool position_sensitive = source->has_tooltip(state) == ui::tooltip_behavior::position_sensitive_tooltip;
+	auto bucket_x = position_sensitive ? int32_t(relative_location.x) / tooltip_position_bucket : 0;
+	auto bucket_y = position_sensitive ? int32_t(relative_location.y) / tooltip_position_bucket : 0;
+	// the layout is shared by the whole square, so it is made for the square's corner rather than for the exact mouse position
+	int32_t tooltip_x = position_sensitive ? bucket_x * tooltip_position_bucket : relative_location.x;
+	int32_t tooltip_y = position_sensitive ? bucket_y * tooltip_position_bucket : relative_location.y;
+	auto extent = lay_out_tooltip(state, source, bucket_x, bucket_y, max_height, 10, [&](text::columnar_layout& container) {
+				source->update_tooltip(state, tooltip_x, tooltip_y, container);
+			});
+	state.ui_state.tooltip->base_data.size.x = int16_t(extent.used_width + 16);
+	state.ui_state.tooltip->base_data.size.y = int16_t(extent.used_height + 16);
+	if(extent.used_width > 0)
+		state.ui_state.tooltip->set_visible(state, true);
+	else
+		state.ui_state.tooltip->set_visible(state, false);
+}
 
 void state::render() { // called to render the frame may (and should) delay returning until the frame is rendered, including
 	// waiting for vsync
 	auto game_state_was_updated = game_state_updated.exchange(false, std::memory_order::acq_rel);
+	if(game_state_was_updated)
+		++ui_state.content_generation;
+	snapshot::acquire(*this);
 	auto ownership_update = province_ownership_changed.exchange(false, std::memory_order::acq_rel);
 	if(ownership_update) {
 		if(user_settings.map_label != sys::map_label_mode::none)
@@ -469,6 +530,7 @@ void state::render() { // called to render the frame may (and should) delay retu
 	if(game_state_was_updated) {
 		map_state.map_data.update_fog_of_war(*this);
 	}
+	open_gl.loader.upload_decoded(*this);
 
 	if(mode == sys::game_mode_type::end_screen) { // END SCREEN RENDERING
 		ui_state.end_screen->base_data.size.x = ui_state.root->base_data.size.x;
@@ -486,19 +548,7 @@ void state::render() { // called to render the frame may (and should) delay retu
 			if(ui_state.last_tooltip && ui_state.tooltip->is_visible()) {
 				auto type = ui_state.last_tooltip->has_tooltip(*this);
 				if(type == ui::tooltip_behavior::variable_tooltip || type == ui::tooltip_behavior::position_sensitive_tooltip) {
-					auto container = text::create_columnar_layout(ui_state.tooltip->internal_layout,
-							text::layout_parameters{ 16, 16, tooltip_width, int16_t(ui_state.end_screen->base_data.size.y - 20), ui_state.tooltip_font, 0,
-									text::alignment::left,
-									text::text_color::white, true },
-							 10);
-					ui_state.last_tooltip->update_tooltip(*this, tooltip_probe.relative_location.x, tooltip_probe.relative_location.y,
-							container);
-					ui_state.tooltip->base_data.size.x = int16_t(container.used_width + 16);
-					ui_state.tooltip->base_data.size.y = int16_t(container.used_height + 16);
-					if(container.used_width > 0)
-						ui_state.tooltip->set_visible(*this, true);
-					else
-						ui_state.tooltip->set_visible(*this, false);
+					show_element_tooltip(*this, ui_state.last_tooltip, tooltip_probe.relative_location, int16_t(ui_state.end_screen->base_data.size.y - 20));
 				}
 			}
 		}
@@ -511,19 +561,7 @@ void state::render() { // called to render the frame may (and should) delay retu
 				auto type = ui_state.last_tooltip->has_tooltip(*this);
 				if(type != ui::tooltip_behavior::no_tooltip) {
 
-					auto container = text::create_columnar_layout(ui_state.tooltip->internal_layout,
-							text::layout_parameters{ 16, 16, tooltip_width,int16_t(ui_state.end_screen->base_data.size.y - 20), ui_state.tooltip_font, 0,
-									text::alignment::left,
-									text::text_color::white, true },
-							 10);
-					ui_state.last_tooltip->update_tooltip(*this, tooltip_probe.relative_location.x, tooltip_probe.relative_location.y,
-							container);
-					ui_state.tooltip->base_data.size.x = int16_t(container.used_width + 16);
-					ui_state.tooltip->base_data.size.y = int16_t(container.used_height + 16);
-					if(container.used_width > 0)
-						ui_state.tooltip->set_visible(*this, true);
-					else
-						ui_state.tooltip->set_visible(*this, false);
+					show_element_tooltip(*this, ui_state.last_tooltip, tooltip_probe.relative_location, int16_t(ui_state.end_screen->base_data.size.y - 20));
 				} else {
 					ui_state.tooltip->set_visible(*this, false);
 				}
@@ -532,18 +570,7 @@ void state::render() { // called to render the frame may (and should) delay retu
 			}
 		} else if(ui_state.last_tooltip &&
 							ui_state.last_tooltip->has_tooltip(*this) == ui::tooltip_behavior::position_sensitive_tooltip) {
-			auto container = text::create_columnar_layout(ui_state.tooltip->internal_layout,
-					text::layout_parameters{ 16, 16, tooltip_width, int16_t(ui_state.end_screen->base_data.size.y - 20), ui_state.tooltip_font, 0,
-							text::alignment::left,
-							text::text_color::white, true },
-					 10);
-			ui_state.last_tooltip->update_tooltip(*this, tooltip_probe.relative_location.x, tooltip_probe.relative_location.y, container);
-			ui_state.tooltip->base_data.size.x = int16_t(container.used_width + 16);
-			ui_state.tooltip->base_data.size.y = int16_t(container.used_height + 16);
-			if(container.used_width > 0)
-				ui_state.tooltip->set_visible(*this, true);
-			else
-				ui_state.tooltip->set_visible(*this, false);
+			show_element_tooltip(*this, ui_state.last_tooltip, tooltip_probe.relative_location, int16_t(ui_state.end_screen->base_data.size.y - 20));
 		}
 
 		if(ui_state.last_tooltip && ui_state.tooltip->is_visible()) {
@@ -631,19 +658,7 @@ void state::render() { // called to render the frame may (and should) delay retu
 			if(ui_state.last_tooltip && ui_state.tooltip->is_visible()) {
 				auto type = ui_state.last_tooltip->has_tooltip(*this);
 				if(type == ui::tooltip_behavior::variable_tooltip || type == ui::tooltip_behavior::position_sensitive_tooltip) {
-					auto container = text::create_columnar_layout(ui_state.tooltip->internal_layout,
-							text::layout_parameters{ 16, 16, tooltip_width, int16_t(ui_state.nation_picker->base_data.size.y - 20), ui_state.tooltip_font, 0,
-									text::alignment::left,
-									text::text_color::white, true },
-							 10);
-					ui_state.last_tooltip->update_tooltip(*this, tooltip_probe.relative_location.x, tooltip_probe.relative_location.y,
-							container);
-					ui_state.tooltip->base_data.size.x = int16_t(container.used_width + 16);
-					ui_state.tooltip->base_data.size.y = int16_t(container.used_height + 16);
-					if(container.used_width > 0)
-						ui_state.tooltip->set_visible(*this, true);
-					else
-						ui_state.tooltip->set_visible(*this, false);
+					show_element_tooltip(*this, ui_state.last_tooltip, tooltip_probe.relative_location, int16_t(ui_state.nation_picker->base_data.size.y - 20));
 				}
 			}
 		}
@@ -656,19 +671,7 @@ void state::render() { // called to render the frame may (and should) delay retu
 				auto type = ui_state.last_tooltip->has_tooltip(*this);
 				if(type != ui::tooltip_behavior::no_tooltip) {
 
-					auto container = text::create_columnar_layout(ui_state.tooltip->internal_layout,
-							text::layout_parameters{ 16, 16, tooltip_width,int16_t(ui_state.nation_picker->base_data.size.y - 20), ui_state.tooltip_font, 0,
-									text::alignment::left,
-									text::text_color::white, true },
-							 10);
-					ui_state.last_tooltip->update_tooltip(*this, tooltip_probe.relative_location.x, tooltip_probe.relative_location.y,
-							container);
-					ui_state.tooltip->base_data.size.x = int16_t(container.used_width + 16);
-					ui_state.tooltip->base_data.size.y = int16_t(container.used_height + 16);
-					if(container.used_width > 0)
-						ui_state.tooltip->set_visible(*this, true);
-					else
-						ui_state.tooltip->set_visible(*this, false);
+					show_element_tooltip(*this, ui_state.last_tooltip, tooltip_probe.relative_location, int16_t(ui_state.nation_picker->base_data.size.y - 20));
 				} else {
 					ui_state.tooltip->set_visible(*this, false);
 				}
@@ -677,18 +680,7 @@ void state::render() { // called to render the frame may (and should) delay retu
 			}
 		} else if(ui_state.last_tooltip &&
 							ui_state.last_tooltip->has_tooltip(*this) == ui::tooltip_behavior::position_sensitive_tooltip) {
-			auto container = text::create_columnar_layout(ui_state.tooltip->internal_layout,
-					text::layout_parameters{ 16, 16, tooltip_width, int16_t(ui_state.nation_picker->base_data.size.y - 20), ui_state.tooltip_font, 0,
-							text::alignment::left,
-							text::text_color::white, true },
-					 10);
-			ui_state.last_tooltip->update_tooltip(*this, tooltip_probe.relative_location.x, tooltip_probe.relative_location.y, container);
-			ui_state.tooltip->base_data.size.x = int16_t(container.used_width + 16);
-			ui_state.tooltip->base_data.size.y = int16_t(container.used_height + 16);
-			if(container.used_width > 0)
-				ui_state.tooltip->set_visible(*this, true);
-			else
-				ui_state.tooltip->set_visible(*this, false);
+			show_element_tooltip(*this, ui_state.last_tooltip, tooltip_probe.relative_location, int16_t(ui_state.nation_picker->base_data.size.y - 20));
 		}
 
 		if(ui_state.last_tooltip && ui_state.tooltip->is_visible()) {
@@ -795,19 +787,7 @@ void state::render() { // called to render the frame may (and should) delay retu
 			if(ui_state.last_tooltip && ui_state.tooltip->is_visible()) {
 				auto type = ui_state.last_tooltip->has_tooltip(*this);
 				if(type == ui::tooltip_behavior::variable_tooltip || type == ui::tooltip_behavior::position_sensitive_tooltip) {
-					auto container = text::create_columnar_layout(ui_state.tooltip->internal_layout,
-							text::layout_parameters{ 16, 16, tooltip_width, int16_t(ui_state.select_states_legend->base_data.size.y - 20), ui_state.tooltip_font, 0,
-									text::alignment::left,
-									text::text_color::white, true },
-							 10);
-					ui_state.last_tooltip->update_tooltip(*this, tooltip_probe.relative_location.x, tooltip_probe.relative_location.y,
-							container);
-					ui_state.tooltip->base_data.size.x = int16_t(container.used_width + 16);
-					ui_state.tooltip->base_data.size.y = int16_t(container.used_height + 16);
-					if(container.used_width > 0)
-						ui_state.tooltip->set_visible(*this, true);
-					else
-						ui_state.tooltip->set_visible(*this, false);
+					show_element_tooltip(*this, ui_state.last_tooltip, tooltip_probe.relative_location, int16_t(ui_state.select_states_legend->base_data.size.y - 20));
 				}
 			}
 		}
@@ -820,19 +800,7 @@ void state::render() { // called to render the frame may (and should) delay retu
 				auto type = ui_state.last_tooltip->has_tooltip(*this);
 				if(type != ui::tooltip_behavior::no_tooltip) {
 
-					auto container = text::create_columnar_layout(ui_state.tooltip->internal_layout,
-							text::layout_parameters{ 16, 16, tooltip_width,int16_t(ui_state.select_states_legend->base_data.size.y - 20), ui_state.tooltip_font, 0,
-									text::alignment::left,
-									text::text_color::white, true },
-							 10);
-					ui_state.last_tooltip->update_tooltip(*this, tooltip_probe.relative_location.x, tooltip_probe.relative_location.y,
-							container);
-					ui_state.tooltip->base_data.size.x = int16_t(container.used_width + 16);
-					ui_state.tooltip->base_data.size.y = int16_t(container.used_height + 16);
-					if(container.used_width > 0)
-						ui_state.tooltip->set_visible(*this, true);
-					else
-						ui_state.tooltip->set_visible(*this, false);
+					show_element_tooltip(*this, ui_state.last_tooltip, tooltip_probe.relative_location, int16_t(ui_state.select_states_legend->base_data.size.y - 20));
 				} else {
 					ui_state.tooltip->set_visible(*this, false);
 				}
@@ -841,18 +809,7 @@ void state::render() { // called to render the frame may (and should) delay retu
 			}
 		} else if(ui_state.last_tooltip &&
 							ui_state.last_tooltip->has_tooltip(*this) == ui::tooltip_behavior::position_sensitive_tooltip) {
-			auto container = text::create_columnar_layout(ui_state.tooltip->internal_layout,
-					text::layout_parameters{ 16, 16, tooltip_width, int16_t(ui_state.select_states_legend->base_data.size.y - 20), ui_state.tooltip_font, 0,
-							text::alignment::left,
-							text::text_color::white, true },
-					 10);
-			ui_state.last_tooltip->update_tooltip(*this, tooltip_probe.relative_location.x, tooltip_probe.relative_location.y, container);
-			ui_state.tooltip->base_data.size.x = int16_t(container.used_width + 16);
-			ui_state.tooltip->base_data.size.y = int16_t(container.used_height + 16);
-			if(container.used_width > 0)
-				ui_state.tooltip->set_visible(*this, true);
-			else
-				ui_state.tooltip->set_visible(*this, false);
+			show_element_tooltip(*this, ui_state.last_tooltip, tooltip_probe.relative_location, int16_t(ui_state.select_states_legend->base_data.size.y - 20));
 		}
 
 		if(ui_state.last_tooltip && ui_state.tooltip->is_visible()) {
@@ -1306,19 +1263,7 @@ void state::render() { // called to render the frame may (and should) delay retu
 		if(ui_state.last_tooltip && ui_state.tooltip->is_visible()) {
 			auto type = ui_state.last_tooltip->has_tooltip(*this);
 			if(type == ui::tooltip_behavior::variable_tooltip || type == ui::tooltip_behavior::position_sensitive_tooltip) {
-				auto container = text::create_columnar_layout(ui_state.tooltip->internal_layout,
-						text::layout_parameters{ 16, 16, tooltip_width, int16_t(ui_state.root->base_data.size.y - 20), ui_state.tooltip_font, 0,
-								text::alignment::left,
-								text::text_color::white, true },
-						 10);
-				ui_state.last_tooltip->update_tooltip(*this, tooltip_probe.relative_location.x, tooltip_probe.relative_location.y,
-						container);
-				ui_state.tooltip->base_data.size.x = int16_t(container.used_width + 16);
-				ui_state.tooltip->base_data.size.y = int16_t(container.used_height + 16);
-				if(container.used_width > 0)
-					ui_state.tooltip->set_visible(*this, true);
-				else
-					ui_state.tooltip->set_visible(*this, false);
+				show_element_tooltip(*this, ui_state.last_tooltip, tooltip_probe.relative_location, int16_t(ui_state.root->base_data.size.y - 20));
 			}
 		}
 	}
@@ -1329,19 +1274,7 @@ void state::render() { // called to render the frame may (and should) delay retu
 			auto type = ui_state.last_tooltip->has_tooltip(*this);
 			if(type != ui::tooltip_behavior::no_tooltip) {
 
-				auto container = text::create_columnar_layout(ui_state.tooltip->internal_layout,
-						text::layout_parameters{ 16, 16, tooltip_width,int16_t(ui_state.root->base_data.size.y - 20), ui_state.tooltip_font, 0,
-								text::alignment::left,
-								text::text_color::white, true },
-						 10);
-				ui_state.last_tooltip->update_tooltip(*this, tooltip_probe.relative_location.x, tooltip_probe.relative_location.y,
-						container);
-				ui_state.tooltip->base_data.size.x = int16_t(container.used_width + 16);
-				ui_state.tooltip->base_data.size.y = int16_t(container.used_height + 16);
-				if(container.used_width > 0)
-					ui_state.tooltip->set_visible(*this, true);
-				else
-					ui_state.tooltip->set_visible(*this, false);
+				show_element_tooltip(*this, ui_state.last_tooltip, tooltip_probe.relative_location, int16_t(ui_state.root->base_data.size.y - 20));
 			} else {
 				ui_state.tooltip->set_visible(*this, false);
 			}
@@ -1349,18 +1282,7 @@ void state::render() { // called to render the frame may (and should) delay retu
 			ui_state.tooltip->set_visible(*this, false);
 		}
 	} else if(ui_state.last_tooltip && ui_state.last_tooltip->has_tooltip(*this) == ui::tooltip_behavior::position_sensitive_tooltip) {
-		auto container = text::create_columnar_layout(ui_state.tooltip->internal_layout,
-				text::layout_parameters{ 16, 16, tooltip_width, int16_t(ui_state.root->base_data.size.y - 20), ui_state.tooltip_font, 0,
-						text::alignment::left,
-						text::text_color::white, true },
-				 10);
-		ui_state.last_tooltip->update_tooltip(*this, tooltip_probe.relative_location.x, tooltip_probe.relative_location.y, container);
-		ui_state.tooltip->base_data.size.x = int16_t(container.used_width + 16);
-		ui_state.tooltip->base_data.size.y = int16_t(container.used_height + 16);
-		if(container.used_width > 0)
-			ui_state.tooltip->set_visible(*this, true);
-		else
-			ui_state.tooltip->set_visible(*this, false);
+		show_element_tooltip(*this, ui_state.last_tooltip, tooltip_probe.relative_location, int16_t(ui_state.root->base_data.size.y - 20));
 	}
 
 
@@ -1410,17 +1332,15 @@ void state::render() { // called to render the frame may (and should) delay retu
 			prov = dcon::province_id{};
 
 		if(prov) {
-			auto container = text::create_columnar_layout(ui_state.tooltip->internal_layout,
-					text::layout_parameters{ 16, 16, tooltip_width, int16_t(ui_state.root->base_data.size.y - 20), ui_state.tooltip_font, 0, text::alignment::left, text::text_color::white, true },
-					20);
+			// the map tooltip is cached under the map state, with the province and map mode as its position
+			auto container = lay_out_tooltip(*this, &map_state, int32_t(prov.index()), int32_t(map_state.active_map_mode),
+					int16_t(ui_state.root->base_data.size.y - 20), 20, [&](text::columnar_layout& c) { ui::populate_map_tooltip(*this, c, prov); });
 
 			// Enable this and tooltip will follow the cursor
 			// ui_state.tooltip->base_data.position.x = int16_t(mouse_x_position / user_settings.ui_scale);
 			// ui_state.tooltip->base_data.position.y = int16_t(mouse_y_position / user_settings.ui_scale);
 
 
-			ui::populate_map_tooltip(*this, container, prov);
-
 			ui_state.tooltip->base_data.size.x = int16_t(container.used_width + 16);
 			ui_state.tooltip->base_data.size.y = int16_t(container.used_height + 16);
 			if(container.used_width > 0) {
@@ -1819,16 +1739,15 @@ void state::on_create() {
 //
 
 std::string_view state::to_string_view(dcon::text_key tag) const {
-	if(!tag)
-		return std::string_view();
-	auto start_position = text_data.data() + tag.index();
-	auto data_size = text_data.size();
-	auto end_position = start_position;
-	for(; end_position < text_data.data() + data_size; ++end_position) {
-		if(*end_position == 0)
-			break;
+	return text::pool_string_view(text_data, text_terminators, tag);
+}
+
+void state::rebuild_text_terminators() {
+	text_terminators.assign((text_data.size() + 63) / 64, 0);
+	for(size_t i = 0; i < text_data.size(); ++i) {
+		if(text_data[i] == 0)
+			text_terminators[i / 64] |= uint64_t(1) << (i % 64);
 	}
-	return std::string_view(text_data.data() + tag.index(), size_t(end_position - start_position));
 }
 
 dcon::text_key state::add_to_pool_lowercase(std::string const& new_text) {
@@ -1852,6 +1771,8 @@ dcon::text_key state::add_to_pool(std::string const& new_text) {
 		return dcon::text_key();
 	text_data.resize(start + size + 1, char(0));
 	std::copy_n(new_text.c_str(), size + 1, text_data.data() + start);
+	text_terminators.resize((text_data.size() + 63) / 64, 0);
+	text_terminators[(start + size) / 64] |= uint64_t(1) << ((start + size) % 64);
 	return dcon::text_key(uint32_t(start));
 }
 dcon::text_key state::add_to_pool(std::string_view new_text) {
@@ -1862,15 +1783,16 @@ dcon::text_key state::add_to_pool(std::string_view new_text) {
 	text_data.resize(start + length + 1, char(0));
 	std::copy_n(new_text.data(), length, text_data.data() + start);
 	text_data.back() = 0;
+	text_terminators.resize((text_data.size() + 63) / 64, 0);
+	text_terminators[(start + length) / 64] |= uint64_t(1) << ((start + length) % 64);
 	return dcon::text_key(uint32_t(start));
 }
 
 dcon::text_key state::add_unique_to_pool(std::string const& new_text) {
 	if(new_text.length() > 0) {
-		auto search_result = std::search(text_data.data(), text_data.data() + text_data.size(),
-				std::boyer_moore_horspool_searcher(new_text.c_str(), new_text.c_str() + new_text.length() + 1));
-		if(search_result != text_data.data() + text_data.size()) {
-			return dcon::text_key(uint32_t(search_result - text_data.data()));
+		auto search_result = text_data_search.find(text_data, new_text.c_str(), uint32_t(new_text.length() + 1));
+		if(search_result >= 0) {
+			return dcon::text_key(uint32_t(search_result));
 		} else {
 			return add_to_pool(new_text);
 		}
@@ -1894,14 +1816,12 @@ dcon::unit_name_id state::add_unit_name(std::string_view text) {
 std::string_view state::to_string_view(dcon::unit_name_id tag) const {
 	if(!tag)
 		return std::string_view();
-	auto start_position = unit_names.data() + unit_names_indices[tag.index()];
-	auto data_size = unit_names.size();
-	auto end_position = start_position;
-	for(; end_position < unit_names.data() + data_size; ++end_position) {
-		if(*end_position == 0)
-			break;
-	}
-	return std::string_view(unit_names.data() + unit_names_indices[tag.index()], size_t(end_position - start_position));
+	// names are stored one after the other, each followed by a zero, so the next name's start marks the end of this one
+	auto start = size_t(unit_names_indices[tag.index()]);
+	auto next = size_t(tag.index()) + 1 < unit_names_indices.size() ? size_t(unit_names_indices[tag.index() + 1]) : unit_names.size();
+	if(next <= start)
+		return std::string_view();
+	return std::string_view(unit_names.data() + start, next - start - 1);
 }
 
 dcon::trigger_key state::commit_trigger_data(std::vector<uint16_t> data) {
@@ -1914,13 +1834,10 @@ dcon::trigger_key state::commit_trigger_data(std::vector<uint16_t> data) {
 		return dcon::trigger_key();
 	}
 
-	auto search_result = std::search(trigger_data.data() + 1, trigger_data.data() + trigger_data.size(),
-			std::boyer_moore_horspool_searcher(data.data(), data.data() + data.size()));
-	if(search_result != trigger_data.data() + trigger_data.size()) {
-		auto const start = search_result - trigger_data.data();
-		auto it = std::find(trigger_data_indices.begin(), trigger_data_indices.end(), int32_t(start));
-		if(it != trigger_data_indices.end()) {
-			auto d = std::distance(trigger_data_indices.begin(), it);
+	auto const start = trigger_data_search.find(trigger_data, data.data(), uint32_t(data.size()));
+	if(start >= 0) {
+		auto d = trigger_key_search.find(trigger_data_indices, start);
+		if(d >= 0) {
 			return dcon::trigger_key(dcon::trigger_key::value_base_t(d - 1));
 		} else {
 			trigger_data_indices.push_back(int32_t(start));
@@ -1948,13 +1865,10 @@ dcon::effect_key state::commit_effect_data(std::vector<uint16_t> data) {
 		return dcon::effect_key();
 	}
 
-	auto search_result = std::search(effect_data.data() + 1, effect_data.data() + effect_data.size(),
-			std::boyer_moore_horspool_searcher(data.data(), data.data() + data.size()));
-	if(search_result != effect_data.data() + effect_data.size()) {
-		auto const start = search_result - effect_data.data();
-		auto it = std::find(effect_data_indices.begin(), effect_data_indices.end(), int32_t(start));
-		if(it != effect_data_indices.end()) {
-			auto d = std::distance(effect_data_indices.begin(), it);
+	auto const start = effect_data_search.find(effect_data, data.data(), uint32_t(data.size()));
+	if(start >= 0) {
+		auto d = effect_key_search.find(effect_data_indices, start);
+		if(d >= 0) {
 			return dcon::effect_key(dcon::effect_key::value_base_t(d - 1));
 		} else {
 			effect_data_indices.push_back(int32_t(start));
@@ -2011,6 +1925,8 @@ void state::save_user_settings() const {
 	US_SAVE(antialias_level);
 	US_SAVE(gaussianblur_level);
 	US_SAVE(gamma);
+	US_SAVE(ui_snapshot_nation_fields);
+	US_SAVE(ui_snapshot_province_fields);
 #undef US_SAVE
 
 	simple_fs::write_file(settings_location, NATIVE("user_settings.dat"), &buffer[0], uint32_t(ptr - buffer));
@@ -2062,6 +1978,8 @@ void state::load_user_settings() {
 			US_LOAD(antialias_level);
 			US_LOAD(gaussianblur_level);
 			US_LOAD(gamma);
+			US_LOAD(ui_snapshot_nation_fields);
+			US_LOAD(ui_snapshot_province_fields);
 #undef US_LOAD
 		} while(false);
 
@@ -2074,7 +1992,11 @@ void state::load_user_settings() {
 		user_settings.gaussianblur_level = std::clamp(user_settings.gaussianblur_level, 1.0f, 1.25f);
 		user_settings.gaussianblur_level = std::clamp(user_settings.gaussianblur_level, 1.0f, 1.5f);
 		user_settings.gamma = std::clamp(user_settings.gamma, 0.5f, 2.5f);
+		user_settings.ui_snapshot_nation_fields &= snapshot::default_nation_fields;
+		user_settings.ui_snapshot_province_fields &= snapshot::default_province_fields;
 	}
+	ui_snapshot.nation_fields.store(user_settings.ui_snapshot_nation_fields, std::memory_order::release);
+	ui_snapshot.province_fields.store(user_settings.ui_snapshot_province_fields, std::memory_order::release);
 }
 
 void state::update_ui_scale(float new_scale) {
@@ -3381,10 +3303,23 @@ void state::load_scenario_data(parsers::error_handler& err) {
 	military::recover_org(*this);
 
 	military::set_initial_leaders(*this);
+
+	// the interning indices are only needed while the scripts are parsed
+	trigger_data_search.release();
+	trigger_key_search.release();
+	effect_data_search.release();
+	effect_key_search.release();
+	text_data_search.release();
 }
 
 void state::preload() {
 	adjacency_data_out_of_date = true;
+	search::invalidate(*this);
+	snapshot::invalidate(*this);
+	tooltip_cache.clear();
+	font_collection.run_cache.clear(); // extents of text containing flag tags depend on the nations that exist
+	nations_with_stale_cached_values.clear();
+	nations_with_stale_diplomatic_values.clear();
 	for(auto si : world.in_state_instance) {
 		si.set_naval_base_is_taken(false);
 		si.set_capital(dcon::province_id{});
@@ -3427,7 +3362,49 @@ void state::preload() {
 	}
 }
 
+void run_reconstruction_tasks(std::vector<reconstruction_task> const& tasks, bool serial, std::vector<load_timing>& timings) {
+	std::vector<uint8_t> finished(tasks.size(), uint8_t(0));
+	std::vector<uint32_t> ready;
+	std::vector<float> milliseconds(tasks.size(), 0.0f);
+
+	auto run = [&](uint32_t i) {
+		auto start = std::chrono::steady_clock::now();
+		tasks[i].run();
+		milliseconds[i] = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+	};
+
+	if(serial) { // the reference order: every dependency comes before the task that needs it
+		for(uint32_t i = 0; i < uint32_t(tasks.size()); ++i)
+			run(i);
+	}
+	while(!serial) {
+		ready.clear();
+		for(uint32_t i = 0; i < uint32_t(tasks.size()); ++i) {
+			if(finished[i])
+				continue;
+			bool can_run = true;
+			for(auto d : tasks[i].depends_on) {
+				assert(d < i);
+				can_run = can_run && finished[d];
+			}
+			if(can_run)
+				ready.push_back(i);
+		}
+		if(ready.empty())
+			break;
+		concurrency::parallel_for(uint32_t(0), uint32_t(ready.size()), [&](uint32_t j) { run(ready[j]); });
+		for(auto i : ready)
+			finished[i] = 1;
+	}
+
+	for(uint32_t i = 0; i < uint32_t(tasks.size()); ++i)
+		timings.push_back(load_timing{ tasks[i].name, milliseconds[i] });
+}
+
 void state::fill_unsaved_data() { // reconstructs derived values that are not directly saved after a save has been loaded
+	auto load_start = std::chrono::steady_clock::now();
+	load_timings.clear();
+
 	great_nations.reserve(int32_t(defines.great_nations_count));
 
 	world.nation_resize_modifier_values(sys::national_mod_offsets::count);
@@ -3449,6 +3426,12 @@ void state::fill_unsaved_data() { // reconstructs derived values that are not di
 	world.province_resize_demographics(demographics::size(*this));
 
 	province::restore_distances(*this);
+	province::rebuild_adjacency_graph(*this);
+
+	// in multiplayer a joining client must keep the exact pop ids of the host, and a replayed command log those of the game
+	// that recorded it, so only reorder here in single player
+	if(network_mode == sys::network_mode_type::single_player && !command_log.replaying)
+		demographics::compact_pops_by_location(*this);
 
 	world.for_each_nation([&](dcon::nation_id id) { politics::update_displayed_identity(*this, id); });
 
@@ -3488,39 +3471,57 @@ void state::fill_unsaved_data() { // reconstructs derived values that are not di
 		world.issue_set_issue_type(i, uint8_t(culture::issue_type::political));
 	}
 
-	military::reset_unit_stats(*this);
-	culture::clear_existing_tech_effects(*this);
-	culture::repopulate_technology_effects(*this);
-	culture::repopulate_invention_effects(*this);
-	military::apply_base_unit_stat_modifiers(*this);
+	load_timings.push_back(load_timing{ "setup", std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - load_start).count() });
 
-	province::update_connected_regions(*this);
-	province::restore_unsaved_values(*this);
-
-	culture::update_all_nations_issue_rules(*this);
-	culture::restore_unsaved_values(*this);
-	nations::restore_state_instances(*this);
-	demographics::regenerate_from_pop_data(*this);
-
-	sys::repopulate_modifier_effects(*this);
-	military::restore_unsaved_values(*this);
-	nations::restore_unsaved_values(*this);
-
-	pop_demographics::regenerate_is_primary_or_accepted(*this);
-
-	nations::update_administrative_efficiency(*this);
-	rebel::update_movement_values(*this);
-
-	economy::regenerate_unsaved_values(*this);
-
-	military::regenerate_land_unit_average(*this);
-	military::regenerate_ship_scores(*this);
-	nations::update_industrial_scores(*this);
-	nations::update_military_scores(*this);
-	nations::update_rankings(*this);
-	nations::update_ui_rankings(*this);
+	/*
+	The rest of the reconstruction is split into tasks. A task lists every earlier task that writes something it reads (or
+	reads something it writes), so running the tasks whose dependencies have finished in parallel gives the same result as
+	running them one after another in the order they are listed.
+	*/
+	enum task : uint32_t {
+		tech_effects, connected_regions, province_values, issue_rules, reform_desire, state_instances, demographics_totals,
+		economy_values, trigger_prefilters, modifiers, military_values, nation_values, primary_cultures, administrative_efficiency,
+		movement_values, land_unit_average, ship_scores, rankings, flashpoints, volatile_triggers, task_count
+	};
+	std::vector<reconstruction_task> tasks(task_count);
+	tasks[tech_effects] = { "technology effects", [&]() {
+		military::reset_unit_stats(*this);
+		culture::clear_existing_tech_effects(*this);
+		culture::repopulate_technology_effects(*this);
+		culture::repopulate_invention_effects(*this);
+		military::apply_base_unit_stat_modifiers(*this);
+	}, {} };
+	tasks[connected_regions] = { "connected regions", [&]() { province::update_connected_regions(*this); }, {} };
+	// is_coast is read by the region fill before it is restored; capitals are picked from the (still empty) demographics
+	tasks[province_values] = { "province values", [&]() { province::restore_unsaved_values(*this); }, { connected_regions } };
+	tasks[issue_rules] = { "issue rules", [&]() { culture::update_all_nations_issue_rules(*this); }, {} };
+	tasks[reform_desire] = { "reform desire", [&]() { culture::restore_unsaved_values(*this); }, {} };
+	tasks[state_instances] = { "state instances", [&]() { nations::restore_state_instances(*this); }, { province_values } };
+	tasks[demographics_totals] = { "demographics", [&]() { demographics::regenerate_from_pop_data(*this); }, { province_values, reform_desire, state_instances } };
+	tasks[economy_values] = { "economy values", [&]() { economy::regenerate_unsaved_values(*this); }, {} };
+	tasks[trigger_prefilters] = { "event prefilters", [&]() { event::rebuild_trigger_prefilters(*this); }, {} }; // scenario data only
+	// triggered modifiers may test almost anything, so this waits for everything before it
+	tasks[modifiers] = { "modifiers", [&]() { sys::repopulate_modifier_effects(*this); },
+		{ tech_effects, connected_regions, province_values, issue_rules, reform_desire, state_instances, demographics_totals, economy_values } };
+	tasks[military_values] = { "military values", [&]() { military::restore_unsaved_values(*this); }, { modifiers } };
+	tasks[nation_values] = { "nation values", [&]() { nations::restore_unsaved_values(*this); }, { modifiers } };
+	// regiment recruitment reads the culture flags before they are regenerated
+	tasks[primary_cultures] = { "primary cultures", [&]() { pop_demographics::regenerate_is_primary_or_accepted(*this); }, { modifiers, military_values } };
+	tasks[administrative_efficiency] = { "administrative efficiency", [&]() { nations::update_administrative_efficiency(*this); }, { modifiers } };
+	tasks[movement_values] = { "movement values", [&]() { rebel::update_movement_values(*this); }, { modifiers } };
+	tasks[land_unit_average] = { "land unit average", [&]() { military::regenerate_land_unit_average(*this); }, { tech_effects, modifiers } };
+	tasks[ship_scores] = { "ship scores", [&]() { military::regenerate_ship_scores(*this); }, { tech_effects, modifiers } };
+	tasks[rankings] = { "rankings", [&]() {
+		nations::update_industrial_scores(*this);
+		nations::update_military_scores(*this);
+		nations::update_rankings(*this);
+		nations::update_ui_rankings(*this);
+	}, { military_values, nation_values, primary_cultures, administrative_efficiency, movement_values, land_unit_average, ship_scores } };
+	tasks[flashpoints] = { "flashpoints", [&]() { nations::monthly_flashpoint_update(*this); }, { rankings } };
+	// memoized trigger evaluation reads trigger_is_volatile, so it is replaced only once nothing else is running
+	tasks[volatile_triggers] = { "volatile triggers", [&]() { trigger::classify_volatile_triggers(*this); }, { trigger_prefilters, flashpoints } };
 
-	nations::monthly_flashpoint_update(*this);
+	run_reconstruction_tasks(tasks, serial_reconstruction, load_timings);
 
 	//
 	// clear any pending messages from previously loaded saves
@@ -3657,13 +3658,16 @@ void state::fill_unsaved_data() { // reconstructs derived values that are not di
 
 #endif // ! NDEBUG
 
+	load_timings.push_back(load_timing{ "total", std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - load_start).count() });
 	game_state_updated.store(true, std::memory_order::release);
 }
 
 void state::single_game_tick() {
 	// do update logic
-	
+	command::log_tick(*this);
+
 	current_date += 1;
+	trigger::invalidate_memoized_results(*this);
 
 	if(!is_playable_date(current_date, start_date, end_date)) {
 		mode = sys::game_mode_type::end_screen;
@@ -3846,6 +3850,8 @@ void state::single_game_tick() {
 	}
 
 	demographics::remove_size_zero_pops(*this);
+	if(ymd_date.day == 1)
+		demographics::compact_pops_by_location(*this);
 
 	// basic repopulation of demographics derived values
 	demographics::regenerate_from_pop_data(*this);
@@ -4128,6 +4134,7 @@ void state::single_game_tick() {
 	province::update_connected_regions(*this);
 	province::update_cached_values(*this);
 	nations::update_cached_values(*this);
+	trigger::invalidate_memoized_results(*this);
 	/*
 	 * END OF DAY: update cached data
 	 */
@@ -4143,6 +4150,7 @@ void state::single_game_tick() {
 
 	ui_date = current_date;
 
+	snapshot::publish(*this);
 	game_state_updated.store(true, std::memory_order::release);
 
 	switch(user_settings.autosaves) {
@@ -4245,6 +4253,7 @@ void state::game_loop() {
 	game_speed[4] = int32_t(defines.alice_speed_4);
 
 	while(quit_signaled.load(std::memory_order::acquire) == false) {
+		command::update_command_log(*this);
 		network::send_and_receive_commands(*this);
 		command::execute_pending_commands(*this);
 		if(network_mode == sys::network_mode_type::client) {
@@ -4277,6 +4286,7 @@ void state::game_loop() {
 			}
 		}
 	}
+	command::stop_command_log(*this);
 }
 
 void state::console_log(ui::element_base* base, std::string message, bool open_console) {
@@ -30,6 +30,9 @@
 #include "events.hpp"
 #include "notifications.hpp"
 #include "network.hpp"
+#include "pool_index.hpp"
+#include "name_search.hpp"
+#include "ui_snapshot.hpp"
 
 // this header will eventually contain the highest-level objects
 // that represent the overall state of the program
@@ -362,6 +365,8 @@ struct user_settings_s {
 	uint8_t antialias_level = 0;
 	float gaussianblur_level = 1.f;
 	float gamma = 1.f;
+	uint32_t ui_snapshot_nation_fields = snapshot::default_nation_fields; // see snapshot::publish
+	uint32_t ui_snapshot_province_fields = snapshot::default_province_fields;
 };
 
 struct global_scenario_data_s { // this struct holds miscellaneous global properties of the scenario
@@ -414,6 +419,24 @@ struct player_data { // currently this data is serialized via memcpy, to make su
 	std::array<float, 32> population_record = { 0.0f }; // current day's value = date.value & 31
 };
 
+struct reconstruction_task { // see state::fill_unsaved_data
+	char const* name = "";
+	std::function<void()> run;
+	std::vector<uint32_t> depends_on; // indices of earlier tasks
+};
+struct load_timing {
+	char const* name = "";
+	float milliseconds = 0.0f;
+};
+
+struct command_log_data { // see command::start_command_log
+	std::vector<uint8_t> pending; // encoded entries that have not been appended to the log file yet
+	native_string file_name;
+	int32_t checksum_interval = 30; // days between recorded save checksums
+	bool recording = false;
+	bool replaying = false; // loading the start save of a replay, whose pops must keep the ids they had when it was written
+};
+
 // the state struct will eventually include (at least pointers to)
 // the state of the sound system, the state of the windowing system,
 // and the game data / state itself
@@ -442,18 +465,32 @@ struct alignas(64) state {
 	std::vector<int32_t> trigger_data_indices;
 	std::vector<uint16_t> effect_data;
 	std::vector<int32_t> effect_data_indices;
+	std::vector<uint8_t> trigger_is_volatile; // indexed by trigger key, see trigger::evaluate_memoized; not saved
 	std::vector<value_modifier_segment> value_modifier_segments;
 	tagged_vector<value_modifier_description, dcon::value_modifier_key> value_modifiers;
 
+	// interning indices for commit_trigger_data, commit_effect_data and add_unique_to_pool; not saved
+	pool_index::first_occurrence_index<uint16_t> trigger_data_search{1};
+	pool_index::key_index trigger_key_search;
+	pool_index::first_occurrence_index<uint16_t> effect_data_search{1};
+	pool_index::key_index effect_key_search;
+	pool_index::first_occurrence_index<char> text_data_search;
+
 	std::vector<char> text_data; // stores string data in the win1250 codepage
+	std::vector<uint64_t> text_terminators; // bit i is set when text_data[i] is zero, see to_string_view; not saved
+	search::name_search_state name_search; // see search::find_names; not saved
+	snapshot::ui_snapshot_state ui_snapshot; // see snapshot::publish; not saved
+	text::layout_cache tooltip_cache; // see state::render
 	std::vector<text::text_component> text_components;
 	tagged_vector<text::text_sequence, dcon::text_sequence_id> text_sequences;
 	ankerl::unordered_dense::map<dcon::text_key, dcon::text_sequence_id, text::vector_backed_hash, text::vector_backed_eq>
 			key_to_text_sequence;
 
 	bool adjacency_data_out_of_date = true;
-	bool national_cached_values_out_of_date = false;
-	bool diplomatic_cached_values_out_of_date = false;
+	std::vector<dcon::nation_id> nations_with_stale_cached_values; // province derived counts, see province::update_cached_values
+	std::vector<dcon::nation_id> nations_with_stale_diplomatic_values; // ally / vassal counts, see nations::update_cached_values
+	bool verify_cached_values = false; // debugging: compare every incremental update against a full rebuild
+	uint32_t cached_values_mismatches = 0;
 	std::vector<dcon::nation_id> nations_by_rank;
 	std::vector<dcon::nation_id> nations_by_industrial_score;
 	std::vector<dcon::nation_id> nations_by_military_score;
@@ -502,6 +539,8 @@ struct alignas(64) state {
 	std::vector<event::pending_human_n_event> future_n_event;
 	std::vector<event::pending_human_p_event> future_p_event;
 
+	event::trigger_prefilter_index event_prefilters; // derived from the triggers of the free events, not saved
+
 	std::vector<int32_t> unit_names_indices; // indices for the names
 	std::vector<char> unit_names;
 	// a second text buffer, this time for just the unit names
@@ -533,6 +572,9 @@ struct alignas(64) state {
 	uint32_t game_seed = 0; // do *not* alter this value, ever
 	float inflation = 1.0f;
 	player_data player_data_cache;
+	command_log_data command_log;
+	std::vector<load_timing> load_timings; // breakdown of the last fill_unsaved_data
+	bool serial_reconstruction = false; // run the fill_unsaved_data tasks one at a time, in order
 	std::vector<dcon::army_id> selected_armies;
 	std::vector<dcon::navy_id> selected_navies;
 	std::optional<state_selection_data> state_selection;
@@ -546,12 +588,15 @@ struct alignas(64) state {
 
 	// synchronization data (between main update logic and ui thread)
 	std::atomic<bool> game_state_updated = false;                    // game state -> ui signal
+	std::atomic<uint32_t> command_generation = 0; // counts batches of executed commands, see text::layout_cache
 	std::atomic<bool> province_ownership_changed = true;                    // game state -> ui signal
 	std::atomic<bool> save_list_updated = false;                     // game state -> ui signal
 	std::atomic<bool> quit_signaled = false;                         // ui -> game state signal
 	std::atomic<int32_t> actual_game_speed = 0;                      // ui -> game state message
 	rigtorp::SPSCQueue<command::payload> incoming_commands;          // ui or network -> local gamestate
 	std::atomic<bool> ui_pause = false;                              // force pause by an important message being open
+	std::atomic<bool> command_log_requested = false;                 // ui -> game state: record executed commands, see command::update_command_log
+	std::atomic<uint32_t> trigger_memo_generation = 0;               // bumped at tick boundaries, on commands and on effects, see trigger::evaluate_memoized
 
 	// synchronization: notifications from the gamestate to ui
 	rigtorp::SPSCQueue<event::pending_human_n_event> new_n_event;
@@ -626,6 +671,7 @@ struct alignas(64) state {
 	// the following function are for interacting with the string pool
 
 	std::string_view to_string_view(dcon::text_key tag) const; // takes a stored tag and give you the text
+	void rebuild_text_terminators(); // call after replacing text_data wholesale, as when loading a scenario
 
 	dcon::text_key add_to_pool(std::string const& text); // returns the newly added text
 	dcon::text_key add_to_pool(std::string_view text);
@@ -634,7 +680,7 @@ struct alignas(64) state {
 
 	// searches the string pool for any existing string, appends if it is new
 	// use this function sparingly; i.e. only when you think it is likely that
-	// the text has already been added. Searching *all* the text may not be cheap
+	// the text has already been added. The first call indexes *all* the text, which is not cheap
 	dcon::text_key add_unique_to_pool(std::string const& text);
 
 	dcon::unit_name_id add_unit_name(std::string_view text);       // returns the newly added text
@@ -643,7 +689,7 @@ struct alignas(64) state {
 	dcon::trigger_key commit_trigger_data(std::vector<uint16_t> data);
 	dcon::effect_key commit_effect_data(std::vector<uint16_t> data);
 
-	state() : key_to_text_sequence(0, text::vector_backed_hash(text_data), text::vector_backed_eq(text_data)), incoming_commands(1024), new_n_event(1024), new_f_n_event(1024), new_p_event(1024), new_f_p_event(1024), new_requests(256), new_messages(2048), naval_battle_reports(256), land_battle_reports(256) { }
+	state() : key_to_text_sequence(0, text::vector_backed_hash(text_data, text_terminators), text::vector_backed_eq(text_data, text_terminators)), incoming_commands(1024), new_n_event(1024), new_f_n_event(1024), new_p_event(1024), new_f_p_event(1024), new_requests(256), new_messages(2048), naval_battle_reports(256), land_battle_reports(256) { }
 
 	~state() = default;
 
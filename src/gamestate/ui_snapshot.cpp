@@ -0,0 +1,160 @@
+#include "ui_snapshot.hpp"
+#include "system_state.hpp"
+#include "demographics.hpp"
+#include <chrono>
+
+namespace snapshot {
+
+std::string_view field_name(nation_field f) {
+	switch(f) {
+	case nation_field::prestige:
+		return "prestige";
+	case nation_field::industrial_score:
+		return "industrial_score";
+	case nation_field::military_score:
+		return "military_score";
+	case nation_field::rank:
+		return "rank";
+	case nation_field::infamy:
+		return "infamy";
+	case nation_field::war_exhaustion:
+		return "war_exhaustion";
+	case nation_field::plurality:
+		return "plurality";
+	case nation_field::revanchism:
+		return "revanchism";
+	case nation_field::treasury:
+		return "treasury";
+	case nation_field::population:
+		return "population";
+	case nation_field::count:
+		break;
+	}
+	return "";
+}
+
+std::string_view field_name(province_field f) {
+	switch(f) {
+	case province_field::population:
+		return "province_population";
+	case province_field::militancy:
+		return "province_militancy";
+	case province_field::consciousness:
+		return "province_consciousness";
+	case province_field::literacy:
+		return "province_literacy";
+	case province_field::count:
+		break;
+	}
+	return "";
+}
+
+float live_value(sys::state const& state, dcon::nation_id n, nation_field f) {
+	switch(f) {
+	case nation_field::prestige:
+		return nations::prestige_score(state, n);
+	case nation_field::industrial_score:
+		return float(state.world.nation_get_industrial_score(n));
+	case nation_field::military_score:
+		return float(state.world.nation_get_military_score(n));
+	case nation_field::rank:
+		return float(state.world.nation_get_rank(n));
+	case nation_field::infamy:
+		return state.world.nation_get_infamy(n);
+	case nation_field::war_exhaustion:
+		return state.world.nation_get_war_exhaustion(n);
+	case nation_field::plurality:
+		return state.world.nation_get_plurality(n);
+	case nation_field::revanchism:
+		return state.world.nation_get_revanchism(n);
+	case nation_field::treasury:
+		return state.world.nation_get_stockpiles(n, economy::money);
+	case nation_field::population:
+		return state.world.nation_get_demographics(n, demographics::total);
+	case nation_field::count:
+		break;
+	}
+	return 0.0f;
+}
+
+float live_value(sys::state const& state, dcon::province_id p, province_field f) {
+	switch(f) {
+	case province_field::population:
+		return state.world.province_get_demographics(p, demographics::total);
+	case province_field::militancy:
+		return state.world.province_get_demographics(p, demographics::militancy);
+	case province_field::consciousness:
+		return state.world.province_get_demographics(p, demographics::consciousness);
+	case province_field::literacy:
+		return state.world.province_get_demographics(p, demographics::literacy);
+	case province_field::count:
+		break;
+	}
+	return 0.0f;
+}
+
+void publish(sys::state& state) {
+	auto& s = state.ui_snapshot;
+	auto start = std::chrono::steady_clock::now();
+
+	auto& f = s.buffers.write_buffer();
+	f.nation_fields = s.nation_fields.load(std::memory_order::acquire);
+	f.province_fields = s.province_fields.load(std::memory_order::acquire);
+	f.generation = s.generation.load(std::memory_order::acquire);
+	f.nation_count = f.nation_fields != 0 ? uint32_t(state.world.nation_size()) : 0;
+	f.province_count = f.province_fields != 0 ? uint32_t(state.world.province_size()) : 0;
+	f.nation_values.resize(size_t(nation_field::count) * f.nation_count);
+	f.province_values.resize(size_t(province_field::count) * f.province_count);
+
+	for(uint32_t i = 0; i < uint32_t(nation_field::count); ++i) {
+		if((f.nation_fields & field_bit(nation_field(i))) == 0)
+			continue;
+		auto* out = f.nation_values.data() + size_t(i) * f.nation_count;
+		for(uint32_t j = 0; j < f.nation_count; ++j)
+			out[j] = live_value(state, dcon::nation_id{ dcon::nation_id::value_base_t(j) }, nation_field(i));
+	}
+	for(uint32_t i = 0; i < uint32_t(province_field::count); ++i) {
+		if((f.province_fields & field_bit(province_field(i))) == 0)
+			continue;
+		auto* out = f.province_values.data() + size_t(i) * f.province_count;
+		for(uint32_t j = 0; j < f.province_count; ++j)
+			out[j] = live_value(state, dcon::province_id{ dcon::province_id::value_base_t(j) }, province_field(i));
+	}
+
+	auto elapsed = uint32_t(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count());
+	s.last_copy_microseconds.store(elapsed, std::memory_order::relaxed);
+	if(elapsed > s.max_copy_microseconds.load(std::memory_order::relaxed))
+		s.max_copy_microseconds.store(elapsed, std::memory_order::relaxed);
+	s.bytes.store(uint32_t((f.nation_values.capacity() + f.province_values.capacity()) * sizeof(float)), std::memory_order::relaxed);
+	s.published.fetch_add(1, std::memory_order::relaxed);
+
+	s.buffers.publish();
+}
+
+bool acquire(sys::state& state) {
+	return state.ui_snapshot.buffers.acquire();
+}
+
+void invalidate(sys::state& state) {
+	state.ui_snapshot.generation.fetch_add(1, std::memory_order::acq_rel);
+}
+
+float nation_value(sys::state const& state, dcon::nation_id n, nation_field f) {
+	auto const& s = state.ui_snapshot.buffers.read_buffer();
+	if((s.nation_fields & field_bit(f)) != 0 && uint32_t(n.index()) < s.nation_count
+			&& s.generation == state.ui_snapshot.generation.load(std::memory_order::acquire)) {
+		return s.nation_values[size_t(f) * s.nation_count + n.index()];
+	}
+	return live_value(state, n, f);
+}
+
+float province_value(sys::state const& state, dcon::province_id p, province_field f) {
+	auto const& s = state.ui_snapshot.buffers.read_buffer();
+	if((s.province_fields & field_bit(f)) != 0 && uint32_t(p.index()) < s.province_count
+			&& s.generation == state.ui_snapshot.generation.load(std::memory_order::acquire)) {
+		return s.province_values[size_t(f) * s.province_count + p.index()];
+	}
+	return live_value(state, p, f);
+}
+
+} // namespace snapshot
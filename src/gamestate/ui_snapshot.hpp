@@ -0,0 +1,94 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+#include "dcon_generated.hpp"
+#include "triple_buffer.hpp"
+
+namespace sys {
+struct state;
+}
+
+/*
+A copy of the values that the ui sorts and colors by, published by the game thread after every tick and every batch of
+commands. The render thread otherwise reads state.world while the next tick is changing it, which is harmless for a label
+that is redrawn next frame but not for a std::sort whose comparisons must agree with each other, or for a map mode that
+normalizes by a maximum taken a moment earlier. Readers go through nation_value and province_value, which return the
+value from the snapshot the render thread picked up at the start of its frame, or the live value for fields that are not
+selected.
+
+Which fields are copied is a user setting (two bit masks, see the "snapshot" console command); with no fields selected
+nothing is copied and every read is live. The time and memory taken by the last copy are kept for the console.
+*/
+
+namespace snapshot {
+
+enum class nation_field : uint8_t {
+	prestige,          // nations::prestige_score
+	industrial_score,
+	military_score,
+	rank,
+	infamy,
+	war_exhaustion,
+	plurality,
+	revanchism,
+	treasury,
+	population,
+	count
+};
+enum class province_field : uint8_t {
+	population, // the demographics sums, not divided by the population
+	militancy,
+	consciousness,
+	literacy,
+	count
+};
+
+inline constexpr uint32_t field_bit(nation_field f) {
+	return uint32_t(1) << uint32_t(f);
+}
+inline constexpr uint32_t field_bit(province_field f) {
+	return uint32_t(1) << uint32_t(f);
+}
+inline constexpr uint32_t default_nation_fields = (uint32_t(1) << uint32_t(nation_field::count)) - 1;
+inline constexpr uint32_t default_province_fields = (uint32_t(1) << uint32_t(province_field::count)) - 1;
+
+std::string_view field_name(nation_field f);
+std::string_view field_name(province_field f);
+
+struct frame {
+	std::vector<float> nation_values;   // field major: the value of field f for nation n is at f * nation_count + n
+	std::vector<float> province_values; // likewise
+	uint32_t nation_count = 0;
+	uint32_t province_count = 0;
+	uint32_t nation_fields = 0;   // the fields present in this frame
+	uint32_t province_fields = 0;
+	uint32_t generation = 0;      // frames from before the last invalidate are not used
+};
+
+struct ui_snapshot_state {
+	triple_buffer<frame> buffers;
+	std::atomic<uint32_t> nation_fields = default_nation_fields; // set from user_settings, read by the game thread
+	std::atomic<uint32_t> province_fields = default_province_fields;
+	std::atomic<uint32_t> generation = 0;
+
+	// measurements of the last publish, for the console
+	std::atomic<uint32_t> last_copy_microseconds = 0;
+	std::atomic<uint32_t> max_copy_microseconds = 0;
+	std::atomic<uint32_t> bytes = 0; // held by each of the three buffers
+	std::atomic<uint32_t> published = 0;
+};
+
+float live_value(sys::state const& state, dcon::nation_id n, nation_field f);
+float live_value(sys::state const& state, dcon::province_id p, province_field f);
+
+void publish(sys::state& state);    // game thread: after a tick or a batch of commands
+bool acquire(sys::state& state);    // render thread: at the start of a frame; returns true if a newer snapshot was picked up
+void invalidate(sys::state& state); // call when a scenario or save is loaded
+
+// render thread
+float nation_value(sys::state const& state, dcon::nation_id n, nation_field f);
+float province_value(sys::state const& state, dcon::province_id p, province_field f);
+
+} // namespace snapshot
@@ -1,9 +1,12 @@
 #include <string>
 #include <string_view>
 #include <variant>
+#include <array>
 #include "gui_console.hpp"
 #include "gui_fps_counter.hpp"
 #include "nations.hpp"
+#include "triggers.hpp"
+#include "name_search.hpp"
 
 struct command_info {
 	static constexpr uint32_t max_arg_slots = 4;
@@ -45,6 +48,13 @@ struct command_info {
 		complete_constructions,
 		instant_research,
 		game_info,
+		trigger_cache_stats,
+		verify_cached_values,
+		command_log,
+		load_timings,
+		find_name,
+		tooltip_cache_stats,
+		ui_snapshot,
 		spectate,
 		change_owner,
 		change_control,
@@ -167,6 +177,27 @@ inline constexpr command_info possible_commands[] = {
 		command_info{"gi", command_info::type::game_info, "Shows general game information",
 				{command_info::argument_info{}, command_info::argument_info{},
 						command_info::argument_info{}, command_info::argument_info{}}},
+		command_info{"tcache", command_info::type::trigger_cache_stats, "Shows trigger memoization statistics and resets them",
+				{command_info::argument_info{}, command_info::argument_info{},
+						command_info::argument_info{}, command_info::argument_info{}}},
+		command_info{"cverify", command_info::type::verify_cached_values, "Toggles checking incremental cached value updates against a full rebuild",
+				{command_info::argument_info{}, command_info::argument_info{},
+						command_info::argument_info{}, command_info::argument_info{}}},
+		command_info{"cmdlog", command_info::type::command_log, "Toggles recording executed commands to a log next to a new save, for replaying",
+				{command_info::argument_info{}, command_info::argument_info{},
+						command_info::argument_info{}, command_info::argument_info{}}},
+		command_info{"find", command_info::type::find_name, "Finds provinces, nations, states, leaders and units by name",
+				{command_info::argument_info{"name", command_info::argument_info::type::text, false}, command_info::argument_info{},
+						command_info::argument_info{}, command_info::argument_info{}}},
+		command_info{"ltimes", command_info::type::load_timings, "Shows how long each part of reconstructing the last loaded save took",
+				{command_info::argument_info{}, command_info::argument_info{},
+						command_info::argument_info{}, command_info::argument_info{}}},
+		command_info{"ttcache", command_info::type::tooltip_cache_stats, "Shows tooltip layout cache statistics and resets them",
+				{command_info::argument_info{}, command_info::argument_info{},
+						command_info::argument_info{}, command_info::argument_info{}}},
+		command_info{"snapshot", command_info::type::ui_snapshot, "Shows the cost of the ui snapshot, or toggles copying one of its fields (or all/none)",
+				{command_info::argument_info{"field", command_info::argument_info::type::text, true}, command_info::argument_info{},
+						command_info::argument_info{}, command_info::argument_info{}}},
 		command_info{ "spectate", command_info::type::spectate, "Become spectator nation",
 				{command_info::argument_info{}, command_info::argument_info{},
 						command_info::argument_info{}, command_info::argument_info{}} },
@@ -1189,6 +1220,123 @@ void ui::console_edit::edit_box_enter(sys::state& state, std::string_view s) noe
 		log_to_console(state, parent, std::string("Great Wars: ") + (state.military_definitions.great_wars_enabled ? "\x02" : "\x01"));
 		log_to_console(state, parent, std::string("World Wars: ") + (state.military_definitions.world_wars_enabled ? "\x02" : "\x01"));
 		break;
+	case command_info::type::trigger_cache_stats:
+	{
+		auto stats = trigger::get_memo_statistics();
+		auto total = stats.hits + stats.misses;
+		log_to_console(state, parent, "Hits: " + std::to_string(stats.hits));
+		log_to_console(state, parent, "Misses: " + std::to_string(stats.misses));
+		log_to_console(state, parent, "Volatile: " + std::to_string(stats.volatile_evaluations));
+		log_to_console(state, parent, "Hit rate: " + std::to_string(total != 0 ? float(stats.hits) * 100.f / float(total) : 0.f) + "%");
+		trigger::reset_memo_statistics();
+		break;
+	}
+	case command_info::type::verify_cached_values:
+		state.verify_cached_values = !state.verify_cached_values;
+		log_to_console(state, parent, std::string("Verify cached values: ") + (state.verify_cached_values ? "\x02" : "\x01"));
+		log_to_console(state, parent, "Mismatches: " + std::to_string(state.cached_values_mismatches));
+		break;
+	case command_info::type::command_log:
+	{
+		bool requested = !state.command_log_requested.load(std::memory_order::acquire);
+		state.command_log_requested.store(requested, std::memory_order::release);
+		log_to_console(state, parent, std::string("Command log: ") + (requested ? "\x02" : "\x01"));
+		break;
+	}
+	case command_info::type::tooltip_cache_stats:
+	{
+		auto total = state.tooltip_cache.hits + state.tooltip_cache.misses;
+		log_to_console(state, parent, "Hits: " + std::to_string(state.tooltip_cache.hits));
+		log_to_console(state, parent, "Misses: " + std::to_string(state.tooltip_cache.misses));
+		log_to_console(state, parent, "Hit rate: " + std::to_string(total != 0 ? float(state.tooltip_cache.hits) * 100.f / float(total) : 0.f) + "%");
+		state.tooltip_cache.hits = 0;
+		state.tooltip_cache.misses = 0;
+		break;
+	}
+	case command_info::type::ui_snapshot:
+	{
+		auto& nation_fields = state.user_settings.ui_snapshot_nation_fields;
+		auto& province_fields = state.user_settings.ui_snapshot_province_fields;
+		if(std::holds_alternative<std::string>(pstate.arg_slots[0])) {
+			auto name = std::get<std::string>(pstate.arg_slots[0]);
+			bool found = false;
+			if(name == "all" || name == "none") {
+				nation_fields = name == "all" ? snapshot::default_nation_fields : 0;
+				province_fields = name == "all" ? snapshot::default_province_fields : 0;
+				found = true;
+			}
+			for(uint32_t i = 0; i < uint32_t(snapshot::nation_field::count) && !found; ++i) {
+				if(snapshot::field_name(snapshot::nation_field(i)) == name) {
+					nation_fields ^= snapshot::field_bit(snapshot::nation_field(i));
+					found = true;
+				}
+			}
+			for(uint32_t i = 0; i < uint32_t(snapshot::province_field::count) && !found; ++i) {
+				if(snapshot::field_name(snapshot::province_field(i)) == name) {
+					province_fields ^= snapshot::field_bit(snapshot::province_field(i));
+					found = true;
+				}
+			}
+			if(!found) {
+				log_to_console(state, parent, "Unknown field: " + name);
+				break;
+			}
+			state.ui_snapshot.nation_fields.store(nation_fields, std::memory_order::release);
+			state.ui_snapshot.province_fields.store(province_fields, std::memory_order::release);
+			state.save_user_settings();
+		}
+		for(uint32_t i = 0; i < uint32_t(snapshot::nation_field::count); ++i) {
+			bool on = (nation_fields & snapshot::field_bit(snapshot::nation_field(i))) != 0;
+			log_to_console(state, parent, std::string(snapshot::field_name(snapshot::nation_field(i))) + ": " + (on ? "\x02" : "\x01"));
+		}
+		for(uint32_t i = 0; i < uint32_t(snapshot::province_field::count); ++i) {
+			bool on = (province_fields & snapshot::field_bit(snapshot::province_field(i))) != 0;
+			log_to_console(state, parent, std::string(snapshot::field_name(snapshot::province_field(i))) + ": " + (on ? "\x02" : "\x01"));
+		}
+		log_to_console(state, parent, "Published: " + std::to_string(state.ui_snapshot.published.load(std::memory_order::relaxed)));
+		log_to_console(state, parent, "Last copy: " + std::to_string(state.ui_snapshot.last_copy_microseconds.load(std::memory_order::relaxed)) + " us");
+		log_to_console(state, parent, "Slowest copy: " + std::to_string(state.ui_snapshot.max_copy_microseconds.load(std::memory_order::relaxed)) + " us");
+		log_to_console(state, parent, "Memory: 3 x " + std::to_string(state.ui_snapshot.bytes.load(std::memory_order::relaxed)) + " bytes");
+		break;
+	}
+	case command_info::type::load_timings:
+		for(auto const& t : state.load_timings)
+			log_to_console(state, parent, std::string(t.name) + ": " + std::to_string(t.milliseconds) + " ms");
+		break;
+	case command_info::type::find_name:
+	{
+		std::array<search::result, 20> found{};
+		auto count = search::find_names(state, std::get<std::string>(pstate.arg_slots[0]), search::all_kinds, found);
+		for(uint32_t i = 0; i < count; ++i) {
+			auto const& r = found[i];
+			switch(r.type) {
+			case search::kind::province:
+				log_to_console(state, parent, "Province " + std::to_string(r.id) + ": " + text::produce_simple_string(state, state.world.province_get_name(search::as_province(r))));
+				break;
+			case search::kind::nation:
+			{
+				auto ident = search::as_national_identity(r);
+				log_to_console(state, parent, "Nation " + nations::int_to_tag(state.world.national_identity_get_identifying_int(ident)) + ": " + text::produce_simple_string(state, state.world.national_identity_get_name(ident)));
+				break;
+			}
+			case search::kind::state:
+				log_to_console(state, parent, "State " + std::to_string(r.id) + ": " + text::produce_simple_string(state, state.world.state_definition_get_name(search::as_state_definition(r))));
+				break;
+			case search::kind::leader:
+				log_to_console(state, parent, "Leader " + std::to_string(r.id) + ": " + std::string(state.to_string_view(state.world.leader_get_name(search::as_leader(r)))));
+				break;
+			case search::kind::army:
+				log_to_console(state, parent, "Army " + std::to_string(r.id) + ": " + std::string(state.to_string_view(state.world.army_get_name(search::as_army(r)))));
+				break;
+			case search::kind::navy:
+				log_to_console(state, parent, "Navy " + std::to_string(r.id) + ": " + std::string(state.to_string_view(state.world.navy_get_name(search::as_navy(r)))));
+				break;
+			}
+		}
+		if(count == 0)
+			log_to_console(state, parent, "Nothing found");
+		break;
+	}
 	case command_info::type::spectate:
 		command::c_switch_nation(state, state.local_player_nation, state.world.nation_get_identity_from_identity_holder(state.national_definitions.rebel_id));
 		break;
@@ -1649,18 +1649,18 @@ void flag_button2::button_action(sys::state& state) noexcept {
 void flag_button2::on_update(sys::state& state) noexcept {
 	auto nid = retrieve<dcon::nation_id>(state, this);
 	if(nid) {
-		flag_texture_handle = ogl::get_flag_handle(state, state.world.nation_get_identity_from_identity_holder(nid), culture::get_current_flag_type(state, nid));
+		flag_texture = ogl::get_flag_texture(state, state.world.nation_get_identity_from_identity_holder(nid), culture::get_current_flag_type(state, nid));
 		return;
 	}
 
 	auto tid = retrieve<dcon::national_identity_id>(state, this);
 	if(!nid && tid) {
-		flag_texture_handle = ogl::get_flag_handle(state, tid, culture::get_current_flag_type(state, tid));
+		flag_texture = ogl::get_flag_texture(state, tid, culture::get_current_flag_type(state, tid));
 		return;
 	}
 
 	auto reb_tag = state.world.nation_get_identity_from_identity_holder(state.national_definitions.rebel_id);
-	flag_texture_handle = ogl::get_flag_handle(state, reb_tag, culture::flag_type::default_flag);
+	flag_texture = ogl::get_flag_texture(state, reb_tag, culture::flag_type::default_flag);
 }
 
 void flag_button2::update_tooltip(sys::state& state, int32_t x, int32_t y, text::columnar_layout& contents) noexcept {
@@ -1694,20 +1694,20 @@ void flag_button2::render(sys::state& state, int32_t x, int32_t y) noexcept {
 	} else if(base_data.get_element_type() == element_type::button) {
 		gid = base_data.data.button.button_image;
 	}
-	if(gid && flag_texture_handle > 0) {
+	if(gid && flag_texture) {
 		auto& gfx_def = state.ui_defs.gfx[gid];
 		if(gfx_def.type_dependent) {
 			auto mask_handle = ogl::get_texture_handle(state, dcon::texture_id(gfx_def.type_dependent - 1), true);
 			auto& mask_tex = state.open_gl.asset_textures[dcon::texture_id(gfx_def.type_dependent - 1)];
-			ogl::render_masked_rect(state, get_color_modification(this == state.ui_state.under_mouse, disabled, interactable),
+			ogl::render_masked_flag(state, get_color_modification(this == state.ui_state.under_mouse, disabled, interactable),
 				float(x) + float(base_data.size.x - mask_tex.size_x) * 0.5f,
 				float(y) + float(base_data.size.y - mask_tex.size_y) * 0.5f,
 				float(mask_tex.size_x),
 				float(mask_tex.size_y),
-				flag_texture_handle, mask_handle, base_data.get_rotation(), gfx_def.is_vertically_flipped());
+				flag_texture, mask_handle, base_data.get_rotation(), gfx_def.is_vertically_flipped());
 		} else {
-			ogl::render_textured_rect(state, get_color_modification(this == state.ui_state.under_mouse, disabled, interactable),
-					float(x), float(y), float(base_data.size.x), float(base_data.size.y), flag_texture_handle, base_data.get_rotation(),
+			ogl::render_flag(state, get_color_modification(this == state.ui_state.under_mouse, disabled, interactable),
+					float(x), float(y), float(base_data.size.x), float(base_data.size.y), flag_texture, base_data.get_rotation(),
 					gfx_def.is_vertically_flipped());
 		}
 	}
@@ -1726,7 +1726,7 @@ void flag_button::set_current_nation(sys::state& state, dcon::national_identity_
 	} else {
 		flag_type = culture::get_current_flag_type(state, ident);
 	}
-	flag_texture_handle = ogl::get_flag_handle(state, ident, flag_type);
+	flag_texture = ogl::get_flag_texture(state, ident, flag_type);
 }
 
 void flag_button::on_update(sys::state& state) noexcept {
@@ -1744,20 +1744,20 @@ void flag_button::render(sys::state& state, int32_t x, int32_t y) noexcept {
 	} else if(base_data.get_element_type() == element_type::button) {
 		gid = base_data.data.button.button_image;
 	}
-	if(gid && flag_texture_handle > 0) {
+	if(gid && flag_texture) {
 		auto& gfx_def = state.ui_defs.gfx[gid];
 		if(gfx_def.type_dependent) {
 			auto mask_handle = ogl::get_texture_handle(state, dcon::texture_id(gfx_def.type_dependent - 1), true);
 			auto& mask_tex = state.open_gl.asset_textures[dcon::texture_id(gfx_def.type_dependent - 1)];
-			ogl::render_masked_rect(state, get_color_modification(this == state.ui_state.under_mouse, disabled, interactable),
+			ogl::render_masked_flag(state, get_color_modification(this == state.ui_state.under_mouse, disabled, interactable),
 				float(x) + float(base_data.size.x - mask_tex.size_x) * 0.5f,
 				float(y) + float(base_data.size.y - mask_tex.size_y) * 0.5f,
 				float(mask_tex.size_x),
 				float(mask_tex.size_y),
-				flag_texture_handle, mask_handle, base_data.get_rotation(), gfx_def.is_vertically_flipped());
+				flag_texture, mask_handle, base_data.get_rotation(), gfx_def.is_vertically_flipped());
 		} else {
-			ogl::render_textured_rect(state, get_color_modification(this == state.ui_state.under_mouse, disabled, interactable),
-					float(x), float(y), float(base_data.size.x), float(base_data.size.y), flag_texture_handle, base_data.get_rotation(),
+			ogl::render_flag(state, get_color_modification(this == state.ui_state.under_mouse, disabled, interactable),
+					float(x), float(y), float(base_data.size.x), float(base_data.size.y), flag_texture, base_data.get_rotation(),
 					gfx_def.is_vertically_flipped());
 		}
 	}
@@ -411,7 +411,7 @@ public:
 
 class flag_button : public button_element_base {
 protected:
-	GLuint flag_texture_handle = 0;
+	dcon::texture_id flag_texture;
 
 public:
 	virtual dcon::national_identity_id get_current_nation(sys::state& state) noexcept;
@@ -429,7 +429,7 @@ public:
 
 class flag_button2 : public button_element_base {
 public:
-	GLuint flag_texture_handle = 0;
+	dcon::texture_id flag_texture;
 
 	void button_action(sys::state& state) noexcept override;
 	void on_update(sys::state& state) noexcept override;
@@ -134,12 +134,12 @@ public:
 		} else if(base_data.get_element_type() == element_type::button) {
 			gid = base_data.data.button.button_image;
 		}
-		if(gid && flag_texture_handle > 0) {
+		if(gid && flag_texture) {
 			auto& gfx_def = state.ui_defs.gfx[gid];
 			auto mask_handle = ogl::get_texture_handle(state, dcon::texture_id(gfx_def.type_dependent - 1), true);
 			auto& mask_tex = state.open_gl.asset_textures[dcon::texture_id(gfx_def.type_dependent - 1)];
-			ogl::render_masked_rect(state, get_color_modification(this == state.ui_state.under_mouse, disabled, interactable), float(x),
-					float(y), float(base_data.size.x), float(base_data.size.y), flag_texture_handle, mask_handle, base_data.get_rotation(),
+			ogl::render_masked_flag(state, get_color_modification(this == state.ui_state.under_mouse, disabled, interactable), float(x),
+					float(y), float(base_data.size.x), float(base_data.size.y), flag_texture, mask_handle, base_data.get_rotation(),
 					gfx_def.is_vertically_flipped());
 		}
 		image_element_base::render(state, x, y);
@@ -170,12 +170,12 @@ public:
 		} else if(base_data.get_element_type() == element_type::button) {
 			gid = base_data.data.button.button_image;
 		}
-		if(gid && flag_texture_handle > 0) {
+		if(gid && flag_texture) {
 			auto& gfx_def = state.ui_defs.gfx[gid];
 			auto mask_handle = ogl::get_texture_handle(state, dcon::texture_id(gfx_def.type_dependent - 1), true);
 			auto& mask_tex = state.open_gl.asset_textures[dcon::texture_id(gfx_def.type_dependent - 1)];
-			ogl::render_masked_rect(state, get_color_modification(this == state.ui_state.under_mouse, disabled, interactable), float(x),
-				float(y), float(base_data.size.x), float(base_data.size.y), flag_texture_handle, mask_handle,
+			ogl::render_masked_flag(state, get_color_modification(this == state.ui_state.under_mouse, disabled, interactable), float(x),
+				float(y), float(base_data.size.x), float(base_data.size.y), flag_texture, mask_handle,
 				ui::rotation::r90_right, false);
 	
 			ogl::render_textured_rect(state, get_color_modification(this == state.ui_state.under_mouse, disabled, interactable),
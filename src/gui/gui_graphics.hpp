@@ -436,6 +436,9 @@ struct state {
 	int32_t held_game_speed = 1; // used to keep track of speed while paused
 
 	uint16_t tooltip_font = 0;
+	// bumped whenever what the ui shows may have changed: when render picks up a game state update and when the ui gets input.
+	// Cached tooltip layouts from an earlier generation are not reused, see text::layout_cache
+	uint32_t content_generation = 0;
 	bool ctrl_held_down = false;
 
 	state();
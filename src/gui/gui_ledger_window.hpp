@@ -264,36 +264,36 @@ public:
 			case ledger_sort_type::military_score:
 				std::sort(row_contents.begin(), row_contents.end(), [&](dcon::nation_id a, dcon::nation_id b) {
 					if(lsort.reversed) {
-						return state.world.nation_get_military_score(a) < state.world.nation_get_military_score(b);
+						return snapshot::nation_value(state, a, snapshot::nation_field::military_score) < snapshot::nation_value(state, b, snapshot::nation_field::military_score);
 					} else {
-						return state.world.nation_get_military_score(a) > state.world.nation_get_military_score(b);
+						return snapshot::nation_value(state, a, snapshot::nation_field::military_score) > snapshot::nation_value(state, b, snapshot::nation_field::military_score);
 					}
 				});
 				break;
 			case ledger_sort_type::industrial_score:
 				std::sort(row_contents.begin(), row_contents.end(), [&](dcon::nation_id a, dcon::nation_id b) {
 					if(lsort.reversed) {
-						return state.world.nation_get_industrial_score(a) < state.world.nation_get_industrial_score(b);
+						return snapshot::nation_value(state, a, snapshot::nation_field::industrial_score) < snapshot::nation_value(state, b, snapshot::nation_field::industrial_score);
 					} else {
-						return state.world.nation_get_industrial_score(a) > state.world.nation_get_industrial_score(b);
+						return snapshot::nation_value(state, a, snapshot::nation_field::industrial_score) > snapshot::nation_value(state, b, snapshot::nation_field::industrial_score);
 					}
 				});
 				break;
 			case ledger_sort_type::prestige:
 				std::sort(row_contents.begin(), row_contents.end(), [&](dcon::nation_id a, dcon::nation_id b) {
 					if(lsort.reversed) {
-						return nations::prestige_score(state, a) < nations::prestige_score(state, b);
+						return snapshot::nation_value(state, a, snapshot::nation_field::prestige) < snapshot::nation_value(state, b, snapshot::nation_field::prestige);
 					} else {
-						return nations::prestige_score(state, a) > nations::prestige_score(state, b);
+						return snapshot::nation_value(state, a, snapshot::nation_field::prestige) > snapshot::nation_value(state, b, snapshot::nation_field::prestige);
 					}
 				});
 				break;
 			case ledger_sort_type::total_score:
 				std::sort(row_contents.begin(), row_contents.end(), [&](dcon::nation_id a, dcon::nation_id b) {
 					if(lsort.reversed) {
-						return state.world.nation_get_military_score(a) + state.world.nation_get_industrial_score(a) + nations::prestige_score(state, a) < state.world.nation_get_military_score(b) + state.world.nation_get_industrial_score(b) + nations::prestige_score(state, b);
+						return snapshot::nation_value(state, a, snapshot::nation_field::military_score) + snapshot::nation_value(state, a, snapshot::nation_field::industrial_score) + snapshot::nation_value(state, a, snapshot::nation_field::prestige) < snapshot::nation_value(state, b, snapshot::nation_field::military_score) + snapshot::nation_value(state, b, snapshot::nation_field::industrial_score) + snapshot::nation_value(state, b, snapshot::nation_field::prestige);
 					} else {
-						return state.world.nation_get_military_score(a) + state.world.nation_get_industrial_score(a) + nations::prestige_score(state, a) > state.world.nation_get_military_score(b) + state.world.nation_get_industrial_score(b) + nations::prestige_score(state, b);
+						return snapshot::nation_value(state, a, snapshot::nation_field::military_score) + snapshot::nation_value(state, a, snapshot::nation_field::industrial_score) + snapshot::nation_value(state, a, snapshot::nation_field::prestige) > snapshot::nation_value(state, b, snapshot::nation_field::military_score) + snapshot::nation_value(state, b, snapshot::nation_field::industrial_score) + snapshot::nation_value(state, b, snapshot::nation_field::prestige);
 					}
 				});
 				break;
@@ -487,9 +487,9 @@ public:
 		case ledger_sort_type::total_pop:
 			std::sort(row_contents.begin(), row_contents.end(), [&](dcon::nation_id a, dcon::nation_id b) {
 				if(lsort.reversed) {
-					return state.world.nation_get_demographics(a, demographics::total) < state.world.nation_get_demographics(b, demographics::total);
+					return snapshot::nation_value(state, a, snapshot::nation_field::population) < snapshot::nation_value(state, b, snapshot::nation_field::population);
 				} else {
-					return state.world.nation_get_demographics(a, demographics::total) > state.world.nation_get_demographics(b, demographics::total);
+					return snapshot::nation_value(state, a, snapshot::nation_field::population) > snapshot::nation_value(state, b, snapshot::nation_field::population);
 				}
 			});
 			break;
@@ -1274,36 +1274,36 @@ public:
 		case ledger_sort_type::total_pop:
 			std::sort(row_contents.begin(), row_contents.end(), [&](dcon::province_id a, dcon::province_id b) {
 				if(lsort.reversed) {
-					return state.world.province_get_demographics(a, demographics::total) < state.world.province_get_demographics(b, demographics::total);
+					return snapshot::province_value(state, a, snapshot::province_field::population) < snapshot::province_value(state, b, snapshot::province_field::population);
 				} else {
-					return state.world.province_get_demographics(a, demographics::total) > state.world.province_get_demographics(b, demographics::total);
+					return snapshot::province_value(state, a, snapshot::province_field::population) > snapshot::province_value(state, b, snapshot::province_field::population);
 				}
 			});
 			break;
 		case ledger_sort_type::militancy:
 			std::sort(row_contents.begin(), row_contents.end(), [&](dcon::province_id a, dcon::province_id b) {
 				if(lsort.reversed) {
-					return state.world.province_get_demographics(a, demographics::militancy) / std::max(1.0f, state.world.province_get_demographics(a, demographics::total)) < state.world.province_get_demographics(b, demographics::militancy) / std::max(1.0f, state.world.province_get_demographics(b, demographics::total));
+					return snapshot::province_value(state, a, snapshot::province_field::militancy) / std::max(1.0f, snapshot::province_value(state, a, snapshot::province_field::population)) < snapshot::province_value(state, b, snapshot::province_field::militancy) / std::max(1.0f, snapshot::province_value(state, b, snapshot::province_field::population));
 				} else {
-					return state.world.province_get_demographics(a, demographics::militancy) / std::max(1.0f, state.world.province_get_demographics(a, demographics::total)) > state.world.province_get_demographics(b, demographics::militancy) / std::max(1.0f, state.world.province_get_demographics(b, demographics::total));
+					return snapshot::province_value(state, a, snapshot::province_field::militancy) / std::max(1.0f, snapshot::province_value(state, a, snapshot::province_field::population)) > snapshot::province_value(state, b, snapshot::province_field::militancy) / std::max(1.0f, snapshot::province_value(state, b, snapshot::province_field::population));
 				}
 			});
 			break;
 		case ledger_sort_type::conciousness:
 			std::sort(row_contents.begin(), row_contents.end(), [&](dcon::province_id a, dcon::province_id b) {
 				if(lsort.reversed) {
-					return state.world.province_get_demographics(a, demographics::consciousness) / std::max(1.0f, state.world.province_get_demographics(a, demographics::total)) < state.world.province_get_demographics(b, demographics::consciousness) / std::max(1.0f, state.world.province_get_demographics(b, demographics::total));
+					return snapshot::province_value(state, a, snapshot::province_field::consciousness) / std::max(1.0f, snapshot::province_value(state, a, snapshot::province_field::population)) < snapshot::province_value(state, b, snapshot::province_field::consciousness) / std::max(1.0f, snapshot::province_value(state, b, snapshot::province_field::population));
 				} else {
-					return state.world.province_get_demographics(a, demographics::consciousness) / std::max(1.0f, state.world.province_get_demographics(a, demographics::total)) > state.world.province_get_demographics(b, demographics::consciousness) / std::max(1.0f, state.world.province_get_demographics(b, demographics::total));
+					return snapshot::province_value(state, a, snapshot::province_field::consciousness) / std::max(1.0f, snapshot::province_value(state, a, snapshot::province_field::population)) > snapshot::province_value(state, b, snapshot::province_field::consciousness) / std::max(1.0f, snapshot::province_value(state, b, snapshot::province_field::population));
 				}
 			});
 			break;
 		case ledger_sort_type::literacy:
 			std::sort(row_contents.begin(), row_contents.end(), [&](dcon::province_id a, dcon::province_id b) {
 				if(lsort.reversed) {
-					return state.world.province_get_demographics(a, demographics::literacy) / std::max(1.0f, state.world.province_get_demographics(a, demographics::total)) < state.world.province_get_demographics(b, demographics::literacy) / std::max(1.0f, state.world.province_get_demographics(b, demographics::total));
+					return snapshot::province_value(state, a, snapshot::province_field::literacy) / std::max(1.0f, snapshot::province_value(state, a, snapshot::province_field::population)) < snapshot::province_value(state, b, snapshot::province_field::literacy) / std::max(1.0f, snapshot::province_value(state, b, snapshot::province_field::population));
 				} else {
-					return state.world.province_get_demographics(a, demographics::literacy) / std::max(1.0f, state.world.province_get_demographics(a, demographics::total)) > state.world.province_get_demographics(b, demographics::literacy) / std::max(1.0f, state.world.province_get_demographics(b, demographics::total));
+					return snapshot::province_value(state, a, snapshot::province_field::literacy) / std::max(1.0f, snapshot::province_value(state, a, snapshot::province_field::population)) > snapshot::province_value(state, b, snapshot::province_field::literacy) / std::max(1.0f, snapshot::province_value(state, b, snapshot::province_field::population));
 				}
 			});
 			break;
@@ -0,0 +1,105 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+#include <vector>
+
+/*
+Keeps the rows of a large sorted list box between updates. Windows such as the population window used to rebuild their
+rows from scratch and sort them with a comparator that went back to the world for every comparison, every tick. The model
+instead remembers the members of the list (in the order the window walked them) and their current order. On an update the
+window walks its members into candidates() as before; if they are the same as last time, which is the usual case from one
+tick to the next, the model only refreshes the keys and repairs the order with an insertion sort, which costs little more
+than one pass when few rows have changed places. A different set of members, or a different sort, is sorted in full.
+
+Rows with equal keys stay in the order they were walked in (reversed for a descending sort), so the result is the same as a
+stable sort of the walked rows, whichever path produced it. The list box itself only creates windows for the visible rows,
+and the rows handed to it are only rewritten when the order actually changed.
+*/
+
+namespace ui {
+
+template<typename IdT>
+class sorted_list_model {
+public:
+	// the window pushes the current members here, in a deterministic order, before calling update
+	std::vector<IdT>& candidates() {
+		scratch.clear();
+		return scratch;
+	}
+
+	// sort_kind identifies the key function; changing it or the direction sorts the list in full. Returns whether rows changed
+	template<typename F>
+	bool update(uint32_t sort_kind, bool ascending, F&& key_of, std::vector<IdT>& rows) {
+		bool full = !valid || sort_kind != current_kind || ascending != current_ascending;
+		if(scratch != members) {
+			members.swap(scratch);
+			full = true;
+		}
+		valid = true;
+		current_kind = sort_kind;
+		current_ascending = ascending;
+
+		keys.resize(members.size());
+		for(size_t i = 0; i < members.size(); ++i)
+			keys[i] = key_of(members[i]);
+
+		auto before = [&](uint32_t a, uint32_t b) {
+			if(keys[a] != keys[b])
+				return ascending ? keys[a] < keys[b] : keys[a] > keys[b];
+			return ascending ? a < b : a > b;
+		};
+
+		bool changed = full || rows.size() != members.size();
+		last_moves = 0;
+		last_full_sort = full;
+		if(!full) {
+			// the previous order is nearly right; give up on it if too much has moved
+			size_t move_budget = order.size() * 8 + 64;
+			for(size_t i = 1; i < order.size() && !full; ++i) {
+				auto v = order[i];
+				size_t j = i;
+				for(; j > 0 && before(v, order[j - 1]); --j)
+					order[j] = order[j - 1];
+				order[j] = v;
+				last_moves += i - j;
+				full = last_moves > move_budget;
+			}
+			last_full_sort = full;
+			changed = changed || last_moves != 0;
+		}
+		if(full) {
+			order.resize(members.size());
+			std::iota(order.begin(), order.end(), uint32_t(0));
+			std::sort(order.begin(), order.end(), before);
+			changed = true;
+		}
+
+		if(changed) {
+			rows.resize(order.size());
+			for(size_t i = 0; i < order.size(); ++i)
+				rows[i] = members[order[i]];
+		}
+		return changed;
+	}
+
+	// forces the next update to sort in full
+	void invalidate() {
+		valid = false;
+	}
+
+	// measurements of the last update
+	size_t last_moves = 0;
+	bool last_full_sort = false;
+
+private:
+	std::vector<IdT> members;    // as walked by the window
+	std::vector<IdT> scratch;    // the walk in progress
+	std::vector<float> keys;     // parallel to members
+	std::vector<uint32_t> order; // indices into members, in list order
+	uint32_t current_kind = 0;
+	bool current_ascending = true;
+	bool valid = false;
+};
+
+} // namespace ui
@@ -6,7 +6,9 @@
 #include "gui_province_window.hpp"
 #include "province.hpp"
 #include "text.hpp"
+#include "name_search.hpp"
 #include <algorithm>
+#include <array>
 
 namespace ui {
 
@@ -48,21 +50,15 @@ private:
 	province_search_list* search_listbox = nullptr;
 	province_search_edit* edit_box = nullptr;
 
-	std::vector<dcon::province_id> search_provinces(sys::state& state, std::string_view search_term) noexcept {
-		std::vector<dcon::province_id> results{};
-		std::string search_term_lower = parsers::lowercase_str(search_term);
+	std::array<search::result, 128> results{};
 
-		if(!search_term.empty()) {
-			state.world.for_each_province([&](dcon::province_id prov_id) {
-				dcon::province_fat_id fat_id = dcon::fatten(state.world, prov_id);
-				auto name = parsers::lowercase_str(text::produce_simple_string(state, fat_id.get_name()));
-				if(name.starts_with(search_term_lower)) {
-					results.push_back(prov_id);
-				}
-			});
+	std::vector<dcon::province_id> search_provinces(sys::state& state, std::string_view search_term) noexcept {
+		std::vector<dcon::province_id> provinces{};
+		auto count = search::find_names(state, search_term, search::kind_bit(search::kind::province), results);
+		for(uint32_t i = 0; i < count; ++i) {
+			provinces.push_back(search::as_province(results[i]));
 		}
-
-		return results;
+		return provinces;
 	}
 
 public:
@@ -781,6 +781,16 @@ public:
 	element_base* topbar_subwindow = nullptr;
 };
 
+class topbar_diplomacy_button : public topbar_tab_button {
+public:
+	message_result on_mouse_move(sys::state& state, int32_t x, int32_t y, sys::key_modifiers mods) noexcept override {
+		// the diplomacy window shows the flag of every nation, so start loading them while the mouse is on its button
+		if(!topbar_subwindow->is_visible())
+			ogl::prefetch_flags(state);
+		return topbar_tab_button::on_mouse_move(state, x, y, mods);
+	}
+};
+
 class topbar_population_view_button : public topbar_tab_button {
 public:
 	void button_action(sys::state& state) noexcept override {
@@ -1234,9 +1244,9 @@ public:
 			state.world.for_each_decision([&](dcon::decision_id di) {
 				if(nation_id != state.local_player_nation || !state.world.decision_get_hide_notification(di)) {
 					auto lim = state.world.decision_get_potential(di);
-					if(!lim || trigger::evaluate(state, lim, trigger::to_generic(nation_id), trigger::to_generic(nation_id), 0)) {
+					if(!lim || trigger::evaluate_memoized(state, lim, trigger::to_generic(nation_id), trigger::to_generic(nation_id), 0)) {
 						auto allow = state.world.decision_get_allow(di);
-						if(!allow || trigger::evaluate(state, allow, trigger::to_generic(nation_id), trigger::to_generic(nation_id), 0)) {
+						if(!allow || trigger::evaluate_memoized(state, allow, trigger::to_generic(nation_id), trigger::to_generic(nation_id), 0)) {
 							auto fat_id = dcon::fatten(state.world, di);
 							auto box = text::open_layout_box(contents);
 							text::add_to_layout_box(state, contents, box, fat_id.get_name(), m);
@@ -1664,7 +1674,7 @@ public:
 			state.ui_state.root->add_child_to_back(std::move(tab));
 			return btn;
 		} else if(name == "topbarbutton_diplomacy") {
-			auto btn = make_element_by_type<topbar_tab_button>(state, id);
+			auto btn = make_element_by_type<topbar_diplomacy_button>(state, id);
 
 			auto tab = make_element_by_type<diplomacy_window>(state, "country_diplomacy");
 			btn->topbar_subwindow = tab.get();
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "gui_element_types.hpp"
+#include "gui_list_model.hpp"
 #include "gui_graphics.hpp"
 #include "gui_common_elements.hpp"
 #include "province.hpp"
@@ -2871,6 +2872,7 @@ public:
 class population_window : public window_element_base {
 private:
 	pop_listbox* country_pop_listbox = nullptr;
+	sorted_list_model<dcon::pop_id> pop_list_model; // the rows of country_pop_listbox
 	pop_left_side_listbox* left_side_listbox = nullptr;
 	pop_list_filter filter = std::monostate{};
 	pop_details_window* details_win = nullptr;
@@ -2884,7 +2886,7 @@ private:
 	bool sort_ascend = true;
 
 	void update_pop_list(sys::state& state) {
-		country_pop_listbox->row_contents.clear();
+		auto& members = pop_list_model.candidates();
 
 		auto nation_id = std::holds_alternative<dcon::nation_id>(filter) ? std::get<dcon::nation_id>(filter) : state.local_player_nation;
 		std::vector<dcon::state_instance_id> state_list{};
@@ -2908,136 +2910,56 @@ private:
 				auto pop_id = state.world.pop_location_get_pop(id);
 				auto pt_id = state.world.pop_get_poptype(pop_id);
 				if(pop_filters[dcon::pop_type_id::value_base_t(pt_id.id.index())])
-					country_pop_listbox->row_contents.push_back(pop_id);
+					members.push_back(pop_id);
 			});
 		}
 	}
 
-	void sort_pop_list(sys::state& state) {
-		std::function<bool(dcon::pop_id, dcon::pop_id)> fn;
+	static float pop_sort_key(sys::state& state, pop_list_sort sort, dcon::pop_id p) {
+		// smaller keys come first in an ascending list
+		auto fat_id = dcon::fatten(state.world, p);
 		switch(sort) {
 		case pop_list_sort::type:
-			fn = [&](dcon::pop_id a, dcon::pop_id b) {
-				auto a_fat_id = dcon::fatten(state.world, a);
-				auto b_fat_id = dcon::fatten(state.world, b);
-				return a_fat_id.get_poptype().id.index() < b_fat_id.get_poptype().id.index();
-			};
-			break;
+			return float(fat_id.get_poptype().id.index());
 		case pop_list_sort::size:
-			fn = [&](dcon::pop_id a, dcon::pop_id b) {
-				auto a_fat_id = dcon::fatten(state.world, a);
-				auto b_fat_id = dcon::fatten(state.world, b);
-				return a_fat_id.get_size() > b_fat_id.get_size();
-			};
-			break;
+			return -fat_id.get_size();
 		case pop_list_sort::con:
-			fn = [&](dcon::pop_id a, dcon::pop_id b) {
-				auto a_fat_id = dcon::fatten(state.world, a);
-				auto b_fat_id = dcon::fatten(state.world, b);
-				return a_fat_id.get_consciousness() > b_fat_id.get_consciousness();
-			};
-			break;
+			return -fat_id.get_consciousness();
 		case pop_list_sort::mil:
-			fn = [&](dcon::pop_id a, dcon::pop_id b) {
-				auto a_fat_id = dcon::fatten(state.world, a);
-				auto b_fat_id = dcon::fatten(state.world, b);
-				return a_fat_id.get_militancy() > b_fat_id.get_militancy();
-			};
-			break;
+			return -fat_id.get_militancy();
 		case pop_list_sort::religion:
-			fn = [&](dcon::pop_id a, dcon::pop_id b) {
-				auto a_fat_id = dcon::fatten(state.world, a);
-				auto b_fat_id = dcon::fatten(state.world, b);
-				return a_fat_id.get_religion().id.index() < b_fat_id.get_religion().id.index();
-			};
-			break;
+			return float(fat_id.get_religion().id.index());
 		case pop_list_sort::nationality:
-			fn = [&](dcon::pop_id a, dcon::pop_id b) {
-				auto a_fat_id = dcon::fatten(state.world, a);
-				auto b_fat_id = dcon::fatten(state.world, b);
-				return a_fat_id.get_culture().id.index() < b_fat_id.get_culture().id.index();
-			};
-			break;
+			return float(fat_id.get_culture().id.index());
 		case pop_list_sort::location:
-			fn = [&](dcon::pop_id a, dcon::pop_id b) {
-				auto a_fat_id = dcon::fatten(state.world, a);
-				auto b_fat_id = dcon::fatten(state.world, b);
-				return a_fat_id.get_pop_location_as_pop().id.index() < b_fat_id.get_pop_location_as_pop().id.index();
-			};
-			break;
+			return float(fat_id.get_pop_location_as_pop().id.index());
 		case pop_list_sort::cash:
-			fn = [&](dcon::pop_id a, dcon::pop_id b) {
-				auto a_fat_id = dcon::fatten(state.world, a);
-				auto b_fat_id = dcon::fatten(state.world, b);
-				return a_fat_id.get_savings() > b_fat_id.get_savings();
-			};
-			break;
+			return -fat_id.get_savings();
 		case pop_list_sort::unemployment:
-			fn = [&](dcon::pop_id a, dcon::pop_id b) {
-				auto a_fat_id = dcon::fatten(state.world, a);
-				auto b_fat_id = dcon::fatten(state.world, b);
-				return a_fat_id.get_employment() < b_fat_id.get_employment();
-			};
-			break;
+			return fat_id.get_employment();
 		case pop_list_sort::ideology:
-			fn = [&](dcon::pop_id a, dcon::pop_id b) {
-				auto a_fat_id = dcon::fatten(state.world, a);
-				auto b_fat_id = dcon::fatten(state.world, b);
-				return a_fat_id.get_dominant_ideology().id.index() < b_fat_id.get_dominant_ideology().id.index();
-			};
-			break;
+			return float(fat_id.get_dominant_ideology().id.index());
 		case pop_list_sort::issues:
-			fn = [&](dcon::pop_id a, dcon::pop_id b) {
-				auto a_fat_id = dcon::fatten(state.world, a);
-				auto b_fat_id = dcon::fatten(state.world, b);
-				return a_fat_id.get_dominant_issue_option().id.index() < b_fat_id.get_dominant_issue_option().id.index();
-			};
-			break;
+			return float(fat_id.get_dominant_issue_option().id.index());
 		case pop_list_sort::life_needs:
-			fn = [&](dcon::pop_id a, dcon::pop_id b) {
-				auto a_fat_id = dcon::fatten(state.world, a);
-				auto b_fat_id = dcon::fatten(state.world, b);
-				return a_fat_id.get_life_needs_satisfaction() > b_fat_id.get_life_needs_satisfaction();
-			};
-			break;
+			return -fat_id.get_life_needs_satisfaction();
 		case pop_list_sort::everyday_needs:
-			fn = [&](dcon::pop_id a, dcon::pop_id b) {
-				auto a_fat_id = dcon::fatten(state.world, a);
-				auto b_fat_id = dcon::fatten(state.world, b);
-				return a_fat_id.get_everyday_needs_satisfaction() > b_fat_id.get_everyday_needs_satisfaction();
-			};
-			break;
+			return -fat_id.get_everyday_needs_satisfaction();
 		case pop_list_sort::luxury_needs:
-			fn = [&](dcon::pop_id a, dcon::pop_id b) {
-				auto a_fat_id = dcon::fatten(state.world, a);
-				auto b_fat_id = dcon::fatten(state.world, b);
-				return a_fat_id.get_luxury_needs_satisfaction() > b_fat_id.get_luxury_needs_satisfaction();
-			};
-			break;
+			return -fat_id.get_luxury_needs_satisfaction();
 		case pop_list_sort::literacy:
-			fn = [&](dcon::pop_id a, dcon::pop_id b) {
-				auto a_fat_id = dcon::fatten(state.world, a);
-				auto b_fat_id = dcon::fatten(state.world, b);
-				return a_fat_id.get_literacy() > b_fat_id.get_literacy();
-			};
-			break;
+			return -fat_id.get_literacy();
 		// TODO: Implement revoltrisk and growth sorts
 		case pop_list_sort::revoltrisk:
 		case pop_list_sort::change:
-			fn = [&](dcon::pop_id a, dcon::pop_id b) {
-				auto a_fat_id = dcon::fatten(state.world, a);
-				auto b_fat_id = dcon::fatten(state.world, b);
-				return a_fat_id.id.index() < b_fat_id.id.index();
-			};
-			break;
-		}
-		std::stable_sort(country_pop_listbox->row_contents.begin(), country_pop_listbox->row_contents.end(),
-				[&](dcon::pop_id a, dcon::pop_id b) {
-					return fn(a, b);
-				});
-		if(!sort_ascend) {
-			std::reverse(country_pop_listbox->row_contents.begin(), country_pop_listbox->row_contents.end());
+			return float(p.index());
 		}
+		return 0.0f;
+	}
+
+	void sort_pop_list(sys::state& state) {
+		pop_list_model.update(uint32_t(sort), sort_ascend, [&](dcon::pop_id p) { return pop_sort_key(state, sort, p); },
+				country_pop_listbox->row_contents);
 	}
 
 	void populate_left_side_list(sys::state& state) {
@@ -146,6 +146,9 @@ static std::vector<scenario_file> scenario_files;
 static native_string selected_scenario_file;
 static uint32_t max_scenario_count = 0;
 static std::atomic<bool> file_is_ready = true;
+// set by -mapped, see sys::scenario_layout::mapped. Only this (Windows) launcher takes the option; the game entry points
+// load either layout, and the development scenario written by entry_point_win is always compressed
+static sys::scenario_layout new_scenario_layout = sys::scenario_layout::compressed;
 
 static int32_t frame_in_list = 0;
 
@@ -356,7 +359,7 @@ void make_mod_file() {
 
 		++max_scenario_count;
 		selected_scenario_file = base_name + NATIVE("-") + std::to_wstring(append) + NATIVE(".bin");
-		sys::write_scenario_file(*game_state, selected_scenario_file, max_scenario_count);
+		sys::write_scenario_file(*game_state, selected_scenario_file, max_scenario_count, new_scenario_layout);
 
 		if(!err.accumulated_errors.empty() || !err.accumulated_warnings.empty()) {
 			auto assembled_file = std::string("The following problems were encountered while creating the scenario:\r\n\r\nErrors:\r\n") + err.accumulated_errors + "\r\n\r\nWarnings:\r\n" + err.accumulated_warnings;
@@ -1472,9 +1475,12 @@ void EnableCrashingOnCrashes() {
 int WINAPI wWinMain(
 	HINSTANCE /*hInstance*/,
 	HINSTANCE /*hPrevInstance*/,
-	LPWSTR /*lpCmdLine*/,
+	LPWSTR lpCmdLine,
 	int /*nCmdShow*/
 ) {
+	if(lpCmdLine && std::wstring_view(lpCmdLine).find(L"-mapped") != std::wstring_view::npos)
+		launcher::new_scenario_layout = sys::scenario_layout::mapped;
+
 #ifdef _DEBUG
 	HeapSetInformation(NULL, HeapEnableTerminationOnCorruption, NULL, 0);
 #endif
@@ -1580,6 +1586,8 @@ int WINAPI wWinMain(
 #include "fonts.cpp"
 #include "texture.cpp"
 #include "text.cpp"
+#include "name_search.cpp"
+#include "ui_snapshot.cpp"
 #include "system_state.cpp"
 #include "parsers.cpp"
 #include "defines.cpp"
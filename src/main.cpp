@@ -8,6 +8,8 @@
 #include "float_from_chars.cpp"
 #include "gui_graphics_parsers.cpp"
 #include "text.cpp"
+#include "name_search.cpp"
+#include "ui_snapshot.cpp"
 #include "fonts.cpp"
 #include "texture.cpp"
 #include "nations_parsing.cpp"
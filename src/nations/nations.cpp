@@ -164,10 +164,65 @@ void restore_cached_values(sys::state& state) {
 	});
 }
 
+void restore_cached_values(sys::state& state, dcon::nation_id n) {
+	int32_t allies = 0;
+	for(auto dr : state.world.nation_get_diplomatic_relation(n)) {
+		if(dr.get_are_allied())
+			++allies;
+	}
+	state.world.nation_set_allies_count(n, uint16_t(allies));
+
+	int32_t total = 0;
+	int32_t substates_total = 0;
+	for(auto v : state.world.nation_get_overlord_as_ruler(n)) {
+		++total;
+		if(v.get_subject().get_is_substate())
+			++substates_total;
+	}
+	state.world.nation_set_vassals_count(n, uint16_t(total));
+	state.world.nation_set_substates_count(n, uint16_t(substates_total));
+}
+
+uint32_t verify_cached_values(sys::state& state) {
+	struct counts {
+		uint16_t allies = 0;
+		uint16_t vassals = 0;
+		uint16_t substates = 0;
+	};
+	std::vector<counts> incremental(state.world.nation_size());
+	for(auto n : state.world.in_nation)
+		incremental[n.id.index()] = counts{ n.get_allies_count(), n.get_vassals_count(), n.get_substates_count() };
+
+	restore_cached_values(state);
+
+	uint32_t mismatches = 0;
+	for(auto n : state.world.in_nation) {
+		auto& c = incremental[n.id.index()];
+		if(c.allies != n.get_allies_count() || c.vassals != n.get_vassals_count() || c.substates != n.get_substates_count())
+			++mismatches;
+	}
+	return mismatches;
+}
+
 void update_cached_values(sys::state& state) {
-	if(state.diplomatic_cached_values_out_of_date) {
-		state.diplomatic_cached_values_out_of_date = false;
-		restore_cached_values(state);
+	/*
+	Ally and vassal counts are otherwise kept up to date as relations change; only the nations that lost a relation when
+	another nation was removed (see cleanup_nation) need to be recounted.
+	*/
+	auto& stale = state.nations_with_stale_diplomatic_values;
+	if(stale.empty())
+		return;
+
+	std::sort(stale.begin(), stale.end(), [](dcon::nation_id a, dcon::nation_id b) { return a.index() < b.index(); });
+	stale.erase(std::unique(stale.begin(), stale.end()), stale.end());
+	for(auto n : stale) {
+		if(state.world.nation_is_valid(n))
+			restore_cached_values(state, n);
+	}
+	stale.clear();
+
+	if(state.verify_cached_values) {
+		state.cached_values_mismatches += verify_cached_values(state);
 	}
 }
 
@@ -439,28 +494,80 @@ float prestige_score(sys::state const& state, dcon::nation_id n) {
 				 state.world.nation_get_modifier_values(n, sys::national_mod_offsets::permanent_prestige);
 }
 
+/*
+The rankings are rebuilt daily from packed keys: each nation's sort key is computed once, the keys are laid out in the
+previous day's order, and an insertion pass then restores the ordering. Since ranks rarely change from one day to the
+next this is close to linear. Nations are ordered by tier (descending), then score (descending), then id (descending),
+which is a total order, so the result is the same as a full sort.
+*/
+struct rank_key {
+	float score = 0.0f;
+	uint32_t tier = 0;
+	dcon::nation_id n;
+};
+
+inline bool ranks_before(rank_key const& a, rank_key const& b) {
+	if(a.tier != b.tier)
+		return a.tier > b.tier;
+	if(a.score != b.score)
+		return a.score > b.score;
+	return a.n.index() > b.n.index();
+}
+
+inline void sort_rank_keys(std::vector<rank_key>& keys) {
+	for(size_t i = 1; i < keys.size(); ++i) {
+		if(!ranks_before(keys[i], keys[i - 1]))
+			continue;
+		auto k = keys[i];
+		size_t j = i;
+		do {
+			keys[j] = keys[j - 1];
+			--j;
+		} while(j > 0 && ranks_before(k, keys[j - 1]));
+		keys[j] = k;
+	}
+}
+
+/*
+Orders the nations accepted by included() by key_of() and writes them to the front of order, returning how many there
+are. The previous contents of order give the starting layout of the keys; nations that were not ranked before are
+appended in id order.
+*/
+template<typename P, typename K>
+uint32_t rerank(sys::state& state, std::vector<dcon::nation_id>& order, std::vector<rank_key>& keys, P&& included, K&& key_of) {
+	keys.clear();
+	std::vector<uint8_t> placed(state.world.nation_size(), 0);
+	auto add = [&](dcon::nation_id n) {
+		if(placed[n.index()] || !included(n))
+			return;
+		placed[n.index()] = 1;
+		keys.push_back(key_of(n));
+	};
+	for(auto n : order) {
+		if(n && uint32_t(n.index()) < state.world.nation_size())
+			add(n);
+	}
+	state.world.for_each_nation([&](dcon::nation_id n) { add(n); });
+	sort_rank_keys(keys);
+
+	for(uint32_t i = 0; i < keys.size(); ++i) {
+		order[i] = keys[i].n;
+	}
+	return uint32_t(keys.size());
+}
+
 void update_rankings(sys::state& state) {
-	uint32_t to_sort_count = 0;
-	state.world.for_each_nation([&](dcon::nation_id n) {
-		state.nations_by_rank[to_sort_count] = n;
-		++to_sort_count;
-	});
-	std::sort(state.nations_by_rank.begin(), state.nations_by_rank.begin() + to_sort_count,
-			[&](dcon::nation_id a, dcon::nation_id b) {
-				auto fa = fatten(state.world, a);
-				auto fb = fatten(state.world, b);
-				if((fa.get_owned_province_count() != 0) != (fb.get_owned_province_count() != 0)) {
-					return (fa.get_owned_province_count() != 0);
-				}
-				if(fa.get_is_civilized() != fb.get_is_civilized())
-					return fa.get_is_civilized();
-				if(bool(fa.get_overlord_as_subject().get_ruler()) != bool(fa.get_overlord_as_subject().get_ruler()))
-					return !bool(fa.get_overlord_as_subject().get_ruler());
-				auto a_score = fa.get_military_score() + fa.get_industrial_score() + prestige_score(state, a);
-				auto b_score = fb.get_military_score() + fb.get_industrial_score() + prestige_score(state, b);
-				if(a_score != b_score)
-					return a_score > b_score;
-				return a.index() > b.index(); // create a total order
+	/*
+	A subject is ranked like any other nation: the comparator this replaces tested the same nation's overlord on both
+	sides, so that check never decided anything.
+	*/
+	std::vector<rank_key> keys;
+	keys.reserve(state.world.nation_size());
+	uint32_t to_sort_count = rerank(state, state.nations_by_rank, keys, [](dcon::nation_id) { return true; },
+			[&](dcon::nation_id n) {
+				auto fn = fatten(state.world, n);
+				uint32_t tier = (fn.get_owned_province_count() != 0 ? 2 : 0) + (fn.get_is_civilized() ? 1 : 0);
+				return rank_key{fn.get_military_score() + fn.get_industrial_score() + prestige_score(state, n), tier, n};
 			});
 	if(to_sort_count < state.nations_by_rank.size()) {
 		state.nations_by_rank[to_sort_count] = dcon::nation_id{};
@@ -471,72 +578,27 @@ void update_rankings(sys::state& state) {
 }
 
 void update_ui_rankings(sys::state& state) {
-	uint32_t to_sort_count = 0;
-	state.world.for_each_nation([&](dcon::nation_id n) {
-		if(state.world.nation_get_owned_province_count(n) != 0) {
-			state.nations_by_industrial_score[to_sort_count] = n;
-			state.nations_by_military_score[to_sort_count] = n;
-			state.nations_by_prestige_score[to_sort_count] = n;
-			++to_sort_count;
-		}
+	std::vector<rank_key> keys;
+	keys.reserve(state.world.nation_size());
+	auto has_provinces = [&](dcon::nation_id n) { return state.world.nation_get_owned_province_count(n) != 0; };
+	auto tier_of = [&](dcon::nation_id n) { return state.world.nation_get_is_civilized(n) ? uint32_t(1) : uint32_t(0); };
+
+	uint32_t to_sort_count = rerank(state, state.nations_by_industrial_score, keys, has_provinces, [&](dcon::nation_id n) {
+		return rank_key{float(state.world.nation_get_industrial_score(n)), tier_of(n), n};
 	});
-	std::sort(state.nations_by_industrial_score.begin(), state.nations_by_industrial_score.begin() + to_sort_count,
-			[&](dcon::nation_id a, dcon::nation_id b) {
-				auto fa = fatten(state.world, a);
-				auto fb = fatten(state.world, b);
-				if(fa.get_is_civilized() && !fb.get_is_civilized())
-					return true;
-				if(!fa.get_is_civilized() && fb.get_is_civilized())
-					return false;
-				if(bool(fa.get_overlord_as_subject()) && !bool(fa.get_overlord_as_subject()))
-					return false;
-				if(!bool(fa.get_overlord_as_subject()) && bool(fa.get_overlord_as_subject()))
-					return true;
-				auto a_score = fa.get_industrial_score();
-				auto b_score = fb.get_industrial_score();
-				if(a_score != b_score)
-					return a_score > b_score;
-				return a.index() > b.index();
-			});
-	std::sort(state.nations_by_military_score.begin(), state.nations_by_military_score.begin() + to_sort_count,
-			[&](dcon::nation_id a, dcon::nation_id b) {
-				auto fa = fatten(state.world, a);
-				auto fb = fatten(state.world, b);
-				if(fa.get_is_civilized() && !fb.get_is_civilized())
-					return true;
-				if(!fa.get_is_civilized() && fb.get_is_civilized())
-					return false;
-				if(bool(fa.get_overlord_as_subject()) && !bool(fa.get_overlord_as_subject()))
-					return false;
-				if(!bool(fa.get_overlord_as_subject()) && bool(fa.get_overlord_as_subject()))
-					return true;
-				auto a_score = fa.get_military_score();
-				auto b_score = fb.get_military_score();
-				if(a_score != b_score)
-					return a_score > b_score;
-				return a.index() > b.index();
-			});
-	std::sort(state.nations_by_prestige_score.begin(), state.nations_by_prestige_score.begin() + to_sort_count,
-			[&](dcon::nation_id a, dcon::nation_id b) {
-				auto fa = fatten(state.world, a);
-				auto fb = fatten(state.world, b);
-				if(fa.get_is_civilized() && !fb.get_is_civilized())
-					return true;
-				if(!fa.get_is_civilized() && fb.get_is_civilized())
-					return false;
-				if(bool(fa.get_overlord_as_subject()) && !bool(fa.get_overlord_as_subject()))
-					return false;
-				if(!bool(fa.get_overlord_as_subject()) && bool(fa.get_overlord_as_subject()))
-					return true;
-				auto a_score = prestige_score(state, a);
-				auto b_score = prestige_score(state, b);
-				if(a_score != b_score)
-					return a_score > b_score;
-				return a.index() > b.index();
-			});
 	for(uint32_t i = 0; i < to_sort_count; ++i) {
 		state.world.nation_set_industrial_rank(state.nations_by_industrial_score[i], uint16_t(i + 1));
+	}
+	to_sort_count = rerank(state, state.nations_by_military_score, keys, has_provinces, [&](dcon::nation_id n) {
+		return rank_key{float(state.world.nation_get_military_score(n)), tier_of(n), n};
+	});
+	for(uint32_t i = 0; i < to_sort_count; ++i) {
 		state.world.nation_set_military_rank(state.nations_by_military_score[i], uint16_t(i + 1));
+	}
+	to_sort_count = rerank(state, state.nations_by_prestige_score, keys, has_provinces, [&](dcon::nation_id n) {
+		return rank_key{prestige_score(state, n), tier_of(n), n};
+	});
+	for(uint32_t i = 0; i < to_sort_count; ++i) {
 		state.world.nation_set_prestige_rank(state.nations_by_prestige_score[i], uint16_t(i + 1));
 	}
 }
@@ -906,9 +968,9 @@ bool has_decision_available(sys::state& state, dcon::nation_id n) {
 		dcon::decision_id did{dcon::decision_id::value_base_t(i)};
 		if(n != state.local_player_nation || !state.world.decision_get_hide_notification(did)) {
 			auto lim = state.world.decision_get_potential(did);
-			if(!lim || trigger::evaluate(state, lim, trigger::to_generic(n), trigger::to_generic(n), 0)) {
+			if(!lim || trigger::evaluate_memoized(state, lim, trigger::to_generic(n), trigger::to_generic(n), 0)) {
 				auto allow = state.world.decision_get_allow(did);
-				if(!allow || trigger::evaluate(state, allow, trigger::to_generic(n), trigger::to_generic(n), 0)) {
+				if(!allow || trigger::evaluate_memoized(state, allow, trigger::to_generic(n), trigger::to_generic(n), 0)) {
 					return true;
 				}
 			}
@@ -1296,9 +1358,16 @@ void cleanup_nation(sys::state& state, dcon::nation_id n) {
 		state.world.delete_movement((*movements.begin()).get_movement());
 	}
 
+	// deleting the nation drops its alliances without updating the partners' counts
+	for(auto dr : state.world.nation_get_diplomatic_relation(n)) {
+		if(dr.get_are_allied())
+			state.nations_with_stale_diplomatic_values.push_back(dr.get_related_nations(0) != n ? dr.get_related_nations(0) : dr.get_related_nations(1));
+	}
+
 	state.world.delete_nation(n);
 	auto new_ident_holder = state.world.create_nation();
 	state.world.try_create_identity_holder(new_ident_holder, old_ident);
+	state.nations_with_stale_diplomatic_values.push_back(new_ident_holder);
 
 	for(auto o : state.world.in_nation) {
 		if(o.get_in_sphere_of() == n) {
@@ -1307,7 +1376,6 @@ void cleanup_nation(sys::state& state, dcon::nation_id n) {
 	}
 
 	state.national_definitions.gc_pending = true;
-	state.diplomatic_cached_values_out_of_date = true; // refresh stored counts of allies, vassals, etc
 
 	if(n == state.local_player_nation) {
 		// Player was defeated, show end screen
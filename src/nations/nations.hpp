@@ -264,6 +264,7 @@ void update_research_points(sys::state& state);
 
 void update_industrial_scores(sys::state& state);
 void update_military_scores(sys::state& state);
+
 void update_rankings(sys::state& state);
 void update_ui_rankings(sys::state& state);
 
@@ -0,0 +1,107 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <algorithm>
+
+/*
+Rectangle packing for the texture atlases. The packer keeps the skyline of one page -- the height to which each run of
+columns is already filled -- and puts every new rectangle at the position where its top edge ends up lowest, taking the
+leftmost such position on ties. It never moves what it has already placed, so rectangles can be added one at a time as
+images arrive, and it does not depend on anything but the sequence of sizes it is given, so the same requests always
+produce the same layout. Rectangles of equal size, such as flags, fill a page in rows with no waste beyond the last column.
+*/
+
+namespace ogl {
+
+class skyline_packer {
+public:
+	struct placement {
+		int32_t x = 0;
+		int32_t y = 0;
+		bool placed = false;
+	};
+
+	skyline_packer(int32_t width, int32_t height) : width(width), height(height) {
+		clear();
+	}
+
+	void clear() {
+		skyline.clear();
+		skyline.push_back(segment{ 0, 0, width });
+		used_area = 0;
+	}
+
+	// returns placed == false if the rectangle does not fit anywhere in what is left of the page
+	placement insert(int32_t w, int32_t h) {
+		if(w <= 0 || h <= 0 || w > width || h > height)
+			return placement{};
+
+		size_t best = skyline.size();
+		int32_t best_y = 0;
+		for(size_t i = 0; i < skyline.size(); ++i) {
+			int32_t y = 0;
+			if(fits(i, w, h, y) && (best == skyline.size() || y < best_y))
+				best = i, best_y = y;
+		}
+		if(best == skyline.size())
+			return placement{};
+
+		auto x = skyline[best].x;
+		skyline.insert(skyline.begin() + best, segment{ x, best_y + h, w });
+		// the new segment covers the start of the ones after it
+		while(best + 1 < skyline.size() && skyline[best + 1].x < x + w) {
+			auto covered = x + w - skyline[best + 1].x;
+			if(covered < skyline[best + 1].width) {
+				skyline[best + 1].x += covered;
+				skyline[best + 1].width -= covered;
+				break;
+			}
+			skyline.erase(skyline.begin() + best + 1);
+		}
+		for(size_t i = 0; i + 1 < skyline.size();) {
+			if(skyline[i].y == skyline[i + 1].y) {
+				skyline[i].width += skyline[i + 1].width;
+				skyline.erase(skyline.begin() + i + 1);
+			} else {
+				++i;
+			}
+		}
+
+		used_area += int64_t(w) * int64_t(h);
+		return placement{ x, best_y, true };
+	}
+
+	int64_t used() const {
+		return used_area;
+	}
+	float occupancy() const {
+		return float(double(used_area) / (double(width) * double(height)));
+	}
+
+private:
+	struct segment {
+		int32_t x = 0;
+		int32_t y = 0;
+		int32_t width = 0;
+	};
+
+	// whether a w by h rectangle with its left edge at segment i fits, and if so the height it would rest at
+	bool fits(size_t i, int32_t w, int32_t h, int32_t& y) const {
+		if(skyline[i].x + w > width)
+			return false;
+		y = 0;
+		for(int32_t remaining = w; remaining > 0; remaining -= skyline[i].width, ++i) {
+			y = std::max(y, skyline[i].y);
+			if(y + h > height)
+				return false;
+		}
+		return true;
+	}
+
+	std::vector<segment> skyline; // ordered by x, covering [0, width) without gaps
+	int64_t used_area = 0;
+	int32_t width = 0;
+	int32_t height = 0;
+};
+
+} // namespace ogl
@@ -307,9 +307,11 @@ void initialize_opengl(sys::state& state) {
 		state.flag_type_map[uint32_t(type)] = uint8_t(id++);
 	assert(state.flag_type_map[0] == 0); // default_flag
 
-	// Allocate textures for the flags
-	state.open_gl.asset_textures.resize(
-			state.ui_defs.textures.size() + (state.world.national_identity_size() + 1) * state.flag_types.size());
+	// Allocate the textures, and the atlas entries for the flags
+	state.open_gl.asset_textures.resize(state.ui_defs.textures.size());
+	state.open_gl.flags.resize(dcon::texture_id{dcon::texture_id::value_base_t(state.ui_defs.textures.size())},
+			uint32_t((state.world.national_identity_size() + 1) * state.flag_types.size()));
+	state.open_gl.loader.start(state.common_fs, &state.open_gl.flags);
 
 	state.map_state.load_map(state);
 
@@ -560,6 +562,49 @@ void render_masked_rect(sys::state const& state, color_modification enabled, flo
 	glDrawArrays(GL_TRIANGLE_FAN, 0, 4);
 }
 
+void render_masked_flag(sys::state const& state, color_modification enabled, float x, float y, float width, float height,
+		dcon::texture_id flag, GLuint mask_texture_handle, ui::rotation r, bool flipped) {
+	if(!state.open_gl.flags.contains(flag))
+		return;
+	auto const& e = state.open_gl.flags[flag];
+	if(!e.ready)
+		return;
+	if(e.layer < 0) {
+		if(e.own_texture && mask_texture_handle)
+			render_masked_rect(state, enabled, x, y, width, height, e.own_texture, mask_texture_handle, r, flipped);
+		else if(e.own_texture)
+			render_textured_rect(state, enabled, x, y, width, height, e.own_texture, r, flipped);
+		return;
+	}
+
+	glBindVertexArray(state.open_gl.global_square_vao);
+
+	bind_vertices_by_rotation(state, r, flipped);
+
+	glUniform4f(parameters::drawing_rectangle, x, y, width, height);
+	glUniform4f(parameters::subrect, e.u0, e.u1 - e.u0, e.v0, e.v1 - e.v0);
+	glUniform1f(parameters::atlas_layer, float(e.layer));
+
+	glActiveTexture(GL_TEXTURE2);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, state.open_gl.flags.handle());
+	if(mask_texture_handle) {
+		glActiveTexture(GL_TEXTURE1);
+		glBindTexture(GL_TEXTURE_2D, mask_texture_handle);
+	}
+	glActiveTexture(GL_TEXTURE0);
+
+	GLuint subroutines[2] = {map_color_modification_to_index(enabled),
+			mask_texture_handle ? parameters::atlas_use_mask : parameters::atlas_no_filter};
+	glUniformSubroutinesuiv(GL_FRAGMENT_SHADER, 2, subroutines); // must set all subroutines in one call
+
+	glDrawArrays(GL_TRIANGLE_FAN, 0, 4);
+}
+
+void render_flag(sys::state const& state, color_modification enabled, float x, float y, float width, float height,
+		dcon::texture_id flag, ui::rotation r, bool flipped) {
+	render_masked_flag(state, enabled, x, y, width, height, flag, 0, r, flipped);
+}
+
 void render_progress_bar(sys::state const& state, color_modification enabled, float progress, float x, float y, float width,
 		float height, GLuint left_texture_handle, GLuint right_texture_handle, ui::rotation r, bool flipped) {
 	glBindVertexArray(state.open_gl.global_square_vao);
@@ -656,7 +701,7 @@ void render_character(sys::state const& state, char codepoint, color_modificatio
 	}
 }
 
-GLuint get_flag_texture_handle_from_tag(sys::state& state, char tag[3]) {
+dcon::texture_id get_flag_texture_from_tag(sys::state& state, char tag[3]) {
 	tag[0] = char(toupper(tag[0]));
 	tag[1] = char(toupper(tag[1]));
 	tag[2] = char(toupper(tag[2]));
@@ -670,7 +715,7 @@ GLuint get_flag_texture_handle_from_tag(sys::state& state, char tag[3]) {
 	});
 	if(!bool(ident)) {
 		// QOL: We will print the text instead of displaying the flag, for ease of viewing invalid tags
-		return 0;
+		return dcon::texture_id{};
 	}
 	auto fat_id = dcon::fatten(state.world, ident);
 	auto nation = fat_id.get_nation_from_identity_holder();
@@ -680,7 +725,7 @@ GLuint get_flag_texture_handle_from_tag(sys::state& state, char tag[3]) {
 	} else {
 		flag_type = culture::get_current_flag_type(state, ident);
 	}
-	return ogl::get_flag_handle(state, ident, flag_type);
+	return ogl::get_flag_texture(state, ident, flag_type);
 }
 
 bool display_tag_is_valid(sys::state& state, char tag[3]) {
@@ -696,8 +741,8 @@ bool display_tag_is_valid(sys::state& state, char tag[3]) {
 	return bool(ident);
 }
 
-void internal_text_render(sys::state& state, char const* codepoints, uint32_t count, float x, float baseline_y, float size,
-		text::font& f, GLuint const* subroutines, GLuint const* icon_subroutines) {
+void internal_text_render(sys::state& state, char const* codepoints, uint32_t count, color_modification enabled, float x,
+		float baseline_y, float size, text::font& f, GLuint const* subroutines, GLuint const* icon_subroutines) {
 	for(uint32_t i = 0; i < count; ++i) {
 		if(text::win1250toUTF16(codepoints[i]) != ' ') {
 			// f.make_glyph(codepoints[i]);
@@ -706,17 +751,10 @@ void internal_text_render(sys::state& state, char const* codepoints, uint32_t co
 				tag[0] = (i + 1 < count) ? char(codepoints[i + 1]) : 0;
 				tag[1] = (i + 2 < count) ? char(codepoints[i + 2]) : 0;
 				tag[2] = (i + 3 < count) ? char(codepoints[i + 3]) : 0;
-				GLuint flag_texture_handle = get_flag_texture_handle_from_tag(state, tag);
-				if(flag_texture_handle != 0) {
-					bind_vertices_by_rotation(state, ui::rotation::upright, false);
-					glActiveTexture(GL_TEXTURE0);
-					glUniformSubroutinesuiv(GL_FRAGMENT_SHADER, 2, icon_subroutines);
-					glBindTexture(GL_TEXTURE_2D, flag_texture_handle);
-					glUniform4f(parameters::drawing_rectangle, x,
-							baseline_y + f.glyph_positions[0x4D].y * size / 64.0f, size * 1.5f, size);
-					glUniform4f(ogl::parameters::subrect, 0.f /* x offset */, 1.f /* x width */, 0.f /* y offset */, 1.f /* y height */
-					);
-					glDrawArrays(GL_TRIANGLE_FAN, 0, 4);
+				auto flag = get_flag_texture_from_tag(state, tag);
+				if(flag) {
+					render_flag(state, enabled, x, baseline_y + f.glyph_positions[0x4D].y * size / 64.0f, size * 1.5f, size, flag,
+							ui::rotation::upright, false);
 					glUniformSubroutinesuiv(GL_FRAGMENT_SHADER, 2, subroutines);
 
 					x += size * 1.5f;
@@ -776,7 +814,7 @@ void render_new_text(sys::state& state, char const* codepoints, uint32_t count,
 	GLuint subroutines[2] = {map_color_modification_to_index(enabled), parameters::filter};
 	GLuint icon_subroutines[2] = {map_color_modification_to_index(enabled), parameters::no_filter};
 	glUniformSubroutinesuiv(GL_FRAGMENT_SHADER, 2, subroutines);
-	internal_text_render(state, codepoints, count, x, y + size, size, f, subroutines, icon_subroutines);
+	internal_text_render(state, codepoints, count, enabled, x, y + size, size, f, subroutines, icon_subroutines);
 }
 
 void render_classic_text(sys::state& state, float x, float y, char const* codepoints, uint32_t count,
@@ -811,26 +849,19 @@ void render_classic_text(sys::state& state, float x, float y, char const* codepo
 			tag[0] = (i + 1 < count) ? char(codepoints[i + 1]) : 0;
 			tag[1] = (i + 2 < count) ? char(codepoints[i + 2]) : 0;
 			tag[2] = (i + 3 < count) ? char(codepoints[i + 3]) : 0;
-			GLuint flag_texture_handle = get_flag_texture_handle_from_tag(state, tag);
-			if(flag_texture_handle != 0) {
-				GLuint flag_subroutines[2] = {map_color_modification_to_index(enabled), parameters::no_filter};
-				glUniformSubroutinesuiv(GL_FRAGMENT_SHADER, 2, flag_subroutines);
+			auto flag = get_flag_texture_from_tag(state, tag);
+			if(flag) {
 				f = font.chars[0x4D];
 				float scaling = uint8_t(codepoints[i]) == 0xA4 ? 1.5f : 1.f;
 				float offset = uint8_t(codepoints[i]) == 0xA4 ? 0.25f : 0.f;
 				float CurX = x + f.x_offset - (float(f.width) * offset);
 				float CurY = y + f.y_offset - (float(f.height) * offset);
-				glUniform4f(ogl::parameters::drawing_rectangle, CurX, CurY, float(f.height) * 1.5f * scaling, float(f.height) * scaling);
-				glBindTexture(GL_TEXTURE_2D, flag_texture_handle);
-				glUniform3f(parameters::inner_color, c.r, c.g, c.b);
-				glUniform4f(ogl::parameters::subrect, float(f.x) / float(font.width) /* x offset */,
-						float(f.width) / float(font.width) /* x width */, float(f.y) / float(font.width) /* y offset */,
-						float(f.height) / float(font.width) /* y height */
-				);
-				glDrawArrays(GL_TRIANGLE_FAN, 0, 4);
-				// Restore affected state
-				glBindTexture(GL_TEXTURE_2D, font.ftexid);
+				render_flag(state, enabled, CurX, CurY, float(f.height) * 1.5f * scaling, float(f.height) * scaling, flag,
+						ui::rotation::upright, false);
+				// Restore affected state; a flag kept outside the atlas binds its own texture to unit 0
 				glUniformSubroutinesuiv(GL_FRAGMENT_SHADER, 2, subroutines);
+				glActiveTexture(GL_TEXTURE0);
+				glBindTexture(GL_TEXTURE_2D, font.ftexid);
 
 				x += f.x_offset - (float(f.width) * offset) + float(f.height) * 1.5f * scaling;
 
@@ -22,6 +22,7 @@ inline constexpr GLuint drawing_rectangle = 2;
 inline constexpr GLuint border_size = 6;
 inline constexpr GLuint inner_color = 7;
 inline constexpr GLuint subrect = 10;
+inline constexpr GLuint atlas_layer = 12;
 
 inline constexpr GLuint enabled = 4;
 inline constexpr GLuint disabled = 3;
@@ -40,6 +41,8 @@ inline constexpr GLuint interactable = 13;
 inline constexpr GLuint interactable_disabled = 14;
 inline constexpr GLuint subsprite_b = 15;
 inline constexpr GLuint alternate_tint = 16;
+inline constexpr GLuint atlas_no_filter = 17;
+inline constexpr GLuint atlas_use_mask = 18;
 } // namespace parameters
 
 enum class color_modification { none, disabled, interactable, interactable_disabled };
@@ -144,6 +147,8 @@ inline void debug_callback(GLenum source, GLenum type, GLuint id, GLenum severit
 
 struct data {
 	tagged_vector<texture, dcon::texture_id> asset_textures;
+	flag_atlas flags;
+	texture_loader loader;
 
 	void* context = nullptr;
 	GLuint ui_shader_program = 0;
@@ -233,6 +238,11 @@ void render_bordered_rect(sys::state const& state, color_modification enabled, f
 		float height, GLuint texture_handle, ui::rotation r, bool flipped);
 void render_masked_rect(sys::state const& state, color_modification enabled, float x, float y, float width, float height,
 		GLuint texture_handle, GLuint mask_texture_handle, ui::rotation r, bool flipped);
+// flags are drawn from the flag atlas; nothing is drawn while the flag is still loading
+void render_flag(sys::state const& state, color_modification enabled, float x, float y, float width, float height,
+		dcon::texture_id flag, ui::rotation r, bool flipped);
+void render_masked_flag(sys::state const& state, color_modification enabled, float x, float y, float width, float height,
+		dcon::texture_id flag, GLuint mask_texture_handle, ui::rotation r, bool flipped);
 void render_progress_bar(sys::state const& state, color_modification enabled, float progress, float x, float y, float width,
 		float height, GLuint left_texture_handle, GLuint right_texture_handle, ui::rotation r, bool flipped);
 void render_tinted_textured_rect(sys::state const& state, float x, float y, float width, float height, float r, float g, float b,
@@ -21,5 +21,7 @@ void create_opengl_context(sys::state& state) {
 #endif
 }
 
-void shutdown_opengl(sys::state& state) { }
+void shutdown_opengl(sys::state& state) {
+	state.open_gl.loader.stop();
+}
 } // namespace ogl
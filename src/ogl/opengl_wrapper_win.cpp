@@ -80,6 +80,7 @@ void create_opengl_context(sys::state& state) {
 
 void shutdown_opengl(sys::state& state) {
 	assert(state.win_ptr && state.win_ptr->hwnd && state.open_gl.context);
+	state.open_gl.loader.stop();
 	wglMakeCurrent(state.win_ptr->opengl_window_dc, nullptr);
 	wglDeleteContext(HGLRC(state.open_gl.context));
 	state.open_gl.context = nullptr;
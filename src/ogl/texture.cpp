@@ -97,42 +97,33 @@ typedef struct {
 	unsigned int dwReserved2;
 } DDS_header;
 
-unsigned int SOIL_direct_load_DDS_from_memory(unsigned char const* const buffer, unsigned int buffer_length, unsigned int& width,
-		unsigned int& height, int flags) {
-	/*	variables	*/
+void image_data_deleter::operator()(uint8_t* data) const noexcept {
+	STBI_FREE(data);
+}
+
+decoded_image decode_dds(uint8_t const* file_data, uint32_t file_size) {
+	decoded_image result;
+
 	DDS_header header;
-	unsigned int buffer_index = 0;
-	unsigned int tex_ID = 0;
-	/*	file reading variables	*/
-	unsigned int S3TC_type = 0;
-	unsigned char* DDS_data;
-	unsigned int DDS_main_size;
-	unsigned int DDS_full_size;
-	int mipmaps, cubemap, uncompressed, block_size = 16;
-	unsigned int flag;
-	unsigned int cf_target, ogl_target_start, ogl_target_end;
-	unsigned int opengl_texture_type;
-	int i;
-
-	if(buffer_length < sizeof(DDS_header)) {
-		return 0;
+	if(file_size < sizeof(DDS_header)) {
+		return result;
 	}
 	/*	try reading in the header	*/
-	memcpy((void*)(&header), (void const*)buffer, sizeof(DDS_header));
-	buffer_index = sizeof(DDS_header);
+	memcpy((void*)(&header), (void const*)file_data, sizeof(DDS_header));
+	uint32_t buffer_index = sizeof(DDS_header);
 
-	/*	validate the header (warning, "goto"'s ahead, shield your eyes!!)	*/
-	flag = ('D' << 0) | ('D' << 8) | ('S' << 16) | (' ' << 24);
+	/*	validate the header	*/
+	unsigned int flag = ('D' << 0) | ('D' << 8) | ('S' << 16) | (' ' << 24);
 	if(header.dwMagic != flag) {
-		goto quick_exit;
+		return result;
 	}
 	if(header.dwSize != 124) {
-		goto quick_exit;
+		return result;
 	}
 	/*	I need all of these	*/
 	flag = ALICE_DDSD_CAPS | ALICE_DDSD_HEIGHT | ALICE_DDSD_WIDTH | ALICE_DDSD_PIXELFORMAT;
 	if((header.dwFlags & flag) != flag) {
-		goto quick_exit;
+		return result;
 	}
 	/*	According to the MSDN spec, the dwFlags should contain
 		ALICE_DDSD_LINEARSIZE if it's compressed, or ALICE_DDSD_PITCH if
@@ -141,178 +132,238 @@ unsigned int SOIL_direct_load_DDS_from_memory(unsigned char const* const buffer,
 	/*	I need one of these	*/
 	flag = ALICE_DDPF_FOURCC | ALICE_DDPF_RGB;
 	if((header.sPixelFormat.dwFlags & flag) == 0) {
-		goto quick_exit;
+		return result;
 	}
 	if(header.sPixelFormat.dwSize != 32) {
-		goto quick_exit;
+		return result;
 	}
 	if((header.sCaps.dwCaps1 & ALICE_DDSCAPS_TEXTURE) == 0) {
-		goto quick_exit;
+		return result;
 	}
 	/*	make sure it is a type we can upload	*/
 	if((header.sPixelFormat.dwFlags & ALICE_DDPF_FOURCC) &&
 			!((header.sPixelFormat.dwFourCC == (('D' << 0) | ('X' << 8) | ('T' << 16) | ('1' << 24))) ||
 					(header.sPixelFormat.dwFourCC == (('D' << 0) | ('X' << 8) | ('T' << 16) | ('3' << 24))) ||
 					(header.sPixelFormat.dwFourCC == (('D' << 0) | ('X' << 8) | ('T' << 16) | ('5' << 24))))) {
-		goto quick_exit;
+		return result;
+	}
+	/*	cube maps are not supported	*/
+	if((header.sCaps.dwCaps2 & ALICE_DDSCAPS2_CUBEMAP) != 0) {
+		return result;
 	}
+
 	/*	OK, validated the header, let's load the image data	*/
-	width = header.dwWidth;
-	height = header.dwHeight;
-	uncompressed = 1 - (header.sPixelFormat.dwFlags & ALICE_DDPF_FOURCC) / ALICE_DDPF_FOURCC;
-	cubemap = (header.sCaps.dwCaps2 & ALICE_DDSCAPS2_CUBEMAP) / ALICE_DDSCAPS2_CUBEMAP;
+	uint32_t width = header.dwWidth;
+	uint32_t height = header.dwHeight;
+	bool uncompressed = (header.sPixelFormat.dwFlags & ALICE_DDPF_FOURCC) == 0;
+	uint32_t gl_format = 0;
+	int32_t block_size = 16;
+	uint32_t main_size = 0;
 	if(uncompressed) {
-		S3TC_type = GL_RGB;
+		gl_format = GL_RGB;
 		block_size = 3;
 		if(header.sPixelFormat.dwFlags & ALICE_DDPF_ALPHAPIXELS) {
-			S3TC_type = GL_RGBA;
+			gl_format = GL_RGBA;
 			block_size = 4;
 		}
-		DDS_main_size = width * height * block_size;
+		main_size = width * height * block_size;
 	} else {
-		/*	can we even handle direct uploading to OpenGL DXT compressed images?	*/
-		//
-		// TODO: properly restore this check
-		//
-
-		// if(query_DXT_capability() != SOIL_CAPABILITY_PRESENT) {
-		//	return 0;
-		// }
 		/*	well, we know it is DXT1/3/5, because we checked above	*/
 		switch((header.sPixelFormat.dwFourCC >> 24) - '0') {
 		case 1:
-			S3TC_type = SOIL_RGBA_S3TC_DXT1;
+			gl_format = SOIL_RGBA_S3TC_DXT1;
 			block_size = 8;
 			break;
 		case 3:
-			S3TC_type = SOIL_RGBA_S3TC_DXT3;
+			gl_format = SOIL_RGBA_S3TC_DXT3;
 			block_size = 16;
 			break;
 		case 5:
-			S3TC_type = SOIL_RGBA_S3TC_DXT5;
+			gl_format = SOIL_RGBA_S3TC_DXT5;
 			block_size = 16;
 			break;
 		}
-		DDS_main_size = ((width + 3) >> 2) * ((height + 3) >> 2) * block_size;
-	}
-	if(cubemap) {
-		return 0;
-	} else {
-		ogl_target_start = GL_TEXTURE_2D;
-		ogl_target_end = GL_TEXTURE_2D;
-		opengl_texture_type = GL_TEXTURE_2D;
+		main_size = ((width + 3) >> 2) * ((height + 3) >> 2) * block_size;
 	}
+
+	int32_t mipmaps = 0;
+	uint32_t full_size = main_size;
 	if((header.sCaps.dwCaps1 & ALICE_DDSCAPS_MIPMAP) != 0 && (header.dwMipMapCount > 1)) {
 		mipmaps = header.dwMipMapCount - 1;
-		DDS_full_size = DDS_main_size;
-		for(i = 1; i <= mipmaps; ++i) {
-			int w, h;
-			w = width >> i;
-			h = height >> i;
-			if(w < 1) {
-				w = 1;
-			}
-			if(h < 1) {
-				h = 1;
-			}
+		for(int32_t i = 1; i <= mipmaps; ++i) {
+			uint32_t w = std::max(width >> i, 1u);
+			uint32_t h = std::max(height >> i, 1u);
 			if(uncompressed) {
 				/*	uncompressed DDS, simple MIPmap size calculation	*/
-				DDS_full_size += w * h * block_size;
+				full_size += w * h * block_size;
 			} else {
 				/*	compressed DDS, MIPmap size calculation is block based	*/
-				DDS_full_size += ((w + 3) / 4) * ((h + 3) / 4) * block_size;
+				full_size += ((w + 3) / 4) * ((h + 3) / 4) * block_size;
 			}
 		}
-	} else {
-		mipmaps = 0;
-		DDS_full_size = DDS_main_size;
-	}
-	DDS_data = (unsigned char*)malloc(DDS_full_size);
-	/*	got the image data RAM, create or use an existing OpenGL texture handle	*/
-
-	glGenTextures(1, &tex_ID);
-	/*  bind an OpenGL texture ID	*/
-	glBindTexture(opengl_texture_type, tex_ID);
-	if(tex_ID) {
-		/*	did I have MIPmaps?	*/
-		if(mipmaps > 0 || (flags & SOIL_FLAG_MIPMAPS)) {
-			/*	instruct OpenGL to use the MIPmaps	*/
-			glTexParameteri(opengl_texture_type, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-			glTexParameteri(opengl_texture_type, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_NEAREST);
-		} else {
-			/*	instruct OpenGL _NOT_ to use the MIPmaps	*/
-			glTexParameteri(opengl_texture_type, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-			glTexParameteri(opengl_texture_type, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	}
+	if(buffer_index + full_size > file_size) {
+		return result;
+	}
+
+	result.data = image_data(static_cast<uint8_t*>(STBI_MALLOC(full_size)));
+	memcpy(result.data.get(), file_data + buffer_index, full_size);
+	if(uncompressed) {
+		/*	and remember, DXT uncompressed uses BGR(A),
+			so swap to RGB(A) for ALL MIPmap levels	*/
+		auto* pixels = result.data.get();
+		for(uint32_t i = 0; i + 2 < full_size; i += block_size) {
+			std::swap(pixels[i], pixels[i + 2]);
 		}
-		/*	does the user want clamping, or wrapping?	*/
-		if(flags & SOIL_FLAG_TEXTURE_REPEATS) {
-			glTexParameteri(opengl_texture_type, GL_TEXTURE_WRAP_S, GL_REPEAT);
-			glTexParameteri(opengl_texture_type, GL_TEXTURE_WRAP_T, GL_REPEAT);
-			glTexParameteri(opengl_texture_type, SOIL_TEXTURE_WRAP_R, GL_REPEAT);
-		} else {
-			unsigned int clamp_mode = GL_CLAMP_TO_EDGE;
-			/* unsigned int clamp_mode = GL_CLAMP; */
-			glTexParameteri(opengl_texture_type, GL_TEXTURE_WRAP_S, clamp_mode);
-			glTexParameteri(opengl_texture_type, GL_TEXTURE_WRAP_T, clamp_mode);
-			glTexParameteri(opengl_texture_type, SOIL_TEXTURE_WRAP_R, clamp_mode);
+	}
+
+	result.data_size = full_size;
+	result.size_x = int32_t(width);
+	result.size_y = int32_t(height);
+	result.gl_format = gl_format;
+	result.block_size = block_size;
+	result.mipmaps = mipmaps;
+	result.type = uncompressed ? decoded_image::format::dds_uncompressed : decoded_image::format::dds_compressed;
+	return result;
+}
+
+decoded_image decode_image(uint8_t const* file_data, uint32_t file_size) {
+	decoded_image result;
+	int32_t file_channels = 4;
+	result.data = image_data(stbi_load_from_memory(file_data, int32_t(file_size), &result.size_x, &result.size_y, &file_channels, 4));
+	if(result.data) {
+		result.data_size = uint32_t(result.size_x * result.size_y * 4);
+		result.gl_format = GL_RGBA;
+		result.type = decoded_image::format::rgba;
+	}
+	return result;
+}
+
+decoded_image read_image(native_string const& native_name, simple_fs::file_system const& fs) {
+	auto name_length = native_name.length();
+
+	auto root = get_root(fs);
+	if(name_length > 4) { // try loading as a dds
+		auto dds_name = native_name.substr(0, name_length - 3) + NATIVE("dds");
+		auto file = open_file(root, dds_name);
+		if(file) {
+			auto content = simple_fs::view_contents(*file);
+			auto result = decode_dds(reinterpret_cast<uint8_t const*>(content.data), content.file_size);
+			if(result.type != decoded_image::format::none)
+				return result;
 		}
 	}
 
-	/*	do this for each face of the cubemap!	*/
-	for(cf_target = ogl_target_start; cf_target <= ogl_target_end; ++cf_target) {
-		if(buffer_index + DDS_full_size <= (unsigned int)buffer_length) {
-			unsigned int byte_offset = DDS_main_size;
-			memcpy((void*)DDS_data, (void const*)(&buffer[buffer_index]), DDS_full_size);
-			buffer_index += DDS_full_size;
-			/*	upload the main chunk	*/
-			if(uncompressed) {
-				/*	and remember, DXT uncompressed uses BGR(A),
-					so swap to RGB(A) for ALL MIPmap levels	*/
-				for(i = 0; i < (int)DDS_full_size; i += block_size) {
-					unsigned char temp = DDS_data[i];
-					DDS_data[i] = DDS_data[i + 2];
-					DDS_data[i + 2] = temp;
-				}
-				glTexImage2D(cf_target, 0, S3TC_type, width, height, 0, S3TC_type, GL_UNSIGNED_BYTE, DDS_data);
-			} else {
-				glCompressedTexImage2D(cf_target, 0, S3TC_type, width, height, 0, DDS_main_size, DDS_data);
-			}
-			/*	upload the mipmaps, if we have them	*/
-			for(i = 1; i <= mipmaps; ++i) {
-				int w, h, mip_size;
-				w = width >> i;
-				h = height >> i;
-				if(w < 1) {
-					w = 1;
-				}
-				if(h < 1) {
-					h = 1;
-				}
-				/*	upload this mipmap	*/
-				if(uncompressed) {
-					mip_size = w * h * block_size;
-					glTexImage2D(cf_target, i, S3TC_type, w, h, 0, S3TC_type, GL_UNSIGNED_BYTE, &DDS_data[byte_offset]);
-				} else {
-					mip_size = ((w + 3) / 4) * ((h + 3) / 4) * block_size;
-					glCompressedTexImage2D(cf_target, i, S3TC_type, w, h, 0, mip_size, &DDS_data[byte_offset]);
-				}
-				/*	and move to the next mipmap	*/
-				byte_offset += mip_size;
-			}
+	auto file = open_file(root, native_name);
+	if(file) {
+		auto content = simple_fs::view_contents(*file);
+		return decode_image(reinterpret_cast<uint8_t const*>(content.data), content.file_size);
+	}
+	return decoded_image{};
+}
+
+GLuint upload_image(decoded_image const& image, GLuint handle, int flags) {
+	if(image.type == decoded_image::format::none)
+		return 0;
+
+	if(handle == 0)
+		glGenTextures(1, &handle);
+	if(handle == 0)
+		return 0;
+	glBindTexture(GL_TEXTURE_2D, handle);
+
+	if(image.type == decoded_image::format::rgba) {
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, image.size_x, image.size_y, 0, GL_RGBA, GL_UNSIGNED_BYTE, image.data.get());
+
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+		glBindTexture(GL_TEXTURE_2D, 0);
+		return handle;
+	}
+
+	/*	did I have MIPmaps?	*/
+	if(image.mipmaps > 0 || (flags & SOIL_FLAG_MIPMAPS)) {
+		/*	instruct OpenGL to use the MIPmaps	*/
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_NEAREST);
+	} else {
+		/*	instruct OpenGL _NOT_ to use the MIPmaps	*/
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	}
+	/*	does the user want clamping, or wrapping?	*/
+	if(flags & SOIL_FLAG_TEXTURE_REPEATS) {
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+		glTexParameteri(GL_TEXTURE_2D, SOIL_TEXTURE_WRAP_R, GL_REPEAT);
+	} else {
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, SOIL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+	}
+
+	bool uncompressed = image.type == decoded_image::format::dds_uncompressed;
+	uint32_t byte_offset = 0;
+	for(int32_t i = 0; i <= image.mipmaps; ++i) {
+		int32_t w = std::max(image.size_x >> i, 1);
+		int32_t h = std::max(image.size_y >> i, 1);
+		if(uncompressed) {
+			glTexImage2D(GL_TEXTURE_2D, i, image.gl_format, w, h, 0, image.gl_format, GL_UNSIGNED_BYTE, image.data.get() + byte_offset);
+			byte_offset += uint32_t(w * h * image.block_size);
 		} else {
-			glDeleteTextures(1, &tex_ID);
-			tex_ID = 0;
-			cf_target = ogl_target_end + 1;
+			int32_t level_size = ((w + 3) / 4) * ((h + 3) / 4) * image.block_size;
+			glCompressedTexImage2D(GL_TEXTURE_2D, i, image.gl_format, w, h, 0, level_size, image.data.get() + byte_offset);
+			byte_offset += uint32_t(level_size);
 		}
-	} /* end reading each face */
-	free(DDS_data);
+	}
 
 	if(flags & SOIL_FLAG_MIPMAPS)
-		glGenerateMipmap(opengl_texture_type);
+		glGenerateMipmap(GL_TEXTURE_2D);
+
+	return handle;
+}
+
+bool expand_to_rgba(decoded_image& image) {
+	if(image.type == decoded_image::format::rgba)
+		return true;
+	if(image.type != decoded_image::format::dds_uncompressed || (image.block_size != 3 && image.block_size != 4))
+		return false;
+
+	auto pixels = uint32_t(image.size_x) * uint32_t(image.size_y);
+	if(image.block_size == 3) {
+		image_data expanded{ static_cast<uint8_t*>(STBI_MALLOC(pixels * 4)) };
+		if(!expanded)
+			return false;
+		auto const* from = image.data.get();
+		auto* to = expanded.get();
+		for(uint32_t i = 0; i < pixels; ++i) {
+			to[i * 4 + 0] = from[i * 3 + 0];
+			to[i * 4 + 1] = from[i * 3 + 1];
+			to[i * 4 + 2] = from[i * 3 + 2];
+			to[i * 4 + 3] = 255;
+		}
+		image.data = std::move(expanded);
+	}
+	// the mipmaps, if any, are left in place after the first level and ignored
+	image.data_size = pixels * 4;
+	image.gl_format = GL_RGBA;
+	image.block_size = 4;
+	image.mipmaps = 0;
+	image.type = decoded_image::format::rgba;
+	return true;
+}
 
-quick_exit:
-	/*	report success or failure	*/
-	return tex_ID;
+unsigned int SOIL_direct_load_DDS_from_memory(unsigned char const* const buffer, unsigned int buffer_length, unsigned int& width,
+		unsigned int& height, int flags) {
+	auto image = decode_dds(buffer, buffer_length);
+	if(image.type == decoded_image::format::none)
+		return 0;
+	width = uint32_t(image.size_x);
+	height = uint32_t(image.size_y);
+	return upload_image(image, 0, flags);
 }
 
 texture::~texture() {
@@ -346,203 +397,367 @@ GLuint texture::get_texture_handle() const {
 	return texture_handle;
 }
 
+GLuint upload_texture(decoded_image&& image, texture& asset_texture, bool keep_data) {
+	asset_texture.loaded = true; // even if there is nothing to upload, because trying again would be wasteful
+	if(image.type == decoded_image::format::none)
+		return asset_texture.texture_handle;
+
+	asset_texture.texture_handle = upload_image(image, asset_texture.texture_handle, 0);
+	asset_texture.channels = 4;
+	asset_texture.size_x = image.size_x;
+	asset_texture.size_y = image.size_y;
+
+	if(keep_data && asset_texture.texture_handle) {
+		STBI_FREE(asset_texture.data);
+		if(image.type == decoded_image::format::rgba) {
+			asset_texture.data = image.data.release();
+		} else {
+			auto w = uint32_t(image.size_x);
+			auto h = uint32_t(image.size_y);
+			asset_texture.data = static_cast<uint8_t*>(STBI_MALLOC(4 * w * h));
+			glGetTextureImage(asset_texture.texture_handle, 0, GL_RGBA, GL_UNSIGNED_BYTE, static_cast<int32_t>(4 * w * h),
+					asset_texture.data);
+		}
+	}
+	return asset_texture.texture_handle;
+}
+
 GLuint load_file_and_return_handle(native_string const& native_name, simple_fs::file_system const& fs, texture& asset_texture,
 		bool keep_data) {
-	auto name_length = native_name.length();
+	return upload_texture(read_image(native_name, fs), asset_texture, keep_data);
+}
 
-	auto root = get_root(fs);
-	if(name_length > 4) { // try loading as a dds
-		auto dds_name = native_name.substr(0, name_length - 3) + NATIVE("dds");
-		auto file = open_file(root, dds_name);
-		if(file) {
-			auto content = simple_fs::view_contents(*file);
+texture_loader::~texture_loader() {
+	stop();
+}
 
-			uint32_t w = 0;
-			uint32_t h = 0;
-			asset_texture.texture_handle =
-					SOIL_direct_load_DDS_from_memory(reinterpret_cast<uint8_t const*>(content.data), content.file_size, w, h, 0);
-
-			if(asset_texture.texture_handle) {
-				asset_texture.channels = 4;
-				asset_texture.size_x = int32_t(w);
-				asset_texture.size_y = int32_t(h);
-				asset_texture.loaded = true;
-
-				if(keep_data) {
-					asset_texture.data = static_cast<uint8_t*>(STBI_MALLOC(4 * w * h));
-					glGetTextureImage(asset_texture.texture_handle, 0, GL_RGBA, GL_UNSIGNED_BYTE, static_cast<int32_t>(4 * w * h),
-							asset_texture.data);
-				}
-				return asset_texture.texture_handle;
-			}
+void texture_loader::start(simple_fs::file_system const& file_system, flag_atlas* flags) {
+	stop();
+	fs = &file_system;
+	atlas = flags;
+	stopping.store(false, std::memory_order::release);
+	workers = std::unique_ptr<worker[]>(new worker[worker_count]);
+	for(uint32_t i = 0; i < worker_count; ++i) {
+		workers[i].thread = std::thread([this, i]() { work(workers[i]); });
+	}
+}
+
+void texture_loader::stop() {
+	if(!workers)
+		return;
+	stopping.store(true, std::memory_order::release);
+	for(uint32_t i = 0; i < worker_count; ++i) {
+		workers[i].signal.fetch_add(1, std::memory_order::release);
+		workers[i].signal.notify_one();
+	}
+	for(uint32_t i = 0; i < worker_count; ++i) {
+		workers[i].thread.join();
+	}
+	workers.reset();
+	backlog.clear();
+	backlog_first = 0;
+}
+
+void texture_loader::work(worker& w) {
+	while(true) {
+		auto seen = w.signal.load(std::memory_order::acquire);
+		while(auto* r = w.requests.front()) {
+			if(stopping.load(std::memory_order::acquire))
+				return;
+			result decoded{ r->id, read_image(r->file_name, *fs) };
+			if(atlas && atlas->contains(r->id) && expand_to_rgba(decoded.image))
+				decoded.placement = atlas->reserve(decoded.image.size_x, decoded.image.size_y);
+			w.requests.pop();
+			w.results.push(std::move(decoded)); // never waits: results are only produced for the max_in_flight requests given out
 		}
+		if(stopping.load(std::memory_order::acquire))
+			return;
+		w.signal.wait(seen, std::memory_order::acquire); // until submit or stop changes the signal
 	}
+}
 
-	auto file = open_file(root, native_name);
-	if(file) {
-		auto content = simple_fs::view_contents(*file);
+void texture_loader::dispatch() {
+	while(backlog_first < backlog.size()) {
+		worker* least = nullptr;
+		for(uint32_t i = 0; i < worker_count; ++i) {
+			if(workers[i].in_flight < max_in_flight && (!least || workers[i].in_flight < least->in_flight))
+				least = &workers[i];
+		}
+		if(!least)
+			return;
+		least->requests.push(std::move(backlog[backlog_first]));
+		++backlog_first;
+		++least->in_flight;
+		least->signal.fetch_add(1, std::memory_order::release);
+		least->signal.notify_one();
+	}
+	backlog.clear();
+	backlog_first = 0;
+}
 
-		int32_t file_channels = 4;
+void texture_loader::submit(dcon::texture_id id, native_string file_name) {
+	assert(running());
+	backlog.push_back(request{ id, std::move(file_name) });
+	dispatch();
+}
 
-		asset_texture.data = stbi_load_from_memory(reinterpret_cast<uint8_t const*>(content.data), int32_t(content.file_size),
-				&(asset_texture.size_x), &(asset_texture.size_y), &file_channels, 4);
+bool texture_loader::poll(result& out) {
+	if(!workers)
+		return false;
+	for(uint32_t j = 0; j < worker_count; ++j) {
+		auto& w = workers[(next_poll + j) % worker_count];
+		if(auto* r = w.results.front()) {
+			out = std::move(*r);
+			w.results.pop();
+			--w.in_flight;
+			next_poll = (next_poll + j + 1) % worker_count;
+			dispatch();
+			return true;
+		}
+	}
+	return false;
+}
 
-		asset_texture.channels = 4;
-		asset_texture.loaded = true;
+uint32_t texture_loader::pending() const {
+	if(!workers)
+		return 0;
+	uint32_t total = uint32_t(backlog.size() - backlog_first);
+	for(uint32_t i = 0; i < worker_count; ++i)
+		total += workers[i].in_flight;
+	return total;
+}
 
-		glGenTextures(1, &asset_texture.texture_handle);
-		if(asset_texture.texture_handle) {
-			glBindTexture(GL_TEXTURE_2D, asset_texture.texture_handle);
+void texture_loader::upload_decoded(sys::state& state, uint32_t max_uploads) {
+	result r;
+	for(uint32_t i = 0; i < max_uploads && poll(r); ++i) {
+		if(atlas && atlas->contains(r.id))
+			atlas->store(r.id, r.image, r.placement);
+		else
+			upload_texture(std::move(r.image), state.open_gl.asset_textures[r.id], false);
+	}
+}
 
-			glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGBA8, asset_texture.size_x, asset_texture.size_y);
-			glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, asset_texture.size_x, asset_texture.size_y, GL_RGBA, GL_UNSIGNED_BYTE,
-					asset_texture.data);
+void flag_atlas::resize(dcon::texture_id first_flag, uint32_t count) {
+	first = first_flag;
+	entries.resize(count);
+}
 
-			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+atlas_placement flag_atlas::reserve(int32_t width, int32_t height) {
+	if(width <= 0 || height <= 0 || width + 2 * padding > layer_size || height + 2 * padding > layer_size)
+		return atlas_placement{};
+
+	std::lock_guard lock{ packer_lock };
+	for(size_t i = 0; i <= layers.size(); ++i) {
+		if(i == layers.size())
+			layers.emplace_back(layer_size, layer_size);
+		auto p = layers[i].insert(width + 2 * padding, height + 2 * padding);
+		if(p.placed)
+			return atlas_placement{ int32_t(i), p.x + padding, p.y + padding };
+	}
+	return atlas_placement{};
+}
 
-			glBindTexture(GL_TEXTURE_2D, 0);
-		}
+void flag_atlas::ensure_layers(int32_t count) {
+	if(count <= allocated_layers)
+		return;
+
+	GLuint grown = 0;
+	glGenTextures(1, &grown);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, grown);
+	glTexStorage3D(GL_TEXTURE_2D_ARRAY, 1, GL_RGBA8, layer_size, layer_size, count);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+	glClearTexImage(grown, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr); // the padding must be transparent
+
+	if(texture_handle) {
+		glCopyImageSubData(texture_handle, GL_TEXTURE_2D_ARRAY, 0, 0, 0, 0, grown, GL_TEXTURE_2D_ARRAY, 0, 0, 0, 0, layer_size,
+				layer_size, allocated_layers);
+		glDeleteTextures(1, &texture_handle);
+	}
+	texture_handle = grown;
+	allocated_layers = count;
+}
 
-		if(!keep_data) {
-			STBI_FREE(asset_texture.data);
-			asset_texture.data = nullptr;
-		}
+void flag_atlas::store(dcon::texture_id id, decoded_image const& image, atlas_placement placement) {
+	auto& e = (*this)[id];
+	e.ready = true;
+	if(placement.layer < 0) {
+		if(image.type != decoded_image::format::none)
+			e.own_texture = upload_image(image, e.own_texture, 0);
+		return;
+	}
 
-		return asset_texture.texture_handle;
+	ensure_layers(placement.layer + 1);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, texture_handle);
+	glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, placement.x, placement.y, placement.layer, image.size_x, image.size_y, 1, GL_RGBA,
+			GL_UNSIGNED_BYTE, image.data.get());
+	glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+	// inset by half a texel, so that the edges are sampled as if the flag were clamped to them
+	e.layer = placement.layer;
+	e.u0 = (float(placement.x) + 0.5f) / float(layer_size);
+	e.v0 = (float(placement.y) + 0.5f) / float(layer_size);
+	e.u1 = (float(placement.x + image.size_x) - 0.5f) / float(layer_size);
+	e.v1 = (float(placement.y + image.size_y) - 0.5f) / float(layer_size);
+}
+
+float flag_atlas::occupancy() const {
+	std::lock_guard lock{ packer_lock };
+	if(layers.empty())
+		return 0.0f;
+	int64_t used = 0;
+	for(auto& l : layers)
+		used += l.used();
+	return float(double(used) / (double(layers.size()) * double(layer_size) * double(layer_size)));
+}
+
+static native_string flag_file_name(sys::state& state, dcon::national_identity_id nat_id, culture::flag_type type) {
+	native_string file_str;
+	file_str += NATIVE("gfx");
+	file_str += NATIVE_DIR_SEPARATOR;
+	file_str += NATIVE("flags");
+	file_str += NATIVE_DIR_SEPARATOR;
+	file_str += simple_fs::win1250_to_native(nations::int_to_tag(state.world.national_identity_get_identifying_int(nat_id)));
+	switch(type) {
+	case culture::flag_type::communist:
+		file_str += NATIVE("_communist");
+		break;
+	case culture::flag_type::count:
+	case culture::flag_type::default_flag:
+		break;
+	case culture::flag_type::fascist:
+		file_str += NATIVE("_fascist");
+		break;
+	case culture::flag_type::monarchy:
+		file_str += NATIVE("_monarchy");
+		break;
+	case culture::flag_type::republic:
+		file_str += NATIVE("_republic");
+		break;
+	// Non-vanilla
+	case culture::flag_type::theocracy:
+		file_str += NATIVE("_theocracy");
+		break;
+	case culture::flag_type::special:
+		file_str += NATIVE("_special");
+		break;
+	case culture::flag_type::spare:
+		file_str += NATIVE("_spare");
+		break;
+	case culture::flag_type::populist:
+		file_str += NATIVE("_populist");
+		break;
+	case culture::flag_type::realm:
+		file_str += NATIVE("_realm");
+		break;
+	case culture::flag_type::other:
+		file_str += NATIVE("_other");
+		break;
+	case culture::flag_type::monarchy2:
+		file_str += NATIVE("_monarchy2");
+		break;
+	case culture::flag_type::monarchy3:
+		file_str += NATIVE("_monarchy3");
+		break;
+	case culture::flag_type::republic2:
+		file_str += NATIVE("_republic2");
+		break;
+	case culture::flag_type::republic3:
+		file_str += NATIVE("_republic3");
+		break;
+	case culture::flag_type::communist2:
+		file_str += NATIVE("_communist2");
+		break;
+	case culture::flag_type::communist3:
+		file_str += NATIVE("_communist3");
+		break;
+	case culture::flag_type::fascist2:
+		file_str += NATIVE("_fascist2");
+		break;
+	case culture::flag_type::fascist3:
+		file_str += NATIVE("_fascist3");
+		break;
+	case culture::flag_type::theocracy2:
+		file_str += NATIVE("_theocracy2");
+		break;
+	case culture::flag_type::theocracy3:
+		file_str += NATIVE("_theocracy3");
+		break;
+	case culture::flag_type::cosmetic_1:
+		file_str += NATIVE("_cosmetic_1");
+		break;
+	case culture::flag_type::cosmetic_2:
+		file_str += NATIVE("_cosmetic_2");
+		break;
+	case culture::flag_type::colonial:
+		file_str += NATIVE("_colonial");
+		break;
+	case culture::flag_type::nationalist:
+		file_str += NATIVE("_nationalist");
+		break;
+	case culture::flag_type::sectarian:
+		file_str += NATIVE("_sectarian");
+		break;
+	case culture::flag_type::socialist:
+		file_str += NATIVE("_socialist");
+		break;
+	case culture::flag_type::dominion:
+		file_str += NATIVE("_dominion");
+		break;
+	case culture::flag_type::agrarism:
+		file_str += NATIVE("_agrarism");
+		break;
+	case culture::flag_type::national_syndicalist:
+		file_str += NATIVE("_national_syndicalist");
+		break;
+	case culture::flag_type::theocratic:
+		file_str += NATIVE("_theocratic");
+		break;
+	case culture::flag_type::slot1:
+		file_str += NATIVE("_slot1");
+		break;
+	case culture::flag_type::slot2:
+		file_str += NATIVE("_slot2");
+		break;
+	case culture::flag_type::slot3:
+		file_str += NATIVE("_slot3");
+		break;
+	case culture::flag_type::slot4:
+		file_str += NATIVE("_slot4");
+		break;
 	}
-	asset_texture.loaded = true; // because we tried to load it (and failed) and trying again will be wasteful
-	return 0;
+	file_str += NATIVE(".tga");
+	return file_str;
 }
 
-GLuint get_flag_handle(sys::state& state, dcon::national_identity_id nat_id, culture::flag_type type) {
+dcon::texture_id get_flag_texture(sys::state& state, dcon::national_identity_id nat_id, culture::flag_type type) {
 	auto const offset = culture::get_remapped_flag_type(state, type);
 	dcon::texture_id id = dcon::texture_id{
 			dcon::texture_id::value_base_t(state.ui_defs.textures.size() + (1 + nat_id.index()) * state.flag_types.size() + offset)};
 
-	if(state.open_gl.asset_textures[id].loaded) {
-		return state.open_gl.asset_textures[id].texture_handle;
-	} else { // load from file
-
-		native_string file_str;
-		file_str += NATIVE("gfx");
-		file_str += NATIVE_DIR_SEPARATOR;
-		file_str += NATIVE("flags");
-		file_str += NATIVE_DIR_SEPARATOR;
-		file_str += simple_fs::win1250_to_native(nations::int_to_tag(state.world.national_identity_get_identifying_int(nat_id)));
-		switch(type) {
-		case culture::flag_type::communist:
-			file_str += NATIVE("_communist");
-			break;
-		case culture::flag_type::count:
-		case culture::flag_type::default_flag:
-			break;
-		case culture::flag_type::fascist:
-			file_str += NATIVE("_fascist");
-			break;
-		case culture::flag_type::monarchy:
-			file_str += NATIVE("_monarchy");
-			break;
-		case culture::flag_type::republic:
-			file_str += NATIVE("_republic");
-			break;
-		// Non-vanilla
-		case culture::flag_type::theocracy:
-			file_str += NATIVE("_theocracy");
-			break;
-		case culture::flag_type::special:
-			file_str += NATIVE("_special");
-			break;
-		case culture::flag_type::spare:
-			file_str += NATIVE("_spare");
-			break;
-		case culture::flag_type::populist:
-			file_str += NATIVE("_populist");
-			break;
-		case culture::flag_type::realm:
-			file_str += NATIVE("_realm");
-			break;
-		case culture::flag_type::other:
-			file_str += NATIVE("_other");
-			break;
-		case culture::flag_type::monarchy2:
-			file_str += NATIVE("_monarchy2");
-			break;
-		case culture::flag_type::monarchy3:
-			file_str += NATIVE("_monarchy3");
-			break;
-		case culture::flag_type::republic2:
-			file_str += NATIVE("_republic2");
-			break;
-		case culture::flag_type::republic3:
-			file_str += NATIVE("_republic3");
-			break;
-		case culture::flag_type::communist2:
-			file_str += NATIVE("_communist2");
-			break;
-		case culture::flag_type::communist3:
-			file_str += NATIVE("_communist3");
-			break;
-		case culture::flag_type::fascist2:
-			file_str += NATIVE("_fascist2");
-			break;
-		case culture::flag_type::fascist3:
-			file_str += NATIVE("_fascist3");
-			break;
-		case culture::flag_type::theocracy2:
-			file_str += NATIVE("_theocracy2");
-			break;
-		case culture::flag_type::theocracy3:
-			file_str += NATIVE("_theocracy3");
-			break;
-		case culture::flag_type::cosmetic_1:
-			file_str += NATIVE("_cosmetic_1");
-			break;
-		case culture::flag_type::cosmetic_2:
-			file_str += NATIVE("_cosmetic_2");
-			break;
-		case culture::flag_type::colonial:
-			file_str += NATIVE("_colonial");
-			break;
-		case culture::flag_type::nationalist:
-			file_str += NATIVE("_nationalist");
-			break;
-		case culture::flag_type::sectarian:
-			file_str += NATIVE("_sectarian");
-			break;
-		case culture::flag_type::socialist:
-			file_str += NATIVE("_socialist");
-			break;
-		case culture::flag_type::dominion:
-			file_str += NATIVE("_dominion");
-			break;
-		case culture::flag_type::agrarism:
-			file_str += NATIVE("_agrarism");
-			break;
-		case culture::flag_type::national_syndicalist:
-			file_str += NATIVE("_national_syndicalist");
-			break;
-		case culture::flag_type::theocratic:
-			file_str += NATIVE("_theocratic");
-			break;
-		case culture::flag_type::slot1:
-			file_str += NATIVE("_slot1");
-			break;
-		case culture::flag_type::slot2:
-			file_str += NATIVE("_slot2");
-			break;
-		case culture::flag_type::slot3:
-			file_str += NATIVE("_slot3");
-			break;
-		case culture::flag_type::slot4:
-			file_str += NATIVE("_slot4");
-			break;
+	auto& flags = state.open_gl.flags;
+	if(!flags.contains(id))
+		return dcon::texture_id{};
+	if(!flags[id].requested) {
+		flags[id].requested = true;
+		if(state.open_gl.loader.running()) {
+			state.open_gl.loader.submit(id, flag_file_name(state, nat_id, type));
+		} else {
+			auto image = read_image(flag_file_name(state, nat_id, type), state.common_fs);
+			auto placement = expand_to_rgba(image) ? flags.reserve(image.size_x, image.size_y) : atlas_placement{};
+			flags.store(id, image, placement);
 		}
-		file_str += NATIVE(".tga");
+	}
+	return id;
+}
 
-		return load_file_and_return_handle(file_str, state.common_fs, state.open_gl.asset_textures[id], false);
+void prefetch_flags(sys::state& state) {
+	for(auto n : state.world.in_nation) {
+		if(n.get_owned_province_count() != 0)
+			get_flag_texture(state, n.get_identity_from_identity_holder(), culture::get_current_flag_type(state, n.id));
 	}
 }
 
@@ -1,6 +1,13 @@
 #pragma once
 
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
 #include "container_types.hpp"
+#include "SPSCQueue.h"
+#include "atlas_packer.hpp"
 
 #ifndef GLEW_STATIC
 #define GLEW_STATIC
@@ -12,7 +19,6 @@ namespace ogl {
 class texture;
 
 GLuint get_texture_handle(sys::state& state, dcon::texture_id id, bool keep_data);
-GLuint get_flag_handle(sys::state& state, dcon::national_identity_id nat_id, culture::flag_type type);
 GLuint load_file_and_return_handle(native_string const& native_name, simple_fs::file_system const& fs, texture& asset_texture, bool keep_data);
 
 enum {
@@ -36,6 +42,37 @@ enum {
 unsigned int SOIL_direct_load_DDS_from_memory(unsigned char const* const buffer, unsigned int buffer_length, unsigned int& width,
 		unsigned int& height, int flags);
 
+struct image_data_deleter {
+	void operator()(uint8_t* data) const noexcept; // releases with STBI_FREE, so that the data can be handed to a texture
+};
+using image_data = std::unique_ptr<uint8_t, image_data_deleter>;
+
+/*
+An image file read and decoded into memory, ready to be uploaded. Reading and decoding do not touch OpenGL, so they can
+run on any thread (and be tested without a context); only upload_image has to run on the render thread.
+*/
+struct decoded_image {
+	enum class format : uint8_t { none, rgba, dds_uncompressed, dds_compressed };
+
+	image_data data;
+	uint32_t data_size = 0;
+	int32_t size_x = 0;
+	int32_t size_y = 0;
+	uint32_t gl_format = 0; // dds: GL_RGB, GL_RGBA or one of the S3TC formats
+	int32_t block_size = 0; // dds: bytes per pixel when uncompressed, bytes per 4x4 block when compressed
+	int32_t mipmaps = 0;    // dds: number of mipmap levels after the first, stored after it in data
+	format type = format::none;
+};
+
+decoded_image decode_dds(uint8_t const* file_data, uint32_t file_size); // uncompressed data is swapped from BGR(A) to RGB(A)
+decoded_image decode_image(uint8_t const* file_data, uint32_t file_size); // any format stb_image is built with, as rgba
+// tries the dds version of the file first, then the file itself, as load_file_and_return_handle does
+decoded_image read_image(native_string const& native_name, simple_fs::file_system const& fs);
+// uploads into handle, or into a new texture if handle is 0; returns the handle, or 0 if there was nothing to upload
+GLuint upload_image(decoded_image const& image, GLuint handle, int flags);
+// converts uncompressed images to rgba without mipmaps; returns false if the image is compressed or empty
+bool expand_to_rgba(decoded_image& image);
+
 class texture {
 	GLuint texture_handle = 0;
 
@@ -60,9 +97,138 @@ public:
 	friend GLuint get_texture_handle(sys::state& state, dcon::texture_id id, bool keep_data);
 	friend GLuint load_file_and_return_handle(native_string const& native_name, simple_fs::file_system const& fs,
 			texture& asset_texture, bool keep_data);
-	friend GLuint get_flag_handle(sys::state& state, dcon::national_identity_id nat_id, culture::flag_type type);
+	friend GLuint upload_texture(decoded_image&& image, texture& asset_texture, bool keep_data);
+};
+
+// makes image the contents of asset_texture, reusing its texture handle if it already has one, and marks it as loaded
+GLuint upload_texture(decoded_image&& image, texture& asset_texture, bool keep_data);
+
+struct atlas_placement {
+	int32_t layer = -1; // -1 if the image is not in the atlas
+	int32_t x = 0;
+	int32_t y = 0;
+};
+
+/*
+The flags, packed into the layers of one array texture so that they are uploaded as sub-images of a texture that already
+exists rather than as hundreds of textures of their own. Space is reserved by the loader's workers as soon as an image is
+decoded (reserve is the only thread safe member) and filled by the render thread in store. Each flag texture id has its
+own entry, so when a government change gives a nation a different flag type the new flag is simply packed into free space
+next to the others; nothing already in the atlas moves, and the flag of the old type stays there for when it comes back.
+Compressed dds flags cannot be copied into the atlas and keep a texture of their own.
+*/
+class flag_atlas {
+public:
+	static constexpr int32_t layer_size = 2048;
+	static constexpr int32_t padding = 1; // transparent texels kept around each flag, so that filtering does not bleed
+
+	struct entry {
+		float u0 = 0.0f;
+		float v0 = 0.0f;
+		float u1 = 0.0f;
+		float v1 = 0.0f;
+		int32_t layer = -1;
+		GLuint own_texture = 0;
+		bool requested = false;
+		bool ready = false; // set once the image has been stored, even if there was no image to store
+	};
+
+	void resize(dcon::texture_id first_flag, uint32_t count);
+	bool contains(dcon::texture_id id) const {
+		return id && id.index() >= first.index() && uint32_t(id.index() - first.index()) < entries.size();
+	}
+	entry& operator[](dcon::texture_id id) {
+		return entries[id.index() - first.index()];
+	}
+	entry const& operator[](dcon::texture_id id) const {
+		return entries[id.index() - first.index()];
+	}
+
+	atlas_placement reserve(int32_t width, int32_t height); // thread safe
+	void store(dcon::texture_id id, decoded_image const& image, atlas_placement placement); // render thread only
+	GLuint handle() const {
+		return texture_handle;
+	}
+	float occupancy() const; // of the layers in use
+
+private:
+	void ensure_layers(int32_t count);
+
+	mutable std::mutex packer_lock;
+	std::vector<skyline_packer> layers; // guarded by packer_lock
+	std::vector<entry> entries;
+	dcon::texture_id first;
+	GLuint texture_handle = 0;
+	int32_t allocated_layers = 0;
+};
+
+/*
+Reads and decodes textures on worker threads, so that opening a window full of flags does not decode them all in one
+frame. A requested texture is given a handle at once, holding a transparent placeholder, and is marked as loaded; the
+render thread calls upload_decoded every frame, which uploads at most a few of the finished images into the handles they
+were requested for. Elements that keep the handle therefore draw nothing until their image arrives, and then draw it.
+When started with an atlas, the workers also reserve space in it for each image they decode, and upload_decoded stores
+the images into the atlas instead.
+*/
+class texture_loader {
+public:
+	static constexpr uint32_t worker_count = 2;
+	static constexpr uint32_t max_in_flight = 128; // per worker; further requests wait on the render thread
+	static constexpr uint32_t uploads_per_frame = 8;
+
+	struct request {
+		dcon::texture_id id;
+		native_string file_name;
+	};
+	struct result {
+		dcon::texture_id id;
+		decoded_image image;
+		atlas_placement placement;
+	};
+
+	texture_loader() = default;
+	texture_loader(texture_loader const&) = delete;
+	texture_loader& operator=(texture_loader const&) = delete;
+	~texture_loader();
+
+	void start(simple_fs::file_system const& fs, flag_atlas* atlas = nullptr);
+	void stop(); // waits for the workers to finish the image they are on; requests not yet decoded are dropped
+	bool running() const {
+		return workers != nullptr;
+	}
+
+	void submit(dcon::texture_id id, native_string file_name);
+	bool poll(result& out); // takes a decoded image, if one is ready
+	uint32_t pending() const; // requested and not yet taken by poll
+
+	void upload_decoded(sys::state& state, uint32_t max_uploads = uploads_per_frame);
+
+private:
+	struct worker {
+		rigtorp::SPSCQueue<request> requests{max_in_flight};
+		rigtorp::SPSCQueue<result> results{max_in_flight};
+		std::atomic<uint32_t> signal = 0;
+		uint32_t in_flight = 0; // requests given to this worker and not yet polled; only used by the render thread
+		std::thread thread;
+	};
+
+	void dispatch();
+	void work(worker& w);
+
+	std::unique_ptr<worker[]> workers;
+	std::vector<request> backlog;
+	size_t backlog_first = 0;
+	simple_fs::file_system const* fs = nullptr;
+	flag_atlas* atlas = nullptr;
+	std::atomic<bool> stopping = false;
+	uint32_t next_poll = 0;
 };
 
+// returns the id of the flag at once and, the first time it is asked for, starts loading it into the flag atlas
+dcon::texture_id get_flag_texture(sys::state& state, dcon::national_identity_id nat_id, culture::flag_type type);
+// starts loading the current flags of the nations that a window about to open will show
+void prefetch_flags(sys::state& state);
+
 class data_texture {
 	GLuint texture_handle = 0;
 
@@ -77,6 +77,7 @@ void update_connected_regions(sys::state& state) {
 	state.province_definitions.connected_region_is_coastal.clear();
 
 	to_fill_list.reserve(state.world.province_size());
+	auto& graph = state.province_definitions.adjacency;
 
 	for(int32_t i = state.province_definitions.first_sea_province.index(); i-- > 0;) {
 		dcon::province_id id{dcon::province_id::value_base_t(i)};
@@ -94,18 +95,18 @@ void update_connected_regions(sys::state& state) {
 				found_coast = found_coast || state.world.province_get_is_coast(current_id);
 
 				state.world.province_set_connected_region_id(current_id, current_fill_id);
-				for(auto rel : state.world.province_get_province_adjacency(current_id)) {
-					if((rel.get_type() & (province::border::coastal_bit | province::border::impassible_bit)) ==
-							0) { // not entering sea, not impassible
-						auto owner_a = rel.get_connected_provinces(0).get_nation_from_province_ownership();
-						auto owner_b = rel.get_connected_provinces(1).get_nation_from_province_ownership();
-						if(owner_a == owner_b) { // both have the same owner
-							if(rel.get_connected_provinces(0).get_connected_region_id() == 0)
-								to_fill_list.push_back(rel.get_connected_provinces(0));
-							if(rel.get_connected_provinces(1).get_connected_region_id() == 0)
-								to_fill_list.push_back(rel.get_connected_provinces(1));
+				auto owner = state.world.province_get_nation_from_province_ownership(current_id);
+				for(auto i = graph.non_coastal_offsets[current_id.index()]; i < graph.non_coastal_offsets[current_id.index() + 1]; ++i) {
+					if((graph.types[graph.non_coastal_slots[i]] & province::border::impassible_bit) == 0) { // not entering sea, not impassible
+						auto other = graph.non_coastal_neighbors[i];
+						if(state.world.province_get_nation_from_province_ownership(other) == owner) { // both have the same owner
+							if(state.world.province_get_connected_region_id(other) == 0)
+								to_fill_list.push_back(other);
 						} else {
-							state.world.try_create_nation_adjacency(owner_a, owner_b);
+							auto rel = graph.edges[graph.non_coastal_slots[i]];
+							state.world.try_create_nation_adjacency(
+								state.world.province_get_nation_from_province_ownership(state.world.province_adjacency_get_connected_provinces(rel, 0)),
+								state.world.province_get_nation_from_province_ownership(state.world.province_adjacency_get_connected_provinces(rel, 1)));
 						}
 					}
 				}
@@ -282,13 +283,156 @@ void restore_cached_values(sys::state& state) {
 	});
 }
 
+void restore_cached_values(sys::state& state, dcon::nation_id n) {
+	state.world.nation_set_owned_province_count(n, uint16_t(0));
+	state.world.nation_set_central_province_count(n, uint16_t(0));
+	state.world.nation_set_central_blockaded(n, uint16_t(0));
+	state.world.nation_set_central_rebel_controlled(n, uint16_t(0));
+	state.world.nation_set_rebel_controlled_count(n, uint16_t(0));
+	state.world.nation_set_central_ports(n, uint16_t(0));
+	state.world.nation_set_central_crime_count(n, uint16_t(0));
+	state.world.nation_set_total_ports(n, uint16_t(0));
+	state.world.nation_set_occupied_count(n, uint16_t(0));
+	state.world.nation_set_owned_state_count(n, uint16_t(0));
+	state.world.nation_set_is_colonial_nation(n, false);
+
+	auto ident = state.world.nation_get_identity_from_identity_holder(n);
+	for(auto o : state.world.nation_get_province_ownership(n)) {
+		auto pid = o.get_province();
+		state.world.province_set_is_owner_core(pid, bool(state.world.get_core_by_prov_tag_key(pid, ident)));
+	}
+
+	// capital selection depends on the owner cores
+	if(state.world.province_get_nation_from_province_ownership(state.world.nation_get_capital(n)) != n) {
+		state.world.nation_set_capital(n, pick_capital(state, n));
+	}
+
+	for(auto o : state.world.nation_get_province_ownership(n)) {
+		auto pid = o.get_province();
+
+		state.world.nation_get_owned_province_count(n) += uint16_t(1);
+
+		bool reb_controlled = bool(state.world.province_get_rebel_faction_from_province_rebel_control(pid));
+
+		if(reb_controlled) {
+			state.world.nation_get_rebel_controlled_count(n) += uint16_t(1);
+		}
+		if(state.world.province_get_is_coast(pid)) {
+			state.world.nation_get_total_ports(n) += uint16_t(1);
+		}
+		if(auto c = state.world.province_get_nation_from_province_control(pid); bool(c) && c != n) {
+			state.world.nation_get_occupied_count(n) += uint16_t(1);
+		}
+		if(state.world.province_get_is_colonial(pid)) {
+			state.world.nation_set_is_colonial_nation(n, true);
+		}
+		if(!is_overseas(state, pid)) {
+			state.world.nation_get_central_province_count(n) += uint16_t(1);
+
+			if(military::province_is_blockaded(state, pid)) {
+				state.world.nation_get_central_blockaded(n) += uint16_t(1);
+			}
+			if(state.world.province_get_is_coast(pid)) {
+				state.world.nation_get_central_ports(n) += uint16_t(1);
+			}
+			if(reb_controlled) {
+				state.world.nation_get_central_rebel_controlled(n) += uint16_t(1);
+			}
+			if(state.world.province_get_crime(pid)) {
+				state.world.nation_get_central_crime_count(n) += uint16_t(1);
+			}
+		}
+	}
+
+	for(auto so : state.world.nation_get_state_ownership(n)) {
+		auto s = so.get_state();
+		state.world.nation_get_owned_state_count(n) += uint16_t(1);
+		dcon::province_id p;
+		for(auto prv : state.world.state_definition_get_abstract_state_membership(s.get_definition())) {
+			if(prv.get_province().get_nation_from_province_ownership() == n) {
+				p = prv.get_province().id;
+				break;
+			}
+		}
+		s.set_capital(p);
+	}
+}
+
+struct nation_cached_values {
+	dcon::province_id capital;
+	uint16_t owned_province_count = 0;
+	uint16_t central_province_count = 0;
+	uint16_t central_blockaded = 0;
+	uint16_t central_rebel_controlled = 0;
+	uint16_t rebel_controlled_count = 0;
+	uint16_t central_ports = 0;
+	uint16_t central_crime_count = 0;
+	uint16_t total_ports = 0;
+	uint16_t occupied_count = 0;
+	uint16_t owned_state_count = 0;
+	bool is_colonial_nation = false;
+
+	bool operator==(nation_cached_values const&) const = default;
+};
+
+nation_cached_values get_cached_values(sys::state& state, dcon::nation_id n) {
+	nation_cached_values v;
+	v.capital = state.world.nation_get_capital(n);
+	v.owned_province_count = state.world.nation_get_owned_province_count(n);
+	v.central_province_count = state.world.nation_get_central_province_count(n);
+	v.central_blockaded = state.world.nation_get_central_blockaded(n);
+	v.central_rebel_controlled = state.world.nation_get_central_rebel_controlled(n);
+	v.rebel_controlled_count = state.world.nation_get_rebel_controlled_count(n);
+	v.central_ports = state.world.nation_get_central_ports(n);
+	v.central_crime_count = state.world.nation_get_central_crime_count(n);
+	v.total_ports = state.world.nation_get_total_ports(n);
+	v.occupied_count = state.world.nation_get_occupied_count(n);
+	v.owned_state_count = state.world.nation_get_owned_state_count(n);
+	v.is_colonial_nation = state.world.nation_get_is_colonial_nation(n);
+	return v;
+}
+
+uint32_t verify_cached_values(sys::state& state) {
+	std::vector<nation_cached_values> incremental(state.world.nation_size());
+	for(auto n : state.world.in_nation)
+		incremental[n.id.index()] = get_cached_values(state, n);
+	std::vector<uint8_t> owner_cores(state.world.province_size());
+	for(auto p : state.world.in_province)
+		owner_cores[p.id.index()] = p.get_is_owner_core() ? 1 : 0;
+
+	restore_cached_values(state);
+
+	uint32_t mismatches = 0;
+	for(auto n : state.world.in_nation) {
+		if(!(incremental[n.id.index()] == get_cached_values(state, n)))
+			++mismatches;
+	}
+	for(auto p : state.world.in_province) {
+		if(owner_cores[p.id.index()] != (p.get_is_owner_core() ? 1 : 0))
+			++mismatches;
+	}
+	return mismatches;
+}
+
 void update_cached_values(sys::state& state) {
-	if(!state.national_cached_values_out_of_date)
+	/*
+	Only the nations whose provinces changed hands since the last update are recomputed; see change_province_owner.
+	*/
+	auto& stale = state.nations_with_stale_cached_values;
+	if(stale.empty())
 		return;
 
-	state.national_cached_values_out_of_date = false;
+	std::sort(stale.begin(), stale.end(), [](dcon::nation_id a, dcon::nation_id b) { return a.index() < b.index(); });
+	stale.erase(std::unique(stale.begin(), stale.end()), stale.end());
+	for(auto n : stale) {
+		if(state.world.nation_is_valid(n))
+			restore_cached_values(state, n);
+	}
+	stale.clear();
 
-	restore_cached_values(state);
+	if(state.verify_cached_values) {
+		state.cached_values_mismatches += verify_cached_values(state);
+	}
 }
 
 void update_blockaded_cache(sys::state& state) {
@@ -734,7 +878,10 @@ void change_province_owner(sys::state& state, dcon::province_id id, dcon::nation
 		return;
 
 	state.adjacency_data_out_of_date = true;
-	state.national_cached_values_out_of_date = true;
+	if(old_owner)
+		state.nations_with_stale_cached_values.push_back(old_owner);
+	if(new_owner)
+		state.nations_with_stale_cached_values.push_back(new_owner);
 
 	bool state_is_new = false;
 	dcon::state_instance_id new_si;
@@ -924,6 +1071,7 @@ void change_province_owner(sys::state& state, dcon::province_id id, dcon::nation
 		} else {
 			adj.set_type(adj.get_type() | province::border::national_bit);
 		}
+		update_adjacency_graph_type(state, adj);
 	}
 
 	/* Properly cleanup rebels when the province ownership changes */
@@ -1566,8 +1714,24 @@ void set_rgo(sys::state& state, dcon::province_id prov, dcon::commodity_id c) {
 	}
 }
 
+void update_adjacency_graph_type(sys::state& state, dcon::province_adjacency_id adj) {
+	// the graph layout does not change, so just patch the type bits of both directions of the edge
+	auto& g = state.province_definitions.adjacency;
+	for(uint32_t k = 0; k < 2; ++k) {
+		auto p = state.world.province_adjacency_get_connected_provinces(adj, k);
+		if(!p || size_t(p.index()) + 1 >= g.offsets.size())
+			continue;
+		for(auto i = g.offsets[p.index()]; i < g.offsets[p.index() + 1]; ++i) {
+			if(g.edges[i] == adj)
+				g.types[i] = state.world.province_adjacency_get_type(adj);
+		}
+	}
+}
+
 void enable_canal(sys::state& state, int32_t id) {
-	state.world.province_adjacency_get_type(state.province_definitions.canals[id]) &= ~province::border::impassible_bit;
+	auto canal = state.province_definitions.canals[id];
+	state.world.province_adjacency_get_type(canal) &= ~province::border::impassible_bit;
+	update_adjacency_graph_type(state, canal);
 }
 
 // distance between to adjacent provinces
@@ -1713,16 +1877,16 @@ std::vector<dcon::province_id> make_land_path(sys::state& state, dcon::province_
 	};
 
 	path_heap.push_back(province_and_distance{0.0f, direct_distance(state, start, end), start});
+	auto& graph = state.province_definitions.adjacency;
 	while(path_heap.size() > 0) {
 		std::pop_heap(path_heap.begin(), path_heap.end());
 		auto nearest = path_heap.back();
 		path_heap.pop_back();
 
-		for(auto adj : state.world.province_get_province_adjacency(nearest.province)) {
-			auto other_prov =
-					adj.get_connected_provinces(0) == nearest.province ? adj.get_connected_provinces(1) : adj.get_connected_provinces(0);
-			auto bits = adj.get_type();
-			auto distance = adj.get_distance();
+		for(auto i = graph.offsets[nearest.province.index()]; i < graph.offsets[nearest.province.index() + 1]; ++i) {
+			auto other_prov = fatten(state.world, graph.neighbors[i]);
+			auto bits = graph.types[i];
+			auto distance = graph.distances[i];
 
 			if((bits & province::border::impassible_bit) == 0 && !origins_vector.get(other_prov)) {
 				if(other_prov == end) {
@@ -1777,16 +1941,16 @@ std::vector<dcon::province_id> make_safe_land_path(sys::state& state, dcon::prov
 	};
 
 	path_heap.push_back(province_and_distance{ 0.0f, direct_distance(state, start, end), start });
+	auto& graph = state.province_definitions.adjacency;
 	while(path_heap.size() > 0) {
 		std::pop_heap(path_heap.begin(), path_heap.end());
 		auto nearest = path_heap.back();
 		path_heap.pop_back();
 
-		for(auto adj : state.world.province_get_province_adjacency(nearest.province)) {
-			auto other_prov =
-				adj.get_connected_provinces(0) == nearest.province ? adj.get_connected_provinces(1) : adj.get_connected_provinces(0);
-			auto bits = adj.get_type();
-			auto distance = adj.get_distance();
+		for(auto i = graph.offsets[nearest.province.index()]; i < graph.offsets[nearest.province.index() + 1]; ++i) {
+			auto other_prov = fatten(state.world, graph.neighbors[i]);
+			auto bits = graph.types[i];
+			auto distance = graph.distances[i];
 
 			if((bits & province::border::impassible_bit) == 0 && !origins_vector.get(other_prov)) {
 				if(other_prov == end) {
@@ -1834,16 +1998,16 @@ std::vector<dcon::province_id> make_unowned_land_path(sys::state& state, dcon::p
 	};
 
 	path_heap.push_back(province_and_distance{0.0f, direct_distance(state, start, end), start});
+	auto& graph = state.province_definitions.adjacency;
 	while(path_heap.size() > 0) {
 		std::pop_heap(path_heap.begin(), path_heap.end());
 		auto nearest = path_heap.back();
 		path_heap.pop_back();
 
-		for(auto adj : state.world.province_get_province_adjacency(nearest.province)) {
-			auto other_prov =
-					adj.get_connected_provinces(0) == nearest.province ? adj.get_connected_provinces(1) : adj.get_connected_provinces(0);
-			auto bits = adj.get_type();
-			auto distance = adj.get_distance();
+		for(auto i = graph.offsets[nearest.province.index()]; i < graph.offsets[nearest.province.index() + 1]; ++i) {
+			auto other_prov = fatten(state.world, graph.neighbors[i]);
+			auto bits = graph.types[i];
+			auto distance = graph.distances[i];
 
 			if((bits & province::border::impassible_bit) == 0 && !origins_vector.get(other_prov)) {
 				if(other_prov == end) {
@@ -1885,16 +2049,16 @@ std::vector<dcon::province_id> make_naval_path(sys::state& state, dcon::province
 	};
 
 	path_heap.push_back(province_and_distance{0.0f, direct_distance(state, start, end), start});
+	auto& graph = state.province_definitions.adjacency;
 	while(path_heap.size() > 0) {
 		std::pop_heap(path_heap.begin(), path_heap.end());
 		auto nearest = path_heap.back();
 		path_heap.pop_back();
 
-		for(auto adj : state.world.province_get_province_adjacency(nearest.province)) {
-			auto other_prov =
-					adj.get_connected_provinces(0) == nearest.province ? adj.get_connected_provinces(1) : adj.get_connected_provinces(0);
-			auto bits = adj.get_type();
-			auto distance = adj.get_distance();
+		for(auto i = graph.offsets[nearest.province.index()]; i < graph.offsets[nearest.province.index() + 1]; ++i) {
+			auto other_prov = fatten(state.world, graph.neighbors[i]);
+			auto bits = graph.types[i];
+			auto distance = graph.distances[i];
 
 			// can't move over impassible connections; can't move directly from port to port
 			if((bits & province::border::impassible_bit) == 0 && !origins_vector.get(other_prov) &&
@@ -1965,6 +2129,7 @@ std::vector<dcon::province_id> make_naval_retreat_path(sys::state& state, dcon::
 	};
 
 	path_heap.push_back(retreat_province_and_distance{0.0f, start});
+	auto& graph = state.province_definitions.adjacency;
 	while(path_heap.size() > 0) {
 		std::pop_heap(path_heap.begin(), path_heap.end());
 		auto nearest = path_heap.back();
@@ -1976,11 +2141,10 @@ std::vector<dcon::province_id> make_naval_retreat_path(sys::state& state, dcon::
 			return path_result;
 		}
 
-		for(auto adj : state.world.province_get_province_adjacency(nearest.province)) {
-			auto other_prov =
-					adj.get_connected_provinces(0) == nearest.province ? adj.get_connected_provinces(1) : adj.get_connected_provinces(0);
-			auto bits = adj.get_type();
-			auto distance = adj.get_distance();
+		for(auto i = graph.offsets[nearest.province.index()]; i < graph.offsets[nearest.province.index() + 1]; ++i) {
+			auto other_prov = fatten(state.world, graph.neighbors[i]);
+			auto bits = graph.types[i];
+			auto distance = graph.distances[i];
 
 			if((bits & province::border::impassible_bit) == 0 && !origins_vector.get(other_prov)) {
 				if((bits & province::border::coastal_bit) == 0) { // doesn't cross coast -- i.e. is sea province
@@ -2021,6 +2185,7 @@ std::vector<dcon::province_id> make_land_retreat_path(sys::state& state, dcon::n
 	};
 
 	path_heap.push_back(retreat_province_and_distance{0.0f, start});
+	auto& graph = state.province_definitions.adjacency;
 	while(path_heap.size() > 0) {
 		std::pop_heap(path_heap.begin(), path_heap.end());
 		auto nearest = path_heap.back();
@@ -2032,11 +2197,10 @@ std::vector<dcon::province_id> make_land_retreat_path(sys::state& state, dcon::n
 			return path_result;
 		}
 
-		for(auto adj : state.world.province_get_province_adjacency(nearest.province)) {
-			auto other_prov =
-					adj.get_connected_provinces(0) == nearest.province ? adj.get_connected_provinces(1) : adj.get_connected_provinces(0);
-			auto bits = adj.get_type();
-			auto distance = adj.get_distance();
+		for(auto j = graph.non_coastal_offsets[nearest.province.index()]; j < graph.non_coastal_offsets[nearest.province.index() + 1]; ++j) {
+			auto other_prov = fatten(state.world, graph.non_coastal_neighbors[j]);
+			auto bits = graph.types[graph.non_coastal_slots[j]];
+			auto distance = graph.non_coastal_distances[j];
 
 			if((bits & province::border::impassible_bit) == 0 && !origins_vector.get(other_prov)) {
 				if((bits & province::border::coastal_bit) == 0) { // doesn't cross coast -- i.e. is land province
@@ -2070,6 +2234,7 @@ std::vector<dcon::province_id> make_path_to_nearest_coast(sys::state& state, dco
 	};
 
 	path_heap.push_back(retreat_province_and_distance{ 0.0f, start });
+	auto& graph = state.province_definitions.adjacency;
 	while(path_heap.size() > 0) {
 		std::pop_heap(path_heap.begin(), path_heap.end());
 		auto nearest = path_heap.back();
@@ -2081,11 +2246,10 @@ std::vector<dcon::province_id> make_path_to_nearest_coast(sys::state& state, dco
 			return path_result;
 		}
 
-		for(auto adj : state.world.province_get_province_adjacency(nearest.province)) {
-			auto other_prov =
-				adj.get_connected_provinces(0) == nearest.province ? adj.get_connected_provinces(1) : adj.get_connected_provinces(0);
-			auto bits = adj.get_type();
-			auto distance = adj.get_distance();
+		for(auto j = graph.non_coastal_offsets[nearest.province.index()]; j < graph.non_coastal_offsets[nearest.province.index() + 1]; ++j) {
+			auto other_prov = fatten(state.world, graph.non_coastal_neighbors[j]);
+			auto bits = graph.types[graph.non_coastal_slots[j]];
+			auto distance = graph.non_coastal_distances[j];
 
 			if((bits & province::border::impassible_bit) == 0 && !origins_vector.get(other_prov)) {
 				if((bits & province::border::coastal_bit) == 0) { // doesn't cross coast -- i.e. is land province
@@ -2122,6 +2286,7 @@ std::vector<dcon::province_id> make_unowned_path_to_nearest_coast(sys::state& st
 	};
 
 	path_heap.push_back(retreat_province_and_distance{ 0.0f, start });
+	auto& graph = state.province_definitions.adjacency;
 	while(path_heap.size() > 0) {
 		std::pop_heap(path_heap.begin(), path_heap.end());
 		auto nearest = path_heap.back();
@@ -2133,11 +2298,10 @@ std::vector<dcon::province_id> make_unowned_path_to_nearest_coast(sys::state& st
 			return path_result;
 		}
 
-		for(auto adj : state.world.province_get_province_adjacency(nearest.province)) {
-			auto other_prov =
-				adj.get_connected_provinces(0) == nearest.province ? adj.get_connected_provinces(1) : adj.get_connected_provinces(0);
-			auto bits = adj.get_type();
-			auto distance = adj.get_distance();
+		for(auto j = graph.non_coastal_offsets[nearest.province.index()]; j < graph.non_coastal_offsets[nearest.province.index() + 1]; ++j) {
+			auto other_prov = fatten(state.world, graph.non_coastal_neighbors[j]);
+			auto bits = graph.types[graph.non_coastal_slots[j]];
+			auto distance = graph.non_coastal_distances[j];
 
 			if((bits & province::border::impassible_bit) == 0 && !origins_vector.get(other_prov)) {
 				if((bits & province::border::coastal_bit) == 0) { // doesn't cross coast -- i.e. is land province
@@ -2178,4 +2342,51 @@ void restore_distances(sys::state& state) {
 	}
 }
 
+void rebuild_adjacency_graph(sys::state& state) {
+	auto& g = state.province_definitions.adjacency;
+	auto province_count = state.world.province_size();
+	auto edge_count = state.world.province_adjacency_size() * 2;
+
+	g.offsets.clear();
+	g.neighbors.clear();
+	g.edges.clear();
+	g.types.clear();
+	g.distances.clear();
+	g.non_coastal_offsets.clear();
+	g.non_coastal_neighbors.clear();
+	g.non_coastal_distances.clear();
+	g.non_coastal_slots.clear();
+
+	g.offsets.reserve(province_count + 1);
+	g.neighbors.reserve(edge_count);
+	g.edges.reserve(edge_count);
+	g.types.reserve(edge_count);
+	g.distances.reserve(edge_count);
+	g.non_coastal_offsets.reserve(province_count + 1);
+	g.non_coastal_neighbors.reserve(edge_count);
+	g.non_coastal_distances.reserve(edge_count);
+	g.non_coastal_slots.reserve(edge_count);
+
+	for(uint32_t i = 0; i < province_count; ++i) {
+		dcon::province_id p{ dcon::province_id::value_base_t(i) };
+		g.offsets.push_back(uint32_t(g.neighbors.size()));
+		g.non_coastal_offsets.push_back(uint32_t(g.non_coastal_neighbors.size()));
+		for(auto adj : state.world.province_get_province_adjacency(p)) {
+			auto other = adj.get_connected_provinces(0) == p ? adj.get_connected_provinces(1) : adj.get_connected_provinces(0);
+			auto slot = uint32_t(g.neighbors.size());
+			g.neighbors.push_back(other);
+			g.edges.push_back(adj);
+			g.types.push_back(adj.get_type());
+			g.distances.push_back(adj.get_distance());
+			if((adj.get_type() & province::border::coastal_bit) == 0) {
+				g.non_coastal_neighbors.push_back(other);
+				g.non_coastal_distances.push_back(adj.get_distance());
+				g.non_coastal_slots.push_back(slot);
+			}
+		}
+	}
+	g.offsets.push_back(uint32_t(g.neighbors.size()));
+	g.non_coastal_offsets.push_back(uint32_t(g.non_coastal_neighbors.size()));
+}
+
 } // namespace province
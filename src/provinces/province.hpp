@@ -17,7 +17,27 @@ inline constexpr dcon::province_id from_map_id(uint16_t id) {
 		return dcon::province_id(id - 1);
 }
 
+// Read-only compressed sparse row copy of the province_adjacency relationship, rebuilt by rebuild_adjacency_graph.
+// The edges of province p occupy [offsets[p], offsets[p + 1]) in each of the per-edge arrays, in the same order
+// as province_get_province_adjacency(p). Only the type bits can change after it is built (canals, and the national bit
+// when a province changes owner); update_adjacency_graph_type copies them in place.
+struct adjacency_graph {
+	std::vector<uint32_t> offsets;
+	std::vector<dcon::province_id> neighbors;
+	std::vector<dcon::province_adjacency_id> edges;
+	std::vector<uint8_t> types;
+	std::vector<float> distances;
+
+	// the subset of edges that do not cross the coast: land neighbors of a land province, sea neighbors of a sea province
+	// non_coastal_slots maps back into the per-edge arrays above, for the type bits
+	std::vector<uint32_t> non_coastal_offsets;
+	std::vector<dcon::province_id> non_coastal_neighbors;
+	std::vector<float> non_coastal_distances;
+	std::vector<uint32_t> non_coastal_slots;
+};
+
 struct global_provincial_state {
+	adjacency_graph adjacency; // not saved
 	std::vector<dcon::province_adjacency_id> canals;
 	ankerl::unordered_dense::map<dcon::modifier_id, dcon::gfx_object_id, sys::modifier_hash> terrain_to_gfx_map;
 	std::vector<bool> connected_region_is_coastal;
@@ -46,6 +66,8 @@ void update_cached_values(sys::state& state);
 void update_blockaded_cache(sys::state& state);
 void restore_unsaved_values(sys::state& state);
 void restore_distances(sys::state& state);
+void rebuild_adjacency_graph(sys::state& state);
+void update_adjacency_graph_type(sys::state& state, dcon::province_adjacency_id adj); // after changing the type of adj
 
 template<typename T>
 auto is_overseas(sys::state const& state, T ids);
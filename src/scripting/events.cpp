@@ -412,28 +412,334 @@ void trigger_provincial_event(sys::state& state, dcon::free_provincial_event_id
 	}
 }
 
-struct event_nation_pair {
-	dcon::nation_id n;
-	dcon::free_national_event_id e;
+bool tests_for_equality(uint16_t code) {
+	// mirrors compare_values_eq / compare_to_true in the trigger evaluator
+	switch(code & trigger::association_mask) {
+	case trigger::association_gt:
+	case trigger::association_lt:
+	case trigger::association_ne:
+		return false;
+	default:
+		return true;
+	}
+}
 
-	bool operator==(event_nation_pair const& other) const noexcept {
-		return other.n == n && other.e == e;
+void restrict_year(trigger_prefilter& f, uint16_t code, int32_t value) {
+	// mirrors compare_values(code, current_year, value)
+	switch(code & trigger::association_mask) {
+	case trigger::association_eq:
+		f.min_year = std::max(f.min_year, value);
+		f.max_year = std::min(f.max_year, value);
+		break;
+	case trigger::association_gt:
+		f.min_year = std::max(f.min_year, value + 1);
+		break;
+	case trigger::association_lt:
+		f.max_year = std::min(f.max_year, value - 1);
+		break;
+	case trigger::association_le:
+		f.max_year = std::min(f.max_year, value);
+		break;
+	case trigger::association_ne:
+		break;
+	default:
+		f.min_year = std::max(f.min_year, value);
+		break;
 	}
-	bool operator<(event_nation_pair const& other) const noexcept {
-		return other.n != n ? (n.value < other.n.value) : (e.value < other.e.value);
+}
+
+template<typename F>
+void for_each_top_level_conjunct(sys::state& state, dcon::trigger_key t, F&& f) {
+	if(!t)
+		return;
+	auto data = state.trigger_data.data() + state.trigger_data_indices[t.index() + 1];
+	if((data[0] & trigger::code_mask) == trigger::generic_scope) {
+		if((data[0] & trigger::is_disjunctive_scope) != 0)
+			return;
+		auto const source_size = 1 + trigger::get_trigger_scope_payload_size(data);
+		auto sub_units_start = data + 2 + trigger::trigger_scope_data_payload(data[0]);
+		while(sub_units_start < data + source_size) {
+			if((sub_units_start[0] & trigger::code_mask) < trigger::first_scope_code)
+				f(sub_units_start);
+			sub_units_start += 1 + trigger::get_trigger_payload_size(sub_units_start);
+		}
+	} else if((data[0] & trigger::code_mask) < trigger::first_scope_code) {
+		f(data);
 	}
-};
-struct event_prov_pair {
-	dcon::province_id p;
-	dcon::free_provincial_event_id e;
+}
+
+bool add_global_condition(trigger_prefilter& f, uint16_t const* tval) {
+	switch(tval[0] & trigger::code_mask) {
+	case trigger::year:
+		restrict_year(f, tval[0], int32_t(tval[1]));
+		return true;
+	case trigger::has_global_flag:
+		f.global_flags.push_back(global_flag_condition{ trigger::payload(tval[1]).glob_id, tests_for_equality(tval[0]) });
+		return true;
+	default:
+		return false;
+	}
+}
 
-	bool operator==(event_prov_pair const& other) const noexcept {
-		return other.p == p && other.e == e;
+bool prefilter_allows_today(sys::state& state, trigger_prefilter const& f) {
+	if(f.min_year != std::numeric_limits<int32_t>::min() || f.max_year != std::numeric_limits<int32_t>::max()) {
+		auto year = int32_t(state.current_date.to_ymd(state.start_date).year);
+		if(year < f.min_year || year > f.max_year)
+			return false;
 	}
-	bool operator<(event_prov_pair const& other) const noexcept {
-		return other.p != p ? (p.value < other.p.value) : (e.value < other.e.value);
+	for(auto& g : f.global_flags) {
+		if(state.national_definitions.is_global_flag_variable_set(g.flag) != g.value)
+			return false;
 	}
-};
+	return true;
+}
+
+bool restricts_candidates(trigger_prefilter const& f) {
+	return bool(f.tag) || bool(f.owned_province) || bool(f.country_flag) || bool(f.province);
+}
+
+// fills blocks with the (sorted, unique) indices of the vector blocks that contain at least one candidate nation
+void find_candidate_nation_blocks(sys::state& state, trigger_prefilter const& f, std::vector<uint32_t>& blocks) {
+	dcon::nation_id single;
+	if(f.tag) {
+		single = state.world.national_identity_get_nation_from_identity_holder(f.tag);
+		if(!single)
+			return;
+	}
+	if(f.owned_province) {
+		auto owner = state.world.province_get_nation_from_province_ownership(f.owned_province);
+		if(!owner || (single && single != owner))
+			return;
+		single = owner;
+	}
+	if(single) {
+		if(!f.country_flag || state.world.nation_get_flag_variables(single, f.country_flag))
+			blocks.push_back(uint32_t(single.index()) / ve::vector_size);
+		return;
+	}
+	assert(f.country_flag);
+	for(auto n : state.world.in_nation) {
+		if(n.get_flag_variables(f.country_flag)) {
+			auto b = uint32_t(n.id.index()) / ve::vector_size;
+			if(blocks.empty() || blocks.back() != b)
+				blocks.push_back(b);
+		}
+	}
+}
+
+void find_candidate_province_blocks(sys::state& state, trigger_prefilter const& f, std::vector<uint32_t>& blocks) {
+	auto owner_passes = [&](dcon::nation_id owner) {
+		if(!owner)
+			return false;
+		if(f.tag && state.world.nation_get_identity_from_identity_holder(owner) != f.tag)
+			return false;
+		if(f.owned_province && state.world.province_get_nation_from_province_ownership(f.owned_province) != owner)
+			return false;
+		if(f.country_flag && !state.world.nation_get_flag_variables(owner, f.country_flag))
+			return false;
+		return true;
+	};
+	auto add_owned_provinces = [&](dcon::nation_id owner) {
+		for(auto o : state.world.nation_get_province_ownership(owner)) {
+			blocks.push_back(uint32_t(o.get_province().id.index()) / ve::vector_size);
+		}
+	};
+
+	if(f.province) {
+		if(owner_passes(state.world.province_get_nation_from_province_ownership(f.province)))
+			blocks.push_back(uint32_t(f.province.index()) / ve::vector_size);
+		return;
+	} else if(f.tag) {
+		auto holder = state.world.national_identity_get_nation_from_identity_holder(f.tag);
+		if(owner_passes(holder))
+			add_owned_provinces(holder);
+	} else if(f.owned_province) {
+		auto owner = state.world.province_get_nation_from_province_ownership(f.owned_province);
+		if(owner_passes(owner))
+			add_owned_provinces(owner);
+	} else {
+		assert(f.country_flag);
+		for(auto n : state.world.in_nation) {
+			if(n.get_flag_variables(f.country_flag))
+				add_owned_provinces(n);
+		}
+	}
+	std::sort(blocks.begin(), blocks.end());
+	blocks.erase(std::unique(blocks.begin(), blocks.end()), blocks.end());
+}
+
+trigger_prefilter make_national_prefilter(sys::state& state, dcon::trigger_key t) {
+	trigger_prefilter f;
+	for_each_top_level_conjunct(state, t, [&](uint16_t const* tval) {
+		if(add_global_condition(f, tval))
+			return;
+		switch(tval[0] & trigger::code_mask) {
+		case trigger::tag_tag:
+			if(tests_for_equality(tval[0]))
+				f.tag = trigger::payload(tval[1]).tag_id;
+			break;
+		case trigger::owns:
+			if(tests_for_equality(tval[0]))
+				f.owned_province = trigger::payload(tval[1]).prov_id;
+			break;
+		case trigger::has_country_flag:
+			if(tests_for_equality(tval[0]))
+				f.country_flag = trigger::payload(tval[1]).natf_id;
+			break;
+		default:
+			break;
+		}
+	});
+	return f;
+}
+
+trigger_prefilter make_provincial_prefilter(sys::state& state, dcon::trigger_key t) {
+	trigger_prefilter f;
+	for_each_top_level_conjunct(state, t, [&](uint16_t const* tval) {
+		if(add_global_condition(f, tval))
+			return;
+		switch(tval[0] & trigger::code_mask) {
+		case trigger::province_id:
+			if(tests_for_equality(tval[0]))
+				f.province = trigger::payload(tval[1]).prov_id;
+			break;
+		case trigger::owns_province:
+			if(tests_for_equality(tval[0]))
+				f.owned_province = trigger::payload(tval[1]).prov_id;
+			break;
+		case trigger::has_country_flag_province:
+			if(tests_for_equality(tval[0]))
+				f.country_flag = trigger::payload(tval[1]).natf_id;
+			break;
+		default:
+			break;
+		}
+	});
+	return f;
+}
+
+void rebuild_trigger_prefilters(sys::state& state) {
+	state.event_prefilters.national.resize(state.world.free_national_event_size());
+	for(auto e : state.world.in_free_national_event) {
+		state.event_prefilters.national[e] = make_national_prefilter(state, e.get_trigger());
+	}
+	state.event_prefilters.provincial.resize(state.world.free_provincial_event_size());
+	for(auto e : state.world.in_free_provincial_event) {
+		state.event_prefilters.provincial[e] = make_provincial_prefilter(state, e.get_trigger());
+	}
+}
+
+void find_triggered_events(sys::state& state, dcon::free_national_event_id id, std::vector<event_nation_pair>& out, bool use_prefilter) {
+	auto mod = state.world.free_national_event_get_mtth(id);
+	auto t = state.world.free_national_event_get_trigger(id);
+	auto i = uint32_t(id.index());
+
+	if(state.world.free_national_event_get_only_once(id) == true && state.world.free_national_event_get_has_been_triggered(id) == true)
+		return;
+
+	auto evaluate_block = [&](auto ids) {
+		/*
+		For national events: the base factor (scaled to days) is multiplied with all modifiers that hold. If the value is
+		non positive, we take the probability of the event occurring as 0.000001. If the value is less than 0.001, the
+		event is guaranteed to happen. Otherwise, the probability is the multiplicative inverse of the value.
+		*/
+		auto some_exist = t
+			? (state.world.nation_get_owned_province_count(ids) != 0) && trigger::evaluate(state, t, trigger::to_generic(ids), trigger::to_generic(ids), 0)
+			: (state.world.nation_get_owned_province_count(ids) != 0);
+		if(ve::compress_mask(some_exist).v != 0) {
+			auto chances = mod ?
+				trigger::evaluate_multiplicative_modifier(state, mod, trigger::to_generic(ids), trigger::to_generic(ids), 0) : ve::fp_vector{ 1.0f };
+			auto adj_chance = 1.0f - ve::select(chances <= 1.0f, 1.0f, 1.0f / (chances));
+			auto adj_chance_2 = adj_chance * adj_chance;
+			auto adj_chance_4 = adj_chance_2 * adj_chance_2;
+			auto adj_chance_8 = adj_chance_4 * adj_chance_4;
+			auto adj_chance_16 = adj_chance_8 * adj_chance_8;
+
+			ve::apply(
+					[&](dcon::nation_id n, float c, bool condition) {
+						auto owned_range = state.world.nation_get_province_ownership(n);
+						if(condition && owned_range.begin() != owned_range.end()) {
+							if(float(rng::get_random(state, uint32_t((i << 1) ^ n.index())) & 0xFFFFFF) / float(0xFFFFFF + 1) >= c) {
+								out.push_back(event_nation_pair{n, id});
+							}
+						}
+					},
+					ids, adj_chance_16, some_exist);
+		}
+	};
+
+	if(use_prefilter && uint32_t(state.event_prefilters.national.size()) > i) {
+		auto const& f = state.event_prefilters.national[id];
+		if(!prefilter_allows_today(state, f))
+			return;
+		if(restricts_candidates(f)) {
+			std::vector<uint32_t> blocks;
+			find_candidate_nation_blocks(state, f, blocks);
+			for(auto b : blocks) {
+				evaluate_block(ve::contiguous_tags<dcon::nation_id>(b * ve::vector_size));
+			}
+			return;
+		}
+	}
+	ve::execute_serial_fast<dcon::nation_id>(state.world.nation_size(), evaluate_block);
+}
+
+void find_triggered_events(sys::state& state, dcon::free_provincial_event_id id, std::vector<event_prov_pair>& out, bool use_prefilter) {
+	auto mod = state.world.free_provincial_event_get_mtth(id);
+	auto t = state.world.free_provincial_event_get_trigger(id);
+	auto i = uint32_t(id.index());
+
+	if(state.world.free_provincial_event_get_only_once(id) == true && state.world.free_provincial_event_get_has_been_triggered(id) == true)
+		return;
+
+	auto evaluate_block = [&](ve::contiguous_tags<dcon::province_id> ids) {
+		/*
+		The probabilities for province events are calculated in the same way, except that they are twice as likely to
+		happen.
+		*/
+		auto owners = state.world.province_get_nation_from_province_ownership(ids);
+		auto some_exist = t ? (owners != dcon::nation_id{}) &&
+			trigger::evaluate(state, t, trigger::to_generic(ids), trigger::to_generic(owners), 0)
+			: (owners != dcon::nation_id{});
+		if(ve::compress_mask(some_exist).v != 0) {
+			auto chances = mod
+				? trigger::evaluate_multiplicative_modifier(state, mod, trigger::to_generic(ids), trigger::to_generic(owners), 0)
+				: ve::fp_vector{ 2.0f };
+			auto adj_chance = 1.0f - ve::select(chances <= 2.0f, 1.0f, 2.0f / chances);
+			auto adj_chance_2 = adj_chance * adj_chance;
+			auto adj_chance_4 = adj_chance_2 * adj_chance_2;
+			auto adj_chance_8 = adj_chance_4 * adj_chance_4;
+			auto adj_chance_16 = adj_chance_8 * adj_chance_8;
+
+			ve::apply(
+					[&](dcon::province_id p, dcon::nation_id o, float c, bool condition) {
+						if(condition) {
+							if(float(rng::get_random(state, uint32_t((i << 1) ^ p.index())) & 0xFFFFFF) / float(0xFFFFFF + 1) >= c) {
+								out.push_back(event_prov_pair{ p, id });
+							}
+						}
+					},
+					ids, owners, adj_chance_16, some_exist);
+		}
+	};
+
+	auto const land_province_count = uint32_t(state.province_definitions.first_sea_province.index());
+	if(use_prefilter && uint32_t(state.event_prefilters.provincial.size()) > i) {
+		auto const& f = state.event_prefilters.provincial[id];
+		if(!prefilter_allows_today(state, f))
+			return;
+		if(restricts_candidates(f)) {
+			std::vector<uint32_t> blocks;
+			find_candidate_province_blocks(state, f, blocks);
+			for(auto b : blocks) {
+				if(b * ve::vector_size < land_province_count)
+					evaluate_block(ve::contiguous_tags<dcon::province_id>(b * ve::vector_size));
+			}
+			return;
+		}
+	}
+	ve::execute_serial_fast<dcon::province_id>(land_province_count, evaluate_block);
+}
 
 void update_events(sys::state& state) {
 	for(uint32_t j = uint32_t(state.future_n_event.size()); j-- > 0;) {
@@ -463,41 +769,7 @@ void update_events(sys::state& state) {
 	auto n_block_end = block_index == 31 ? state.world.free_national_event_size() : n_block_size * (block_index + 1);
 	concurrency::parallel_for(n_block_size * block_index, n_block_end, [&](uint32_t i) {
 		dcon::free_national_event_id id{dcon::national_event_id::value_base_t(i)};
-		auto mod = state.world.free_national_event_get_mtth(id);
-		auto t = state.world.free_national_event_get_trigger(id);
-
-		if(state.world.free_national_event_get_only_once(id) == false || state.world.free_national_event_get_has_been_triggered(id) == false) {
-			ve::execute_serial_fast<dcon::nation_id>(state.world.nation_size(), [&](auto ids) {
-				/*
-				For national events: the base factor (scaled to days) is multiplied with all modifiers that hold. If the value is
-				non positive, we take the probability of the event occurring as 0.000001. If the value is less than 0.001, the
-				event is guaranteed to happen. Otherwise, the probability is the multiplicative inverse of the value.
-				*/
-				auto some_exist = t
-					? (state.world.nation_get_owned_province_count(ids) != 0) && trigger::evaluate(state, t, trigger::to_generic(ids), trigger::to_generic(ids), 0)
-					: (state.world.nation_get_owned_province_count(ids) != 0);
-				if(ve::compress_mask(some_exist).v != 0) {
-					auto chances = mod ?
-						trigger::evaluate_multiplicative_modifier(state, mod, trigger::to_generic(ids), trigger::to_generic(ids), 0) : ve::fp_vector{ 1.0f };
-					auto adj_chance = 1.0f - ve::select(chances <= 1.0f, 1.0f, 1.0f / (chances));
-					auto adj_chance_2 = adj_chance * adj_chance;
-					auto adj_chance_4 = adj_chance_2 * adj_chance_2;
-					auto adj_chance_8 = adj_chance_4 * adj_chance_4;
-					auto adj_chance_16 = adj_chance_8 * adj_chance_8;
-
-					ve::apply(
-							[&](dcon::nation_id n, float c, bool condition) {
-								auto owned_range = state.world.nation_get_province_ownership(n);
-								if(condition && owned_range.begin() != owned_range.end()) {
-									if(float(rng::get_random(state, uint32_t((i << 1) ^ n.index())) & 0xFFFFFF) / float(0xFFFFFF + 1) >= c) {
-										events_triggered.local().push_back(event_nation_pair{n, id});
-									}
-								}
-							},
-							ids, adj_chance_16, some_exist);
-				}
-			});
-		}
+		find_triggered_events(state, id, events_triggered.local());
 	});
 
 	auto total_vector = events_triggered.combine([](auto& a, auto& b) {
@@ -515,42 +787,7 @@ void update_events(sys::state& state) {
 	auto p_block_end = block_index == 31 ? state.world.free_provincial_event_size() : p_block_size * (block_index + 1);
 	concurrency::parallel_for(p_block_size * block_index, p_block_end, [&](uint32_t i) {
 		dcon::free_provincial_event_id id{dcon::free_provincial_event_id::value_base_t(i)};
-		auto mod = state.world.free_provincial_event_get_mtth(id);
-		auto t = state.world.free_provincial_event_get_trigger(id);
-
-		if(state.world.free_provincial_event_get_only_once(id) == false || state.world.free_provincial_event_get_has_been_triggered(id) == false) {
-			ve::execute_serial_fast<dcon::province_id>(uint32_t(state.province_definitions.first_sea_province.index()),
-					[&](ve::contiguous_tags<dcon::province_id> ids) {
-						/*
-						The probabilities for province events are calculated in the same way, except that they are twice as likely to
-						happen.
-						*/
-						auto owners = state.world.province_get_nation_from_province_ownership(ids);
-						auto some_exist = t ? (owners != dcon::nation_id{}) &&
-							trigger::evaluate(state, t, trigger::to_generic(ids), trigger::to_generic(owners), 0)
-							: (owners != dcon::nation_id{});
-						if(ve::compress_mask(some_exist).v != 0) {
-							auto chances = mod
-								? trigger::evaluate_multiplicative_modifier(state, mod, trigger::to_generic(ids), trigger::to_generic(owners), 0)
-								: ve::fp_vector{ 2.0f };
-							auto adj_chance = 1.0f - ve::select(chances <= 2.0f, 1.0f, 2.0f / chances);
-							auto adj_chance_2 = adj_chance * adj_chance;
-							auto adj_chance_4 = adj_chance_2 * adj_chance_2;
-							auto adj_chance_8 = adj_chance_4 * adj_chance_4;
-							auto adj_chance_16 = adj_chance_8 * adj_chance_8;
-
-							ve::apply(
-									[&](dcon::province_id p, dcon::nation_id o, float c, bool condition) {
-										if(condition) {
-											if(float(rng::get_random(state, uint32_t((i << 1) ^ p.index())) & 0xFFFFFF) / float(0xFFFFFF + 1) >= c) {
-												p_events_triggered.local().push_back(event_prov_pair{ p, id });
-											}
-										}
-									},
-									ids, owners, adj_chance_16, some_exist);
-						}
-					});
-		}
+		find_triggered_events(state, id, p_events_triggered.local());
 	});
 
 	auto total_p_vector = p_events_triggered.combine([](auto& a, auto& b) {
@@ -65,6 +65,62 @@ void take_option(sys::state& state, pending_human_f_n_event const& e, uint8_t op
 void take_option(sys::state& state, pending_human_p_event const& e, uint8_t opt);
 void take_option(sys::state& state, pending_human_f_p_event const& e, uint8_t opt);
 
+/*
+A conservative summary of the cheap top-level conjuncts of a free event's trigger. Conditions on the global state (the current
+year, global flags) rule the event out for everyone at once, while a required tag, owned province or country flag restricts the
+nations / provinces that may possibly pass the trigger. Anything that the full trigger would accept is always a candidate, and
+the full trigger is still evaluated for the candidates, so using the prefilter never changes which events fire.
+*/
+struct global_flag_condition {
+	dcon::global_flag_id flag;
+	bool value = true;
+};
+struct trigger_prefilter {
+	std::vector<global_flag_condition> global_flags;
+	int32_t min_year = std::numeric_limits<int32_t>::min();
+	int32_t max_year = std::numeric_limits<int32_t>::max();
+	dcon::national_identity_id tag;     // the nation (or province owner) must hold this tag
+	dcon::province_id owned_province;   // the nation (or province owner) must own this province
+	dcon::national_flag_id country_flag; // the nation (or province owner) must have this flag set
+	dcon::province_id province;         // provincial events only: the province must be this one
+};
+struct trigger_prefilter_index {
+	tagged_vector<trigger_prefilter, dcon::free_national_event_id> national;
+	tagged_vector<trigger_prefilter, dcon::free_provincial_event_id> provincial;
+};
+
+trigger_prefilter make_national_prefilter(sys::state& state, dcon::trigger_key t);
+trigger_prefilter make_provincial_prefilter(sys::state& state, dcon::trigger_key t);
+void rebuild_trigger_prefilters(sys::state& state); // to be called after the scenario has been loaded
+
+struct event_nation_pair {
+	dcon::nation_id n;
+	dcon::free_national_event_id e;
+
+	bool operator==(event_nation_pair const& other) const noexcept {
+		return other.n == n && other.e == e;
+	}
+	bool operator<(event_nation_pair const& other) const noexcept {
+		return other.n != n ? (n.value < other.n.value) : (e.value < other.e.value);
+	}
+};
+struct event_prov_pair {
+	dcon::province_id p;
+	dcon::free_provincial_event_id e;
+
+	bool operator==(event_prov_pair const& other) const noexcept {
+		return other.p == p && other.e == e;
+	}
+	bool operator<(event_prov_pair const& other) const noexcept {
+		return other.p != p ? (p.value < other.p.value) : (e.value < other.e.value);
+	}
+};
+
+// appends the nations / provinces for which the event fires today; with use_prefilter == false the trigger is evaluated for
+// every nation / province, which is used to check that the prefilter does not change the results
+void find_triggered_events(sys::state& state, dcon::free_national_event_id id, std::vector<event_nation_pair>& out, bool use_prefilter = true);
+void find_triggered_events(sys::state& state, dcon::free_provincial_event_id id, std::vector<event_prov_pair>& out, bool use_prefilter = true);
+
 void update_events(sys::state& state);
 
 } // namespace event
@@ -7229,6 +7229,111 @@ bool evaluate(sys::state& state, uint16_t const* data, int32_t primary, int32_t
 	return test_trigger_generic<bool>(data, state, primary, this_slot, from_slot);
 }
 
+struct memo_key {
+	uint64_t key_and_primary = 0;
+	uint64_t this_and_from = 0;
+
+	bool operator==(memo_key const& other) const noexcept {
+		return key_and_primary == other.key_and_primary && this_and_from == other.this_and_from;
+	}
+};
+struct memo_key_hash {
+	using is_avalanching = void;
+
+	auto operator()(memo_key const& k) const noexcept -> uint64_t {
+		return ankerl::unordered_dense::detail::wyhash::mix(k.key_and_primary, k.this_and_from);
+	}
+};
+struct memo_table {
+	ankerl::unordered_dense::map<memo_key, bool, memo_key_hash> results;
+	sys::state const* owner = nullptr;
+	uint32_t generation = 0;
+};
+
+inline constexpr size_t max_memoized_results = 1 << 16;
+
+thread_local memo_table local_memo_table;
+std::atomic<uint64_t> memo_hits = 0;
+std::atomic<uint64_t> memo_misses = 0;
+std::atomic<uint64_t> memo_volatile_evaluations = 0;
+
+bool evaluate_memoized(sys::state& state, dcon::trigger_key key, int32_t primary, int32_t this_slot, int32_t from_slot) {
+	if(size_t(key.index()) < state.trigger_is_volatile.size() && state.trigger_is_volatile[key.index()] != 0) {
+		memo_volatile_evaluations.fetch_add(1, std::memory_order_relaxed);
+		return evaluate(state, key, primary, this_slot, from_slot);
+	}
+
+	auto& table = local_memo_table;
+	auto generation = state.trigger_memo_generation.load(std::memory_order_acquire);
+	if(table.owner != &state || table.generation != generation || table.results.size() >= max_memoized_results) {
+		table.results.clear();
+		table.owner = &state;
+		table.generation = generation;
+	}
+
+	memo_key k{ (uint64_t(key.value) << 32) | uint64_t(uint32_t(primary)), (uint64_t(uint32_t(this_slot)) << 32) | uint64_t(uint32_t(from_slot)) };
+	if(auto it = table.results.find(k); it != table.results.end()) {
+		memo_hits.fetch_add(1, std::memory_order_relaxed);
+		return it->second;
+	}
+	memo_misses.fetch_add(1, std::memory_order_relaxed);
+	auto result = evaluate(state, key, primary, this_slot, from_slot);
+	table.results.insert_or_assign(k, result);
+	return result;
+}
+
+void invalidate_memoized_results(sys::state& state) {
+	state.trigger_memo_generation.fetch_add(1, std::memory_order_acq_rel);
+}
+
+bool is_volatile_trigger_code(uint16_t code) {
+	// these read the rebel faction in the from slot, which may be a scratch faction that is recreated with the same id
+	if((code & trigger::code_mask) >= trigger::first_scope_code)
+		return (code & trigger::code_mask) == trigger::independence_scope;
+	switch(code & trigger::code_mask) {
+	case trigger::culture_pop_reb:
+	case trigger::culture_state_reb:
+	case trigger::culture_province_reb:
+	case trigger::culture_nation_reb:
+	case trigger::culture_group_reb_nation:
+	case trigger::culture_group_reb_pop:
+	case trigger::religion_reb:
+	case trigger::religion_nation_reb:
+	case trigger::is_cultural_union_this_rebel:
+	case trigger::is_core_reb:
+	case trigger::controlled_by_reb:
+	case trigger::political_movement_from_reb:
+	case trigger::social_movement_from_reb:
+		return true;
+	default:
+		return false;
+	}
+}
+
+void classify_volatile_triggers(sys::state& state) {
+	auto count = state.trigger_data_indices.size() > 0 ? state.trigger_data_indices.size() - 1 : size_t(0);
+	state.trigger_is_volatile.clear();
+	state.trigger_is_volatile.resize(count, uint8_t(0));
+	for(size_t i = 0; i < count; ++i) {
+		bool is_volatile = false;
+		trigger::recurse_over_triggers(state.trigger_data.data() + state.trigger_data_indices[i + 1], [&](uint16_t* t) {
+			if(is_volatile_trigger_code(t[0]))
+				is_volatile = true;
+		});
+		state.trigger_is_volatile[i] = uint8_t(is_volatile ? 1 : 0);
+	}
+	invalidate_memoized_results(state);
+}
+
+memo_statistics get_memo_statistics() {
+	return memo_statistics{ memo_hits.load(std::memory_order_relaxed), memo_misses.load(std::memory_order_relaxed), memo_volatile_evaluations.load(std::memory_order_relaxed) };
+}
+void reset_memo_statistics() {
+	memo_hits.store(0, std::memory_order_relaxed);
+	memo_misses.store(0, std::memory_order_relaxed);
+	memo_volatile_evaluations.store(0, std::memory_order_relaxed);
+}
+
 ve::mask_vector evaluate(sys::state& state, dcon::trigger_key key, ve::contiguous_tags<int32_t> primary,
 		ve::tagged_vector<int32_t> this_slot, int32_t from_slot) {
 	return test_trigger_generic<ve::mask_vector>(state.trigger_data.data() + state.trigger_data_indices[key.index() + 1], state,
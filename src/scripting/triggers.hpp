@@ -189,4 +189,24 @@ ve::mask_vector evaluate(sys::state& state, dcon::trigger_key key, ve::contiguou
 		ve::contiguous_tags<int32_t> this_slot, int32_t from_slot);
 ve::mask_vector evaluate(sys::state& state, uint16_t const* data, ve::contiguous_tags<int32_t> primary,
 		ve::contiguous_tags<int32_t> this_slot, int32_t from_slot);
+
+/*
+Opt-in memoization of the scalar evaluation of stored triggers. Results are remembered per thread and are thrown away at the
+start and end of every tick, after every command and after every executed effect. Other changes made in the middle of a tick
+(the daily updates themselves) do not throw them away, so do not use this from within the tick. Triggers that read scratch
+entities (such as the temporary rebel factions created while updating rebel membership) are marked as volatile and are never
+memoized. Only use this where the same trigger is likely to be asked about more than once before the state changes again, e.g.
+by the ui or when sorting by a trigger.
+*/
+bool evaluate_memoized(sys::state& state, dcon::trigger_key key, int32_t primary, int32_t this_slot, int32_t from_slot);
+void invalidate_memoized_results(sys::state& state);
+void classify_volatile_triggers(sys::state& state); // to be called after the scenario has been loaded
+
+struct memo_statistics {
+	uint64_t hits = 0;
+	uint64_t misses = 0;
+	uint64_t volatile_evaluations = 0;
+};
+memo_statistics get_memo_statistics();
+void reset_memo_statistics();
 } // namespace trigger
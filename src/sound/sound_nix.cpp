@@ -1,3 +1,4 @@
+#include <cstring>
 #include "sound.hpp"
 #include "system_state.hpp"
 
@@ -15,42 +16,256 @@
 
 namespace sound {
 
-sound_impl::sound_impl() {
-	if(ma_engine_init(NULL, &engine) != MA_SUCCESS) {
+namespace {
+
+ma_result music_read(ma_data_source* source, void* frames_out, ma_uint64 frame_count, ma_uint64* frames_read) {
+	auto& m = *reinterpret_cast<music_source*>(source)->owner;
+	if(m.flush_requested.load(std::memory_order::acquire)) {
+		ma_pcm_rb_seek_read(&m.buffer, ma_pcm_rb_available_read(&m.buffer));
+		m.flush_requested.store(false, std::memory_order::release);
+	}
+
+	auto frame_size = ma_get_bytes_per_frame(m.format, m.channels);
+	ma_uint64 total = 0;
+	while(total < frame_count) {
+		auto count = ma_uint32(std::min(frame_count - total, ma_uint64(0xFFFFFFFF)));
+		void* buffered = nullptr;
+		if(ma_pcm_rb_acquire_read(&m.buffer, &count, &buffered) != MA_SUCCESS || count == 0)
+			break;
+		std::memcpy(static_cast<uint8_t*>(frames_out) + total * frame_size, buffered, size_t(count) * frame_size);
+		ma_pcm_rb_commit_read(&m.buffer, count);
+		total += count;
+	}
+	if(total < frame_count) {
+		if(!m.track_done.load(std::memory_order::acquire))
+			m.underruns.fetch_add(1, std::memory_order::relaxed);
+		ma_silence_pcm_frames(static_cast<uint8_t*>(frames_out) + total * frame_size, frame_count - total, m.format, m.channels);
+	}
+	// between tracks the music plays silence instead of ending, so that it never has to be restarted
+	if(frames_read)
+		*frames_read = frame_count;
+	return MA_SUCCESS;
+}
+
+ma_result music_data_format(ma_data_source* source, ma_format* format, ma_uint32* channels, ma_uint32* sample_rate,
+		ma_channel* channel_map, size_t channel_map_capacity) {
+	auto& m = *reinterpret_cast<music_source*>(source)->owner;
+	*format = m.format;
+	*channels = m.channels;
+	*sample_rate = m.sample_rate;
+	ma_channel_map_init_standard(ma_standard_channel_map_default, channel_map, channel_map_capacity, m.channels);
+	return MA_SUCCESS;
+}
+
+ma_data_source_vtable const music_vtable = {music_read, nullptr, music_data_format, nullptr, nullptr, nullptr, 0};
+
+inline constexpr ma_uint32 music_decode_chunk = 4096; // frames
+
+} // namespace
+
+bool music_stream::start(ma_engine& engine, ma_allocation_callbacks const& callbacks) {
+	allocation_callbacks = callbacks;
+	channels = ma_engine_get_channels(&engine);
+	sample_rate = ma_engine_get_sample_rate(&engine);
+	source.owner = this;
+
+	if(ma_pcm_rb_init(format, channels, sample_rate, nullptr, &allocation_callbacks, &buffer) != MA_SUCCESS)
+		return false;
+	auto config = ma_data_source_config_init();
+	config.vtable = &music_vtable;
+	if(ma_data_source_init(&config, &source.base) != MA_SUCCESS) {
+		ma_pcm_rb_uninit(&buffer);
+		return false;
+	}
+	if(ma_sound_init_from_data_source(&engine, &source.base, 0, nullptr, &sound) != MA_SUCCESS) {
+		ma_data_source_uninit(&source.base);
+		ma_pcm_rb_uninit(&buffer);
+		return false;
+	}
+
+	initialized = true;
+	decoder_thread = std::thread([this]() { decoder_loop(); });
+	return true;
+}
+
+void music_stream::stop() {
+	if(!initialized)
+		return;
+	{
+		std::lock_guard lock(request_lock);
+		quit = true;
+	}
+	request_ready.notify_one();
+	decoder_thread.join();
+
+	ma_sound_uninit(&sound);
+	ma_data_source_uninit(&source.base);
+	ma_pcm_rb_uninit(&buffer);
+	initialized = false;
+}
+
+void music_stream::play_file(native_string const& file_name) {
+	{
+		std::lock_guard lock(request_lock);
+		requested_file = file_name;
+		++request_count;
+		request_pending.store(true, std::memory_order::release);
+	}
+	request_ready.notify_one();
+}
+
+bool music_stream::finished() {
+	// the decoder clears track_done before request_pending when it opens a track
+	return !request_pending.load(std::memory_order::acquire) && track_done.load(std::memory_order::acquire)
+		&& !flush_requested.load(std::memory_order::acquire) && (!initialized || ma_pcm_rb_available_read(&buffer) == 0);
+}
+
+void music_stream::decoder_loop() {
+	ma_decoder decoder;
+	bool open = false;
+	uint32_t handled_count = 0;
+
+	while(true) {
+		native_string file;
+		bool new_track = false;
+		{
+			std::lock_guard lock(request_lock);
+			if(quit)
+				break;
+			if(request_count != handled_count) {
+				file = requested_file;
+				handled_count = request_count;
+				new_track = true;
+			}
+		}
+
+		if(new_track) {
+			if(open)
+				ma_decoder_uninit(&decoder);
+			auto config = ma_decoder_config_init(format, channels, sample_rate);
+			config.allocationCallbacks = allocation_callbacks;
+			open = ma_decoder_init_file(file.c_str(), &config, &decoder) == MA_SUCCESS;
+			flush_requested.store(true, std::memory_order::release);
+			track_done.store(!open, std::memory_order::release);
+
+			std::lock_guard lock(request_lock);
+			if(request_count == handled_count)
+				request_pending.store(false, std::memory_order::release);
+		}
+
+		// nothing is written until the audio thread has thrown away what was left of the previous track
+		bool wrote = false;
+		if(open && !track_done.load(std::memory_order::relaxed) && !flush_requested.load(std::memory_order::acquire)) {
+			ma_uint32 count = std::min(ma_pcm_rb_available_write(&buffer), music_decode_chunk);
+			void* destination = nullptr;
+			if(count > 0 && ma_pcm_rb_acquire_write(&buffer, &count, &destination) == MA_SUCCESS && count > 0) {
+				ma_uint64 decoded = 0;
+				auto result = ma_decoder_read_pcm_frames(&decoder, destination, count, &decoded);
+				ma_pcm_rb_commit_write(&buffer, ma_uint32(decoded));
+				if(result != MA_SUCCESS || decoded < count)
+					track_done.store(true, std::memory_order::release);
+				wrote = decoded > 0;
+			}
+		}
+		if(!wrote) {
+			std::unique_lock lock(request_lock);
+			request_ready.wait_for(lock, std::chrono::milliseconds(5), [&]() { return quit || request_count != handled_count; });
+		}
+	}
+
+	if(open)
+		ma_decoder_uninit(&decoder);
+}
+
+sound_impl::sound_impl() : sound_impl(ma_engine_config_init()) { }
+
+sound_impl::sound_impl(ma_engine_config const& config) {
+	if(ma_engine_init(&config, &engine) != MA_SUCCESS) {
 		std::abort();
 	}
+	allocation_callbacks = engine.allocationCallbacks; // with the defaults filled in
+	music.start(engine, allocation_callbacks);
 }
 
 sound_impl::~sound_impl() {
+	music.stop();
+	for(auto& c : clips) {
+		ma_sound_uninit(&c->voice);
+		ma_audio_buffer_ref_uninit(&c->source);
+		ma_free(c->frames, &allocation_callbacks);
+	}
+	clips.clear();
 	ma_engine_uninit(&engine);
 }
 
-void sound_impl::set_volume(std::optional<ma_sound>& sound, float volume) {
-	if(sound.has_value()) {
-		ma_sound_set_volume(&*sound, volume);
-	}
+void sound_impl::load_effect(audio_instance& s) {
+	s.clip = nullptr;
+	if(s.filename.empty())
+		return;
+
+	auto channels = ma_engine_get_channels(&engine);
+	auto sample_rate = ma_engine_get_sample_rate(&engine);
+	auto config = ma_decoder_config_init(ma_format_f32, channels, sample_rate);
+	config.allocationCallbacks = allocation_callbacks;
+	auto clip = std::make_unique<effect_clip>();
+	if(ma_decode_file(s.filename.c_str(), &config, &clip->frame_count, &clip->frames) != MA_SUCCESS)
+		return;
+	if(ma_audio_buffer_ref_init(ma_format_f32, channels, clip->frames, clip->frame_count, &clip->source) != MA_SUCCESS) {
+		ma_free(clip->frames, &allocation_callbacks);
+		return;
+	}
+	clip->source.sampleRate = sample_rate;
+	if(ma_sound_init_from_data_source(&engine, &clip->source, 0, nullptr, &clip->voice) != MA_SUCCESS) {
+		ma_audio_buffer_ref_uninit(&clip->source);
+		ma_free(clip->frames, &allocation_callbacks);
+		return;
+	}
+	s.clip = clip.get();
+	clips.push_back(std::move(clip));
 }
 
-void sound_impl::override_sound(std::optional<ma_sound>& sound, audio_instance& s, float volume) {
-	if(sound.has_value()) {
-		ma_sound_uninit(&*sound);
+void sound_impl::load_effects() {
+	audio_instance* effects[] = {&click_sound, &technology_finished_sound, &army_move_sound, &army_select_sound, &navy_move_sound,
+		&navy_select_sound, &declaration_of_war_sound, &chat_message_sound, &error_sound, &peace_sound, &army_built_sound,
+		&navy_built_sound, &factory_built_sound, &election_sound, &revolt_sound, &fort_built_sound, &railroad_built_sound,
+		&naval_base_built_sound, &minor_event_sound, &major_event_sound, &decline_sound, &accept_sound, &diplomatic_request_sound};
+	for(auto* e : effects)
+		load_effect(*e);
+	for(auto& e : land_battle_sounds)
+		load_effect(e);
+	for(auto& e : naval_battle_sounds)
+		load_effect(e);
+}
+
+void sound_impl::set_volume(effect_clip* clip, float volume) {
+	if(clip) {
+		ma_sound_set_volume(&clip->voice, volume);
 	}
+}
 
-	sound.reset();
-	sound.emplace();
-	ma_result result = ma_sound_init_from_file(&engine, s.filename.c_str(), 0, NULL, NULL, &*sound);
-	if(result == MA_SUCCESS) {
-		set_volume(sound, volume);
-		ma_sound_start(&*sound);
+void sound_impl::override_sound(effect_clip*& current, audio_instance& s, float volume) {
+	if(current && current != s.clip) {
+		ma_sound_stop(&current->voice);
 	}
+	current = s.clip;
+	if(!current)
+		return;
+
+	// a voice that has played to its end is still marked as playing until the audio thread gets to it, so stop it first;
+	// the seek is carried out by the audio thread, before it next reads from the clip
+	ma_sound_stop(&current->voice);
+	ma_sound_seek_to_pcm_frame(&current->voice, 0);
+	set_volume(current, volume);
+	ma_sound_start(&current->voice);
 }
 
 void sound_impl::play_music(int32_t track, float volume) {
 	current_music = track;
-
-	audio_instance audio{};
-	audio.filename = music_list[track].filename.c_str();
-	override_sound(music, audio, volume);
+	music.play_file(music_list[track].filename);
+	if(music.initialized) {
+		ma_sound_set_volume(&music.sound, volume);
+		ma_sound_start(&music.sound);
+	}
 }
 
 void sound_impl::play_new_track(sys::state& s, float v) {
@@ -63,9 +278,7 @@ void sound_impl::play_new_track(sys::state& s, float v) {
 }
 
 bool sound_impl::music_finished() {
-	if(music.has_value())
-		return music->atEnd;
-	return true;
+	return music.finished();
 }
 
 void initialize_sound_system(sys::state& state) {
@@ -222,32 +435,36 @@ void initialize_sound_system(sys::state& state) {
 		auto file_peek = peek_file(sound_directory, NATIVE("Combat_MinorShip_3.wav"));
 		state.sound_ptr->naval_battle_sounds[5] = (file_peek ? audio_instance(*file_peek) : audio_instance());
 	}
+
+	state.sound_ptr->load_effects();
 }
 void change_effect_volume(sys::state& state, float v) {
-	state.sound_ptr->set_volume(state.sound_ptr->effect_sound, v);
+	state.sound_ptr->set_volume(state.sound_ptr->current_effect, v);
 }
 void change_interface_volume(sys::state& state, float v) {
-	state.sound_ptr->set_volume(state.sound_ptr->interface_sound, v);
+	state.sound_ptr->set_volume(state.sound_ptr->current_interface_sound, v);
 }
 void change_music_volume(sys::state& state, float v) {
-	state.sound_ptr->set_volume(state.sound_ptr->music, v);
+	if(state.sound_ptr->music.initialized) {
+		ma_sound_set_volume(&state.sound_ptr->music.sound, v);
+	}
 }
 
 void play_effect(sys::state& state, audio_instance& s, float volume) {
-	state.sound_ptr->override_sound(state.sound_ptr->effect_sound, s, volume);
+	state.sound_ptr->override_sound(state.sound_ptr->current_effect, s, volume);
 }
 void play_interface_sound(sys::state& state, audio_instance& s, float volume) {
-	state.sound_ptr->override_sound(state.sound_ptr->interface_sound, s, volume);
+	state.sound_ptr->override_sound(state.sound_ptr->current_interface_sound, s, volume);
 }
 
 void stop_music(sys::state& state) {
-	if(state.sound_ptr->music.has_value()) {
-		ma_sound_stop(&*state.sound_ptr->music);
+	if(state.sound_ptr->music.initialized) {
+		ma_sound_stop(&state.sound_ptr->music.sound);
 	}
 }
 void start_music(sys::state& state, float v) {
-	if(state.sound_ptr->music.has_value()) {
-		ma_sound_start(&*state.sound_ptr->music);
+	if(state.sound_ptr->music.initialized) {
+		ma_sound_start(&state.sound_ptr->music.sound);
 	}
 }
 void update_music_track(sys::state& state) {
@@ -337,7 +554,7 @@ void play_new_track(sys::state& state) {
 }
 
 native_string get_current_track_name(sys::state& state) {
-	if(state.sound_ptr->music.has_value())
+	if(state.sound_ptr->current_music >= 0)
 		return state.sound_ptr->music_list[state.sound_ptr->current_music].filename;
 	return "";
 }
@@ -1,17 +1,77 @@
 #pragma once
 
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
 #include "system_state.hpp"
 #include "miniaudio.h"
 
 namespace sound {
 
+// a sound effect, decoded once when the sound system starts, with the one voice that plays it
+struct effect_clip {
+	void* frames = nullptr; // f32, interleaved, at the engine's sample rate and channel count
+	ma_uint64 frame_count = 0;
+	ma_audio_buffer_ref source;
+	ma_sound voice;
+};
+
+/*
+Music is decoded on a thread of its own, which keeps a ring buffer of about a second of samples filled ahead of the audio
+thread; the sound that plays the music reads from that buffer. Switching tracks only hands the new file name to the decoder
+thread, so no file is opened and no decoder is created on the thread that asks for the switch. Whatever is still buffered
+from the previous track is discarded by the audio thread the next time it reads, before the decoder writes anything from
+the new one. If the decoder falls behind, the music plays silence rather than stopping.
+*/
+class music_stream;
+struct music_source {
+	ma_data_source_base base; // must come first, see ma_data_source_init
+	music_stream* owner = nullptr;
+};
+
+class music_stream {
+public:
+	music_source source; // what the music sound reads from
+	ma_pcm_rb buffer;
+	ma_sound sound;
+	ma_format format = ma_format_f32;
+	ma_uint32 channels = 0;
+	ma_uint32 sample_rate = 0;
+	ma_allocation_callbacks allocation_callbacks{};
+
+	std::atomic<bool> flush_requested = false; // set by the decoder thread, cleared by the audio thread once the buffer is empty
+	std::atomic<bool> track_done = true;       // the decoder has reached the end of the track, or there is none
+	std::atomic<bool> request_pending = false; // a track has been asked for that the decoder has not opened yet
+	std::atomic<uint64_t> underruns = 0;       // reads during a track that found fewer samples buffered than were asked for
+
+	std::thread decoder_thread;
+	std::mutex request_lock;
+	std::condition_variable request_ready;
+	native_string requested_file; // the following are guarded by request_lock
+	uint32_t request_count = 0;
+	bool quit = false;
+
+	bool initialized = false;
+
+	bool start(ma_engine& engine, ma_allocation_callbacks const& callbacks);
+	void stop();
+	void play_file(native_string const& file_name);
+	bool finished();
+
+private:
+	void decoder_loop();
+};
+
 class audio_instance {
 public:
 	native_string filename;
+	effect_clip* clip = nullptr; // set by load_effects; null if the file could not be decoded
 
 	audio_instance() = default;
 	audio_instance& operator=(audio_instance const& o) {
 		filename = o.filename;
+		clip = o.clip;
 		return *this;
 	}
 	audio_instance(simple_fs::unopened_file const& file) {
@@ -22,11 +82,13 @@ public:
 
 class sound_impl {
 public:
-	std::optional<ma_sound> effect_sound;
-	std::optional<ma_sound> interface_sound;
-	std::optional<ma_sound> music;
+	effect_clip* current_effect = nullptr;
+	effect_clip* current_interface_sound = nullptr;
+	music_stream music;
+	std::vector<std::unique_ptr<effect_clip>> clips;
 
 	ma_engine engine;
+	ma_allocation_callbacks allocation_callbacks{};
 
 	audio_instance click_sound;
 	audio_instance technology_finished_sound;
@@ -60,9 +122,12 @@ public:
 	int32_t current_music = -1;
 
 	sound_impl();
+	sound_impl(ma_engine_config const& config); // for running without a device, see ma_engine_config::noDevice
 	~sound_impl();
-	void set_volume(std::optional<ma_sound>& sound, float volume);
-	void override_sound(std::optional<ma_sound>& sound, audio_instance& s, float volume);
+	void load_effect(audio_instance& s);
+	void load_effects();
+	void set_volume(effect_clip* clip, float volume);
+	void override_sound(effect_clip*& current, audio_instance& s, float volume);
 	void play_music(int32_t track, float volume);
 	void play_new_track(sys::state& s, float v);
 	bool music_finished();
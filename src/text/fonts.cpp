@@ -1117,6 +1117,7 @@ void dead_reckoning(float distance_map[dr_size * dr_size], bool const in_map[dr_
 }
 
 void font_manager::load_font(font& fnt, char const* file_data, uint32_t file_size, font_feature f) {
+	run_cache.clear();
 	fnt.file_data = std::unique_ptr<FT_Byte[]>(new FT_Byte[file_size]);
 	fnt.features = f;
 	memcpy(fnt.file_data.get(), file_data, file_size);
@@ -1141,52 +1142,68 @@ void font_manager::load_font(font& fnt, char const* file_data, uint32_t file_siz
 
 	// load all glyph metrics
 
+	uint32_t glyph_indices[256] = { 0 };
 	for(int32_t i = 0; i < 256; ++i) {
 		auto index_in_this_font = FT_Get_Char_Index(fnt.font_face, win1250toUTF16(char(i)));
 		if(fnt.gs && f == font_feature::small_caps) {
 			index_in_this_font = gsub::perform_glyph_subs(fnt.gs, fnt.substitution_indices, index_in_this_font);
 		}
+		glyph_indices[i] = index_in_this_font;
 		if(index_in_this_font) {
 			FT_Load_Glyph(fnt.font_face, index_in_this_font, FT_LOAD_TARGET_NORMAL);
 			fnt.glyph_advances[i] = static_cast<float>(fnt.font_face->glyph->metrics.horiAdvance) / static_cast<float>((1 << 6) * magnification_factor);
 		}
 	}
-}
-
-float font::kerning(char codepoint_first, char codepoint_second)  {
-	if(auto it = kernings.find(uint16_t((uint16_t(codepoint_first) << 8) | uint16_t(codepoint_second))); it != kernings.end()) {
-		return it->second;
-	}
 
-	auto utf16_first = win1250toUTF16(codepoint_first);
-	auto utf16_second = win1250toUTF16(codepoint_second);
-	auto index_a = FT_Get_Char_Index(font_face, utf16_first);
-	auto index_b = FT_Get_Char_Index(font_face, utf16_second);
+	// text is in a single byte codepage, so the kerning of every possible pair fits in one table
 
-	if(index_a && gs && features == font_feature::small_caps) {
-		index_a = gsub::perform_glyph_subs(gs, substitution_indices, index_a);
-	}
-	if(index_b && gs && features == font_feature::small_caps) {
-		index_b = gsub::perform_glyph_subs(gs, substitution_indices, index_b);
+	fnt.kerning_table = std::unique_ptr<float[]>(new float[256 * 256]());
+	bool const has_kerning = FT_HAS_KERNING(fnt.font_face);
+	for(uint32_t a = 0; a < 256; ++a) {
+		if(glyph_indices[a] == 0)
+			continue;
+		for(uint32_t b = 0; b < 256; ++b) {
+			if(glyph_indices[b] == 0)
+				continue;
+			if(has_kerning) {
+				FT_Vector kerning;
+				FT_Get_Kerning(fnt.font_face, glyph_indices[a], glyph_indices[b], FT_KERNING_DEFAULT, &kerning);
+				fnt.kerning_table[a * 256 + b] = static_cast<float>(kerning.x) / static_cast<float>((1 << 6) * magnification_factor);
+			} else {
+				auto rval = gpos::net_kerning(fnt.type_2_kerning_tables, glyph_indices[a], glyph_indices[b]);
+				fnt.kerning_table[a * 256 + b] = rval * float(64) / float(fnt.font_face->units_per_EM);
+			}
+		}
 	}
+}
 
-	if((index_a == 0) || (index_b == 0)) {
-		kernings.insert_or_assign(uint16_t((uint16_t(codepoint_first) << 8) | uint16_t(codepoint_second)), 0.0f);
-		return 0.0f;
+float const* shaped_run_cache::find(uint64_t hash, uint32_t length, uint16_t font_id) {
+	auto set = entries.data() + (hash % set_count) * ways;
+	for(uint32_t i = 0; i < ways; ++i) {
+		if(set[i].hash == hash && set[i].length == length && set[i].font_id == font_id) {
+			set[i].last_used = ++clock;
+			++hits;
+			return &set[i].extent;
+		}
 	}
+	++misses;
+	return nullptr;
+}
 
-	if(FT_HAS_KERNING(font_face)) {
-		FT_Vector kerning;
-		FT_Get_Kerning(font_face, index_a, index_b, FT_KERNING_DEFAULT, &kerning);
-		auto res = static_cast<float>(kerning.x) / static_cast<float>((1 << 6) * magnification_factor);
-		kernings.insert_or_assign(uint16_t((uint16_t(codepoint_first) << 8) | uint16_t(codepoint_second)), res);
-		return res;
-	} else {
-		auto rval = gpos::net_kerning(type_2_kerning_tables, index_a, index_b);
-		auto res = rval * float(64)  / float(font_face->units_per_EM);
-		kernings.insert_or_assign(uint16_t((uint16_t(codepoint_first) << 8) | uint16_t(codepoint_second)), res);
-		return res;
+void shaped_run_cache::insert(uint64_t hash, uint32_t length, uint16_t font_id, float extent) {
+	auto set = entries.data() + (hash % set_count) * ways;
+	auto* oldest = set;
+	for(uint32_t i = 1; i < ways; ++i) {
+		if(set[i].last_used < oldest->last_used)
+			oldest = set + i;
 	}
+	*oldest = entry{ hash, length, ++clock, extent, font_id };
+}
+
+void shaped_run_cache::clear() {
+	for(auto& e : entries)
+		e = entry{};
+	clock = 0;
 }
 
 float font::line_height(int32_t size) const {
@@ -1213,8 +1230,17 @@ float font_manager::text_extent(sys::state& state, char const* codepoints, uint3
 	if(state.user_settings.use_classic_fonts) {
 		return text::get_bm_font(state, font_id).get_string_width(state, codepoints, count);
 	} else {
-		return float(
+		if(count < shaped_run_cache::min_length) {
+			return float(
+					fonts[text::font_index_from_font_id(font_id) - 1].text_extent(state, codepoints, count, text::size_from_font_id(font_id)));
+		}
+		auto hash = ankerl::unordered_dense::hash<std::string_view>{}(std::string_view(codepoints, count));
+		if(auto cached = run_cache.find(hash, count, font_id); cached)
+			return *cached;
+		auto extent = float(
 				fonts[text::font_index_from_font_id(font_id) - 1].text_extent(state, codepoints, count, text::size_from_font_id(font_id)));
+		run_cache.insert(hash, count, font_id, extent);
+		return extent;
 	}
 }
 
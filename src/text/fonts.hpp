@@ -39,7 +39,7 @@ private:
 
 public:
 	FT_Face font_face;
-	ankerl::unordered_dense::map<uint16_t, float> kernings;
+	std::unique_ptr<float[]> kerning_table; // 256 * 256, indexed by the first character times 256 plus the second
 	std::vector<uint16_t> substitution_indices;
 	std::vector<uint8_t const*> type_2_kerning_tables;
 	uint8_t const* gs = nullptr;
@@ -66,12 +66,48 @@ public:
 	float ascender(int32_t size) const;
 	float descender(int32_t size) const;
 	float top_adjustment(int32_t size) const;
-	float kerning(char codepoint_first, char codepoint_second);
+	float kerning(char codepoint_first, char codepoint_second) const {
+		return kerning_table ? kerning_table[uint32_t(uint8_t(codepoint_first)) * 256 + uint8_t(codepoint_second)] : 0.0f;
+	}
 	float text_extent(sys::state& state, char const* codepoints, uint32_t count, int32_t size);
 
 	friend class font_manager;
 };
 
+/*
+Extents of recently measured strings. The layout functions and the text elements measure the same words and labels over and
+over (every row of a ledger table, every time it is updated), so the extent of any run of at least min_length characters is
+kept here, keyed by font id (which includes the size) and a hash of the characters, in sets of a few entries that are
+replaced least recently used first.
+*/
+class shaped_run_cache {
+public:
+	static constexpr uint32_t set_count = 1024;
+	static constexpr uint32_t ways = 4;
+	static constexpr uint32_t min_length = 4; // shorter runs are measured faster than they are looked up
+
+	struct entry {
+		uint64_t hash = 0;
+		uint32_t length = 0; // 0 for an unused entry
+		uint32_t last_used = 0;
+		float extent = 0.0f;
+		uint16_t font_id = 0;
+	};
+
+	shaped_run_cache() : entries(set_count * ways) { }
+
+	float const* find(uint64_t hash, uint32_t length, uint16_t font_id);
+	void insert(uint64_t hash, uint32_t length, uint16_t font_id, float extent);
+	void clear();
+
+	uint32_t hits = 0;
+	uint32_t misses = 0;
+
+private:
+	std::vector<entry> entries;
+	uint32_t clock = 0;
+};
+
 class font_manager {
 public:
 	font_manager();
@@ -81,6 +117,7 @@ public:
 	ankerl::unordered_dense::map<uint16_t, dcon::text_key> font_names;
 	ankerl::unordered_dense::map<uint16_t, bm_font> bitmap_fonts;
 	FT_Library ft_library;
+	shaped_run_cache run_cache;
 
 	void load_font(font& fnt, char const* file_data, uint32_t file_size, font_feature f);
 	void load_all_glyphs();
@@ -0,0 +1,272 @@
+#include "name_search.hpp"
+#include "system_state.hpp"
+#include <algorithm>
+#include <limits>
+
+namespace search {
+
+namespace {
+
+char fold_codepoint(char16_t c) {
+	if(c < 0x80)
+		return (c >= u'A' && c <= u'Z') ? char(c - u'A' + u'a') : char(c);
+
+	// Latin-1 supplement
+	if(c >= 0xC0 && c <= 0xFF) {
+		auto l = char16_t(c >= 0xE0 ? c - 0x20 : c);
+		if(l <= 0xC6)
+			return 'a';
+		if(l == 0xC7)
+			return 'c';
+		if(l <= 0xCB)
+			return 'e';
+		if(l <= 0xCF)
+			return 'i';
+		if(l == 0xD0)
+			return 'd';
+		if(l == 0xD1)
+			return 'n';
+		if(l <= 0xD6 || l == 0xD8)
+			return 'o';
+		if(l >= 0xD9 && l <= 0xDC)
+			return 'u';
+		if(l == 0xDD || c == 0xFF)
+			return 'y';
+		if(c == 0xDF)
+			return 's';
+		return '?';
+	}
+	// Latin extended-A, in which the upper and lower case forms of each letter are adjacent
+	if(c >= 0x100 && c <= 0x17F) {
+		if(c <= 0x105)
+			return 'a';
+		if(c <= 0x10D)
+			return 'c';
+		if(c <= 0x111)
+			return 'd';
+		if(c <= 0x11B)
+			return 'e';
+		if(c <= 0x123)
+			return 'g';
+		if(c <= 0x127)
+			return 'h';
+		if(c <= 0x133)
+			return 'i';
+		if(c <= 0x135)
+			return 'j';
+		if(c <= 0x138)
+			return 'k';
+		if(c <= 0x142)
+			return 'l';
+		if(c <= 0x14B)
+			return 'n';
+		if(c <= 0x153)
+			return 'o';
+		if(c <= 0x159)
+			return 'r';
+		if(c <= 0x161)
+			return 's';
+		if(c <= 0x167)
+			return 't';
+		if(c <= 0x173)
+			return 'u';
+		if(c <= 0x175)
+			return 'w';
+		if(c <= 0x178)
+			return 'y';
+		return 'z';
+	}
+	return '?';
+}
+
+struct fold_table {
+	char folded[256] = {};
+	fold_table() {
+		for(uint32_t i = 0; i < 256; ++i)
+			folded[i] = fold_codepoint(text::win1250toUTF16(char(i)));
+	}
+};
+
+char fold_char(char c) {
+	static fold_table const table;
+	return table.folded[uint8_t(c)];
+}
+
+inline constexpr uint32_t trigram_alphabet = 40;
+inline constexpr uint32_t trigram_count = trigram_alphabet * trigram_alphabet * trigram_alphabet;
+
+uint32_t trigram_code(char c) {
+	if(c >= 'a' && c <= 'z')
+		return uint32_t(c - 'a') + 1;
+	if(c >= '0' && c <= '9')
+		return uint32_t(c - '0') + 27;
+	if(c == ' ')
+		return 37;
+	return 0;
+}
+uint32_t trigram_of(char const* c) {
+	return (trigram_code(c[0]) * trigram_alphabet + trigram_code(c[1])) * trigram_alphabet + trigram_code(c[2]);
+}
+
+bool better(result const& a, result const& b) {
+	if(a.quality != b.quality)
+		return a.quality > b.quality;
+	if(a.length != b.length)
+		return a.length < b.length;
+	if(a.type != b.type)
+		return a.type < b.type;
+	return a.id < b.id;
+}
+
+uint32_t insert_result(std::span<result> out, uint32_t count, result const& r) {
+	uint32_t i = count;
+	if(count < out.size()) {
+		++count;
+	} else if(better(r, out[count - 1])) {
+		--i;
+	} else {
+		return count;
+	}
+	for(; i > 0 && better(r, out[i - 1]); --i)
+		out[i] = out[i - 1];
+	out[i] = r;
+	return count;
+}
+
+} // namespace
+
+uint32_t fold_name(std::string_view name, char* out, uint32_t out_size) {
+	uint32_t length = std::min(uint32_t(name.length()), out_size);
+	for(uint32_t i = 0; i < length; ++i)
+		out[i] = fold_char(name[i]);
+	return length;
+}
+
+void name_index::clear() {
+	arena.clear();
+	entries.clear();
+	sorted.clear();
+	trigram_first.clear();
+	trigram_entries.clear();
+}
+
+void name_index::add(kind type, uint32_t id, std::string_view name) {
+	if(name.empty())
+		return;
+	auto length = uint16_t(std::min(name.length(), size_t(std::numeric_limits<uint16_t>::max())));
+	auto offset = uint32_t(arena.size());
+	arena.resize(arena.size() + length);
+	fold_name(name.substr(0, length), arena.data() + offset, length);
+	entries.push_back(entry{offset, length, type, id});
+}
+
+void name_index::finish() {
+	sorted.resize(entries.size());
+	for(uint32_t i = 0; i < entries.size(); ++i)
+		sorted[i] = i;
+	std::sort(sorted.begin(), sorted.end(), [&](uint32_t a, uint32_t b) {
+		auto na = name_of(entries[a]);
+		auto nb = name_of(entries[b]);
+		return na != nb ? na < nb : a < b;
+	});
+
+	std::vector<uint64_t> pairs; // trigram in the high bits, entry in the low bits
+	for(uint32_t i = 0; i < entries.size(); ++i) {
+		auto name = name_of(entries[i]);
+		for(size_t j = 0; j + 3 <= name.length(); ++j)
+			pairs.push_back((uint64_t(trigram_of(name.data() + j)) << 32) | i);
+	}
+	std::sort(pairs.begin(), pairs.end());
+	pairs.erase(std::unique(pairs.begin(), pairs.end()), pairs.end());
+
+	trigram_first.assign(trigram_count + 1, 0);
+	trigram_entries.resize(pairs.size());
+	for(uint32_t i = 0; i < pairs.size(); ++i) {
+		++trigram_first[uint32_t(pairs[i] >> 32) + 1];
+		trigram_entries[i] = uint32_t(pairs[i]);
+	}
+	for(uint32_t t = 0; t < trigram_count; ++t)
+		trigram_first[t + 1] += trigram_first[t];
+}
+
+uint32_t name_index::query(std::string_view term, uint32_t kinds, std::span<result> out, uint32_t count, uint32_t& budget) const {
+	if(term.empty() || out.empty() || sorted.empty())
+		return count;
+
+	// names starting with the term form one range of the prefix table
+	auto first = std::lower_bound(sorted.begin(), sorted.end(), term,
+			[&](uint32_t e, std::string_view t) { return name_of(entries[e]) < t; });
+	for(auto it = first; it != sorted.end() && budget > 0; ++it, --budget) {
+		auto const& e = entries[*it];
+		if(!name_of(e).starts_with(term))
+			break;
+		if((kinds & kind_bit(e.type)) != 0)
+			count = insert_result(out, count, result{e.id, e.length, e.type, e.length == term.length() ? match::exact : match::prefix});
+	}
+
+	// names containing the term elsewhere share all of its trigrams; look through the entries of the rarest one
+	if(term.length() < 3 || trigram_first.empty())
+		return count;
+	uint32_t rarest = trigram_of(term.data());
+	for(size_t j = 1; j + 3 <= term.length(); ++j) {
+		auto t = trigram_of(term.data() + j);
+		if(trigram_first[t + 1] - trigram_first[t] < trigram_first[rarest + 1] - trigram_first[rarest])
+			rarest = t;
+	}
+	for(uint32_t i = trigram_first[rarest]; i < trigram_first[rarest + 1] && budget > 0; ++i, --budget) {
+		auto const& e = entries[trigram_entries[i]];
+		if((kinds & kind_bit(e.type)) == 0)
+			continue;
+		auto name = name_of(e);
+		auto pos = name.find(term, 1);
+		if(pos == std::string_view::npos || name.starts_with(term))
+			continue; // not a match, or already found as a prefix
+		bool at_word = false;
+		for(auto p = pos; p != std::string_view::npos && !at_word; p = name.find(term, p + 1))
+			at_word = trigram_code(name[p - 1]) == 0 || name[p - 1] == ' ';
+		count = insert_result(out, count, result{e.id, e.length, e.type, at_word ? match::word_prefix : match::substring});
+	}
+	return count;
+}
+
+void invalidate(sys::state& state) {
+	state.name_search.fixed_built = false;
+	state.name_search.units_built = false;
+}
+
+uint32_t find_names(sys::state& state, std::string_view term, uint32_t kinds, std::span<result> out, uint32_t candidate_budget) {
+	auto& s = state.name_search;
+	if(!s.fixed_built) {
+		s.fixed.clear();
+		for(auto p : state.world.in_province)
+			s.fixed.add(kind::province, p.id.index(), text::produce_simple_string(state, p.get_name()));
+		for(auto n : state.world.in_national_identity)
+			s.fixed.add(kind::nation, n.id.index(), text::produce_simple_string(state, n.get_name()));
+		for(auto d : state.world.in_state_definition)
+			s.fixed.add(kind::state, d.id.index(), text::produce_simple_string(state, d.get_name()));
+		s.fixed.finish();
+		s.fixed_built = true;
+	}
+	if((kinds & unit_kinds) != 0 && (!s.units_built || s.units_date != state.current_date)) {
+		s.units.clear();
+		for(auto l : state.world.in_leader)
+			s.units.add(kind::leader, l.id.index(), state.to_string_view(l.get_name()));
+		for(auto a : state.world.in_army)
+			s.units.add(kind::army, a.id.index(), state.to_string_view(a.get_name()));
+		for(auto n : state.world.in_navy)
+			s.units.add(kind::navy, n.id.index(), state.to_string_view(n.get_name()));
+		s.units.finish();
+		s.units_date = state.current_date;
+		s.units_built = true;
+	}
+
+	char folded[64];
+	auto length = fold_name(term, folded, uint32_t(sizeof(folded)));
+	std::string_view folded_term(folded, length);
+	uint32_t count = s.fixed.query(folded_term, kinds, out, 0, candidate_budget);
+	if((kinds & unit_kinds) != 0)
+		count = s.units.query(folded_term, kinds, out, count, candidate_budget);
+	return count;
+}
+
+} // namespace search
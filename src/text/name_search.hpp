@@ -0,0 +1,109 @@
+#pragma once
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <vector>
+#include "dcon_generated.hpp"
+#include "date_interface.hpp"
+
+namespace sys {
+struct state;
+}
+
+/*
+Name search for provinces, nations, states, leaders and units, shared by the search window and the console.
+
+The names are folded (lower case, accents removed) into an arena once, and indexed by a table of the entries sorted by
+folded name, for prefix matches, and by a trigram index, for matches inside a name. Provinces, nations and states are
+indexed the first time they are searched after a scenario or save is loaded; leaders, armies and navies come and go, so
+their index is rebuilt when it is searched on a new day. Apart from those rebuilds, find_names does not allocate.
+*/
+
+namespace search {
+
+enum class kind : uint8_t { province, nation, state, leader, army, navy };
+inline constexpr uint32_t kind_bit(kind k) {
+	return uint32_t(1) << uint32_t(k);
+}
+inline constexpr uint32_t all_kinds = 0x3F;
+inline constexpr uint32_t unit_kinds = (uint32_t(1) << uint32_t(kind::leader)) | (uint32_t(1) << uint32_t(kind::army)) | (uint32_t(1) << uint32_t(kind::navy));
+
+enum class match : uint8_t { substring, word_prefix, prefix, exact }; // better matches compare greater
+
+struct result {
+	uint32_t id = 0; // index of the province, national identity, state definition, leader, army or navy
+	uint16_t length = 0; // of the matched name; among equal matches shorter names rank first
+	kind type = kind::province;
+	match quality = match::substring;
+};
+
+inline dcon::province_id as_province(result const& r) {
+	return r.type == kind::province ? dcon::province_id{dcon::province_id::value_base_t(r.id)} : dcon::province_id{};
+}
+inline dcon::national_identity_id as_national_identity(result const& r) {
+	return r.type == kind::nation ? dcon::national_identity_id{dcon::national_identity_id::value_base_t(r.id)} : dcon::national_identity_id{};
+}
+inline dcon::state_definition_id as_state_definition(result const& r) {
+	return r.type == kind::state ? dcon::state_definition_id{dcon::state_definition_id::value_base_t(r.id)} : dcon::state_definition_id{};
+}
+inline dcon::leader_id as_leader(result const& r) {
+	return r.type == kind::leader ? dcon::leader_id{dcon::leader_id::value_base_t(r.id)} : dcon::leader_id{};
+}
+inline dcon::army_id as_army(result const& r) {
+	return r.type == kind::army ? dcon::army_id{dcon::army_id::value_base_t(r.id)} : dcon::army_id{};
+}
+inline dcon::navy_id as_navy(result const& r) {
+	return r.type == kind::navy ? dcon::navy_id{dcon::navy_id::value_base_t(r.id)} : dcon::navy_id{};
+}
+
+// writes the folded form of a win1250 name to out, truncating it to out_size characters, and returns its length
+uint32_t fold_name(std::string_view name, char* out, uint32_t out_size);
+
+class name_index {
+public:
+	struct entry {
+		uint32_t offset = 0;
+		uint16_t length = 0;
+		kind type = kind::province;
+		uint32_t id = 0;
+	};
+
+	void clear();
+	void add(kind type, uint32_t id, std::string_view name);
+	void finish(); // builds the prefix table and the trigram index once all the names have been added
+
+	/*
+	Merges the matches for an already folded term into out[0, count), which is kept sorted best first, and returns the new
+	count. Every name looked at is deducted from budget, and the search stops when it runs out.
+	*/
+	uint32_t query(std::string_view term, uint32_t kinds, std::span<result> out, uint32_t count, uint32_t& budget) const;
+
+private:
+	std::string_view name_of(entry const& e) const {
+		return std::string_view(arena.data() + e.offset, e.length);
+	}
+
+	std::vector<char> arena;
+	std::vector<entry> entries;
+	std::vector<uint32_t> sorted;			// entry indices ordered by folded name
+	std::vector<uint32_t> trigram_first;	// trigram -> first position in trigram_entries; one extra for the end
+	std::vector<uint32_t> trigram_entries;	// entry indices containing each trigram, in increasing order
+};
+
+struct name_search_state {
+	name_index fixed; // provinces, nations and states
+	name_index units; // leaders, armies and navies
+	sys::date units_date;
+	bool fixed_built = false;
+	bool units_built = false;
+};
+
+void invalidate(sys::state& state); // call when a scenario or save is loaded
+
+/*
+Fills out with the best matches for term among the kinds in the kinds bit mask, best first, and returns how many there
+are. At most candidate_budget names are looked at, which bounds the time taken by a query made every keystroke.
+*/
+uint32_t find_names(sys::state& state, std::string_view term, uint32_t kinds, std::span<result> out, uint32_t candidate_budget = 20'000);
+
+} // namespace search
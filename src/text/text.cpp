@@ -6,8 +6,30 @@
 #include "parsers.hpp"
 #include "simple_fs.hpp"
 #include <type_traits>
+#include <bit>
+#include <algorithm>
 
 namespace text {
+std::string_view pool_string_view(std::vector<char> const& text_data, std::vector<uint64_t> const& text_terminators, dcon::text_key tag) {
+	if(!tag)
+		return std::string_view();
+	size_t start = tag.index();
+	size_t data_size = text_data.size();
+	if(start >= data_size)
+		return std::string_view();
+	if(text_terminators.size() != (data_size + 63) / 64) { // the terminators have not been indexed; scan for the end
+		auto end_position = std::find(text_data.data() + start, text_data.data() + data_size, char(0));
+		return std::string_view(text_data.data() + start, size_t(end_position - (text_data.data() + start)));
+	}
+	// the end of the string is the first terminator at or after its start
+	size_t word = start / 64;
+	uint64_t bits = text_terminators[word] & (~uint64_t(0) << (start % 64));
+	while(bits == 0 && ++word < text_terminators.size())
+		bits = text_terminators[word];
+	size_t end = bits != 0 ? std::min(word * 64 + size_t(std::countr_zero(bits)), data_size) : data_size;
+	return std::string_view(text_data.data() + start, end - start);
+}
+
 text_color char_to_color(char in) {
 	switch(in) {
 	case 'W':
@@ -1307,6 +1329,41 @@ void endless_layout::internal_close_box(layout_box& box) {
 	close_layout_box(*this, box);
 }
 
+layout_cache::entry* layout_cache::find(layout_cache_key const& key) {
+	for(auto& e : entries) {
+		if(e.valid && e.key == key) {
+			e.last_used = ++clock;
+			++hits;
+			return &e;
+		}
+	}
+	++misses;
+	return nullptr;
+}
+
+layout_cache::entry& layout_cache::replace(layout_cache_key const& key) {
+	entry* oldest = &entries[0];
+	for(auto& e : entries) {
+		if(!e.valid) {
+			oldest = &e;
+			break;
+		}
+		if(e.last_used < oldest->last_used)
+			oldest = &e;
+	}
+	oldest->key = key;
+	oldest->last_used = ++clock;
+	oldest->valid = true;
+	return *oldest;
+}
+
+void layout_cache::clear() {
+	for(auto& e : entries) {
+		e.valid = false;
+		e.contents.contents.clear();
+	}
+}
+
 columnar_layout create_columnar_layout(layout& dest, layout_parameters const& params, int32_t column_width) {
 	dest.contents.clear();
 	dest.number_of_lines = 0;
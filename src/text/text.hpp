@@ -3,6 +3,7 @@
 #include <stdint.h>
 #include <variant>
 #include <vector>
+#include <array>
 #include <string>
 #include <string_view>
 #include "dcon_generated.hpp"
@@ -423,30 +424,23 @@ struct text_sequence {
 
 using text_component = std::variant<line_break, text_color, variable_type, dcon::text_key>;
 
+// the string starting at tag in the text pool, found with the terminator index when it covers the pool; see state::to_string_view
+std::string_view pool_string_view(std::vector<char> const& text_data, std::vector<uint64_t> const& text_terminators, dcon::text_key tag);
+
 struct vector_backed_hash {
 	using is_avalanching = void;
 	using is_transparent = void;
 
 	std::vector<char>& text_data;
+	std::vector<uint64_t>& text_terminators;
 
-	vector_backed_hash(std::vector<char>& text_data) : text_data(text_data) { }
+	vector_backed_hash(std::vector<char>& text_data, std::vector<uint64_t>& text_terminators) : text_data(text_data), text_terminators(text_terminators) { }
 
 	auto operator()(std::string_view sv) const noexcept -> uint64_t {
 		return ankerl::unordered_dense::detail::wyhash::hash(sv.data(), sv.size());
 	}
 	auto operator()(dcon::text_key tag) const noexcept -> uint64_t {
-		auto sv = [&]() {
-			if(!tag)
-				return std::string_view();
-			auto start_position = text_data.data() + tag.index();
-			auto data_size = text_data.size();
-			auto end_position = start_position;
-			for(; end_position < text_data.data() + data_size; ++end_position) {
-				if(*end_position == 0)
-					break;
-			}
-			return std::string_view(text_data.data() + tag.index(), size_t(end_position - start_position));
-		}();
+		auto sv = pool_string_view(text_data, text_terminators, tag);
 		return ankerl::unordered_dense::detail::wyhash::hash(sv.data(), sv.size());
 	}
 };
@@ -454,71 +448,24 @@ struct vector_backed_eq {
 	using is_transparent = void;
 
 	std::vector<char>& text_data;
+	std::vector<uint64_t>& text_terminators;
 
-	vector_backed_eq(std::vector<char>& text_data) : text_data(text_data) { }
+	vector_backed_eq(std::vector<char>& text_data, std::vector<uint64_t>& text_terminators) : text_data(text_data), text_terminators(text_terminators) { }
 
 	bool operator()(dcon::text_key l, dcon::text_key r) const noexcept {
 		return l == r;
 	}
 	bool operator()(dcon::text_key l, std::string_view r) const noexcept {
-		auto sv = [&]() {
-			if(!l)
-				return std::string_view();
-			auto start_position = text_data.data() + l.index();
-			auto data_size = text_data.size();
-			auto end_position = start_position;
-			for(; end_position < text_data.data() + data_size; ++end_position) {
-				if(*end_position == 0)
-					break;
-			}
-			return std::string_view(text_data.data() + l.index(), size_t(end_position - start_position));
-		}();
-		return sv == r;
+		return pool_string_view(text_data, text_terminators, l) == r;
 	}
 	bool operator()(std::string_view r, dcon::text_key l) const noexcept {
-		auto sv = [&]() {
-			if(!l)
-				return std::string_view();
-			auto start_position = text_data.data() + l.index();
-			auto data_size = text_data.size();
-			auto end_position = start_position;
-			for(; end_position < text_data.data() + data_size; ++end_position) {
-				if(*end_position == 0)
-					break;
-			}
-			return std::string_view(text_data.data() + l.index(), size_t(end_position - start_position));
-		}();
-		return sv == r;
+		return pool_string_view(text_data, text_terminators, l) == r;
 	}
 	bool operator()(dcon::text_key l, std::string const& r) const noexcept {
-		auto sv = [&]() {
-			if(!l)
-				return std::string_view();
-			auto start_position = text_data.data() + l.index();
-			auto data_size = text_data.size();
-			auto end_position = start_position;
-			for(; end_position < text_data.data() + data_size; ++end_position) {
-				if(*end_position == 0)
-					break;
-			}
-			return std::string_view(text_data.data() + l.index(), size_t(end_position - start_position));
-		}();
-		return sv == r;
+		return pool_string_view(text_data, text_terminators, l) == r;
 	}
 	bool operator()(std::string const& r, dcon::text_key l) const noexcept {
-		auto sv = [&]() {
-			if(!l)
-				return std::string_view();
-			auto start_position = text_data.data() + l.index();
-			auto data_size = text_data.size();
-			auto end_position = start_position;
-			for(; end_position < text_data.data() + data_size; ++end_position) {
-				if(*end_position == 0)
-					break;
-			}
-			return std::string_view(text_data.data() + l.index(), size_t(end_position - start_position));
-		}();
-		return sv == r;
+		return pool_string_view(text_data, text_terminators, l) == r;
 	}
 };
 
@@ -642,6 +589,47 @@ void close_layout_box(endless_layout& dest, layout_box& box);
 
 columnar_layout create_columnar_layout(layout& dest, layout_parameters const& params, int32_t column_width);
 
+/*
+Finished tooltip layouts. Producing some tooltips (decisions, for example) evaluates many triggers, so rather than rebuilding
+them whenever the mouse comes back to an element, or every frame for position sensitive tooltips, a copy of the finished
+layout is kept and reused while nothing it could depend on has changed.
+*/
+struct layout_cache_key {
+	void const* source = nullptr;
+	int32_t x = 0;
+	int32_t y = 0;
+	int32_t max_height = 0;
+	uint32_t content_generation = 0; // see ui::state::content_generation
+	uint32_t command_generation = 0; // see sys::state::command_generation
+	uint16_t date = 0;
+	dcon::nation_id player;
+
+	bool operator==(layout_cache_key const& o) const {
+		return source == o.source && x == o.x && y == o.y && max_height == o.max_height && content_generation == o.content_generation
+			&& command_generation == o.command_generation && date == o.date && player == o.player;
+	}
+};
+
+struct layout_cache {
+	static constexpr uint32_t capacity = 16;
+	struct entry {
+		layout_cache_key key;
+		layout contents;
+		int32_t used_width = 0;
+		int32_t used_height = 0;
+		uint32_t last_used = 0;
+		bool valid = false;
+	};
+	std::array<entry, capacity> entries;
+	uint32_t clock = 0;
+	uint32_t hits = 0;
+	uint32_t misses = 0;
+
+	entry* find(layout_cache_key const& key); // counts a hit or a miss
+	entry& replace(layout_cache_key const& key); // reuses the least recently used entry for key
+	void clear();
+};
+
 layout_box open_layout_box(layout_base& dest, int32_t indent = 0);
 void close_layout_box(columnar_layout& dest, layout_box& box);
 void add_to_layout_box(sys::state& state, layout_base& dest, layout_box& box, dcon::text_sequence_id source_text,
@@ -7,6 +7,11 @@
 #include "system_state.hpp"
 #include "serialization.hpp"
 #include "prng.hpp"
+#include "reductions.hpp"
+#include "pool_index.hpp"
+#include <bit>
+#include <random>
+#include <thread>
 
 TEST_CASE("prng_simple", "[determinism]") {
 	std::unique_ptr<sys::state> game_state = std::make_unique<sys::state>(); // too big for the stack
@@ -89,6 +94,90 @@ TEST_CASE("math_fns", "[determinism]") {
 	}
 }
 
+TEST_CASE("pool_interning", "[determinism]") {
+	// the interning index must find the same first occurrence as searching the whole pool
+	std::mt19937 gen(808080);
+	std::uniform_int_distribution<uint32_t> symbol(0, 3); // a small alphabet, so that sequences repeat and overlap
+	std::uniform_int_distribution<uint32_t> length(1, 12);
+	std::vector<uint16_t> pool{ uint16_t(9) };
+	pool_index::first_occurrence_index<uint16_t> index{1};
+	for(uint32_t i = 0; i < 20'000; ++i) {
+		if(i == 10'000)
+			index.release(); // a released index starts over from the pool, keeping its start position
+		std::vector<uint16_t> data(length(gen));
+		for(auto& v : data)
+			v = uint16_t(symbol(gen) * 0x1001);
+		auto expected = std::search(pool.data() + 1, pool.data() + pool.size(), data.data(), data.data() + data.size());
+		auto found = index.find(pool, data.data(), uint32_t(data.size()));
+		if(expected != pool.data() + pool.size()) {
+			REQUIRE(found == int32_t(expected - pool.data()));
+		} else {
+			REQUIRE(found == -1);
+			pool.insert(pool.end(), data.begin(), data.end());
+		}
+	}
+}
+
+TEST_CASE("deterministic_reductions", "[determinism]") {
+	constexpr uint32_t count = 100'003; // not a multiple of the block size, nor of the vector width
+	std::vector<float> values(count);
+	std::mt19937 gen(808080);
+	std::uniform_real_distribution<float> mantissa(-1.0f, 1.0f);
+	std::uniform_int_distribution<int32_t> exponent(-20, 20);
+	double exact = 0.0;
+	double magnitude = 0.0;
+	for(auto& v : values) {
+		v = std::ldexp(mantissa(gen), exponent(gen));
+		exact += double(v);
+		magnitude += std::abs(double(v));
+	}
+	auto tolerance = magnitude * 1e-6;
+	ve::vectorizable_buffer<float, dcon::pop_id> buffer(count);
+	for(uint32_t i = 0; i < count; ++i)
+		buffer.set(dcon::pop_id{ dcon::pop_id::value_base_t(i) }, values[i]);
+
+	// hands the blocks out round robin, so that they are summed by n threads finishing in no particular order
+	auto on_threads = [](uint32_t n) {
+		return [n](uint32_t blocks, auto const& body) {
+			std::vector<std::thread> threads;
+			for(uint32_t t = 0; t < n; ++t) {
+				threads.emplace_back([&, t]() {
+					for(uint32_t b = t; b < blocks; b += n)
+						body(b);
+				});
+			}
+			for(auto& t : threads)
+				t.join();
+		};
+	};
+	auto value_at = [&](uint32_t i) { return values[i]; };
+	auto vector_value_at = [&](auto ids) { return buffer.get(ids); };
+
+	auto serial = reduction::sum(count, value_at);
+	REQUIRE(double(serial) == Approx(exact).margin(tolerance));
+	auto serial_vector = reduction::buffer_sum(buffer, count);
+	REQUIRE(double(serial_vector) == Approx(exact).margin(tolerance));
+
+	for(uint32_t n = 1; n <= 16; ++n) {
+		INFO(n << " threads");
+		REQUIRE(std::bit_cast<uint32_t>(reduction::sum(count, value_at, on_threads(n))) == std::bit_cast<uint32_t>(serial));
+		REQUIRE(std::bit_cast<uint32_t>(reduction::vector_sum<dcon::pop_id>(count, vector_value_at, on_threads(n))) == std::bit_cast<uint32_t>(serial_vector));
+	}
+	REQUIRE(std::bit_cast<uint32_t>(reduction::parallel_sum(count, value_at)) == std::bit_cast<uint32_t>(serial));
+	REQUIRE(std::bit_cast<uint32_t>(reduction::parallel_vector_sum<dcon::pop_id>(count, vector_value_at)) == std::bit_cast<uint32_t>(serial_vector));
+
+	// short ranges: empty, a single partial vector, and a single partial block
+	REQUIRE(reduction::sum(0, value_at) == 0.0f);
+	REQUIRE(reduction::buffer_sum(buffer, 0) == 0.0f);
+	for(uint32_t len : { uint32_t(1), uint32_t(3), uint32_t(reduction::block_size - 1) }) {
+		double expected = 0.0;
+		for(uint32_t i = 0; i < len; ++i)
+			expected += double(values[i]);
+		REQUIRE(double(reduction::sum(len, value_at)) == Approx(expected).margin(tolerance));
+		REQUIRE(double(reduction::buffer_sum(buffer, len)) == Approx(expected).margin(tolerance));
+	}
+}
+
 #undef UNOPTIMIZABLE_FLOAT
 
 void compare_game_states(sys::state& ws1, sys::state& ws2) {
@@ -713,3 +802,299 @@ TEST_CASE("sim_year", "[determinism]") {
 		checked_single_tick(*game_state_1, *game_state_2);
 	}
 }
+
+TEST_CASE("command_log_replay", "[determinism]") {
+	// Test that replaying a recorded command log reproduces the recorded save checksums
+	std::unique_ptr<sys::state> game_state_1 = load_testing_scenario_file();
+	std::unique_ptr<sys::state> game_state_2 = load_testing_scenario_file();
+	game_state_1->game_seed = 808080;
+	game_state_1->local_player_nation = dcon::nation_id{ dcon::nation_id::value_base_t(0) };
+	game_state_1->command_log.checksum_interval = 7;
+
+	// start recording mid-month, with pops created and split since the last compaction, and scattered on top of that so
+	// that the layout at the start of the log cannot match a freshly compacted one
+	for(int i = 0; i < 12; i++) {
+		game_state_1->single_game_tick();
+	}
+	std::vector<dcon::pop_id> scrambled(game_state_1->world.pop_size());
+	for(uint32_t i = 0; i < game_state_1->world.pop_size(); ++i) {
+		scrambled[i] = dcon::pop_id{ dcon::pop_id::value_base_t(i) };
+	}
+	std::shuffle(scrambled.begin(), scrambled.end(), std::mt19937(808080));
+	demographics::reorder_pops(*game_state_1, scrambled);
+
+	// commands are only queued while in game
+	auto& s1 = *game_state_1;
+	s1.mode = sys::game_mode_type::in_game;
+	auto source = s1.local_player_nation;
+
+	uint32_t issued = 0;
+	auto build_unit = [&]() {
+		for(auto p : s1.world.nation_get_province_ownership(source)) {
+			for(uint32_t i = 0; i < s1.military_definitions.unit_base_definitions.size(); ++i) {
+				dcon::unit_type_id t{ dcon::unit_type_id::value_base_t(i) };
+				auto c = s1.world.nation_get_primary_culture(source);
+				if(command::can_start_land_unit_construction(s1, source, p.get_province(), c, t)) {
+					command::start_land_unit_construction(s1, source, p.get_province(), c, t);
+					++issued;
+					return;
+				}
+			}
+		}
+	};
+	auto change_focus = [&]() {
+		for(auto so : s1.world.nation_get_state_ownership(source)) {
+			for(auto f : s1.world.in_national_focus) {
+				if(f != so.get_state().get_owner_focus() && command::can_set_national_focus(s1, source, so.get_state(), f)) {
+					command::set_national_focus(s1, source, so.get_state(), f);
+					++issued;
+					return;
+				}
+			}
+		}
+	};
+	auto declare_war = [&]() {
+		for(auto target : s1.world.in_nation) {
+			for(auto cb : s1.world.in_cb_type) {
+				if(command::can_declare_war(s1, source, target, cb, dcon::state_definition_id{}, dcon::national_identity_id{}, dcon::nation_id{})) {
+					command::declare_war(s1, source, target, cb, dcon::state_definition_id{}, dcon::national_identity_id{}, dcon::nation_id{}, false);
+					++issued;
+					return;
+				}
+			}
+		}
+	};
+	auto increase_relations = [&]() {
+		for(auto target : s1.world.in_nation) {
+			if(target.get_owned_province_count() != 0 && command::can_increase_relations(s1, source, target)) {
+				command::increase_relations(s1, source, target);
+				++issued;
+				return;
+			}
+		}
+	};
+
+	command::start_command_log(s1);
+	for(int i = 0; i < 31; i++) {
+		if(i == 2) {
+			build_unit();
+			change_focus();
+		} else if(i == 9) {
+			declare_war();
+		} else if(i == 20) {
+			increase_relations();
+		}
+		command::execute_pending_commands(s1);
+		s1.single_game_tick();
+	}
+	command::stop_command_log(s1);
+	REQUIRE(issued >= 2);
+
+	auto result = command::replay_command_log(*game_state_2, s1.command_log.file_name);
+	REQUIRE(result.loaded);
+	REQUIRE(result.completed);
+	REQUIRE(result.ticks.size() == 31);
+	REQUIRE(result.commands_executed > 0);
+	REQUIRE(result.checksums_checked > 0);
+	REQUIRE(result.checksum_mismatches == 0);
+	REQUIRE(s1.current_date == game_state_2->current_date);
+	REQUIRE(s1.get_save_checksum().is_equal(game_state_2->get_save_checksum()));
+}
+
+TEST_CASE("pop_reorder_event_slots", "[determinism]") {
+	// Test that moving pops also moves the pops that pending and postponed events refer to
+	std::unique_ptr<sys::state> game_state = load_testing_scenario_file();
+	auto& ws = *game_state;
+
+	dcon::pop_id a{ dcon::pop_id::value_base_t(ws.world.pop_size() / 3) };
+	dcon::pop_id b{ dcon::pop_id::value_base_t(ws.world.pop_size() / 2) };
+	auto n = ws.world.province_get_nation_from_province_ownership(ws.world.pop_get_province_from_pop_location(a));
+	ws.future_p_event.push_back(event::pending_human_p_event{ 1, 2, trigger::to_generic(a), dcon::provincial_event_id{ 0 },
+			ws.world.pop_get_province_from_pop_location(a), ws.current_date + 5, event::slot_type::pop });
+	ws.pending_n_event.push_back(event::pending_human_n_event{ 1, 2, trigger::to_generic(a), trigger::to_generic(b),
+			dcon::national_event_id{ 0 }, n, ws.current_date, event::slot_type::pop, event::slot_type::pop });
+	ws.future_n_event.push_back(event::pending_human_n_event{ 1, 2, trigger::to_generic(n), trigger::to_generic(b),
+			dcon::national_event_id{ 0 }, n, ws.current_date + 5, event::slot_type::nation, event::slot_type::pop });
+
+	auto same_pop = [&](int32_t slot, float size, dcon::province_id location, dcon::culture_id culture) {
+		auto p = trigger::to_pop(slot);
+		return ws.world.pop_get_size(p) == size && ws.world.pop_get_province_from_pop_location(p) == location
+			&& ws.world.pop_get_culture(p) == culture;
+	};
+	auto a_size = ws.world.pop_get_size(a);
+	auto a_location = ws.world.pop_get_province_from_pop_location(a);
+	auto a_culture = ws.world.pop_get_culture(a);
+	auto b_size = ws.world.pop_get_size(b);
+	auto b_location = ws.world.pop_get_province_from_pop_location(b);
+	auto b_culture = ws.world.pop_get_culture(b);
+
+	// scatter the pops and then compact them, as a month of pop changes followed by the monthly compaction would
+	std::vector<dcon::pop_id> scrambled(ws.world.pop_size());
+	for(uint32_t i = 0; i < ws.world.pop_size(); ++i) {
+		scrambled[i] = dcon::pop_id{ dcon::pop_id::value_base_t(i) };
+	}
+	std::shuffle(scrambled.begin(), scrambled.end(), std::mt19937(808080));
+	demographics::reorder_pops(ws, scrambled);
+	demographics::compact_pops_by_location(ws);
+
+	REQUIRE(same_pop(ws.future_p_event.back().from_slot, a_size, a_location, a_culture));
+	REQUIRE(same_pop(ws.pending_n_event.back().primary_slot, a_size, a_location, a_culture));
+	REQUIRE(same_pop(ws.pending_n_event.back().from_slot, b_size, b_location, b_culture));
+	REQUIRE(ws.future_n_event.back().primary_slot == trigger::to_generic(n));
+	REQUIRE(same_pop(ws.future_n_event.back().from_slot, b_size, b_location, b_culture));
+}
+
+TEST_CASE("parallel_fill_unsaved_data", "[determinism]") {
+	// Test that reconstructing the unsaved data in parallel gives the same result as doing it one task at a time
+	std::unique_ptr<sys::state> game_state_1 = load_testing_scenario_file();
+	std::unique_ptr<sys::state> game_state_2 = load_testing_scenario_file();
+	game_state_1->serial_reconstruction = true;
+	for(auto* ws : { game_state_1.get(), game_state_2.get() }) {
+		ws->preload();
+		REQUIRE(sys::try_read_scenario_as_save_file(*ws, NATIVE("tests_scenario.bin")));
+		ws->game_seed = 808080;
+		ws->fill_unsaved_data();
+	}
+	REQUIRE(game_state_1->get_save_checksum().is_equal(game_state_2->get_save_checksum()));
+
+	auto& w1 = game_state_1->world;
+	auto& w2 = game_state_2->world;
+	for(auto n : w1.in_nation) {
+		REQUIRE(n.get_combined_issue_rules() == w2.nation_get_combined_issue_rules(n));
+		REQUIRE(n.get_administrative_efficiency() == w2.nation_get_administrative_efficiency(n));
+		REQUIRE(n.get_rank() == w2.nation_get_rank(n));
+		REQUIRE(n.get_capital() == w2.nation_get_capital(n));
+		REQUIRE(n.get_owned_province_count() == w2.nation_get_owned_province_count(n));
+		REQUIRE(n.get_is_great_power() == w2.nation_get_is_great_power(n));
+		for(uint32_t i = 0; i < sys::national_mod_offsets::count; ++i) {
+			dcon::national_modifier_value m{ dcon::national_modifier_value::value_base_t(i) };
+			REQUIRE(n.get_modifier_values(m) == w2.nation_get_modifier_values(n, m));
+		}
+		for(uint32_t i = 0; i < demographics::size(*game_state_1); ++i) {
+			dcon::demographics_key k{ dcon::demographics_key::value_base_t(i) };
+			REQUIRE(n.get_demographics(k) == w2.nation_get_demographics(n, k));
+		}
+	}
+	for(auto p : w1.in_province) {
+		REQUIRE(p.get_connected_region_id() == w2.province_get_connected_region_id(p));
+		REQUIRE(p.get_state_membership() == w2.province_get_state_membership(p));
+		REQUIRE(p.get_is_blockaded() == w2.province_get_is_blockaded(p));
+		REQUIRE(p.get_is_coast() == w2.province_get_is_coast(p));
+		for(uint32_t i = 0; i < sys::provincial_mod_offsets::count; ++i) {
+			dcon::provincial_modifier_value m{ dcon::provincial_modifier_value::value_base_t(i) };
+			REQUIRE(p.get_modifier_values(m) == w2.province_get_modifier_values(p, m));
+		}
+	}
+	for(auto p : w1.in_pop) {
+		REQUIRE(p.get_political_reform_desire() == w2.pop_get_political_reform_desire(p));
+		REQUIRE(p.get_social_reform_desire() == w2.pop_get_social_reform_desire(p));
+		REQUIRE(p.get_is_primary_or_accepted_culture() == w2.pop_get_is_primary_or_accepted_culture(p));
+	}
+	REQUIRE(game_state_1->trigger_is_volatile == game_state_2->trigger_is_volatile);
+}
+
+TEST_CASE("province_graph_owner_change", "[determinism]") {
+	// the copy of the adjacency types in the province graph must follow the national bit when provinces change hands
+	std::unique_ptr<sys::state> game_state = load_testing_scenario_file();
+	auto& state = *game_state;
+	auto& graph = state.province_definitions.adjacency;
+
+	uint32_t changed = 0;
+	for(auto adj : state.world.in_province_adjacency) {
+		auto a = adj.get_connected_provinces(0);
+		auto b = adj.get_connected_provinces(1);
+		if(!a || !b || changed >= 8)
+			continue;
+		auto owner_a = a.get_nation_from_province_ownership();
+		auto owner_b = b.get_nation_from_province_ownership();
+		if(owner_a && owner_b && owner_a != owner_b) {
+			province::change_province_owner(state, b, owner_a);
+			++changed;
+		}
+	}
+	REQUIRE(changed > 0);
+
+	for(auto p : state.world.in_province) {
+		auto i = graph.offsets[p.id.index()];
+		for(auto adj : p.get_province_adjacency()) {
+			REQUIRE(graph.edges[i] == adj.id);
+			REQUIRE(graph.types[i] == adj.get_type());
+			++i;
+		}
+		REQUIRE(i == graph.offsets[p.id.index() + 1]);
+	}
+}
+
+TEST_CASE("rankings_match_full_sort", "[determinism]") {
+	// Test that the incremental rankings order the nations exactly as a full sort with the original comparators would,
+	// including nations that tie on tier and score
+	std::unique_ptr<sys::state> game_state = load_testing_scenario_file();
+	auto& state = *game_state;
+	nations::update_rankings(state);
+	nations::update_ui_rankings(state);
+
+	std::vector<dcon::nation_id> expected;
+	auto check = [&](std::vector<dcon::nation_id> const& ranked, bool only_with_provinces, auto&& score_of, bool provinces_tier) {
+		expected.clear();
+		state.world.for_each_nation([&](dcon::nation_id n) {
+			if(!only_with_provinces || state.world.nation_get_owned_province_count(n) != 0)
+				expected.push_back(n);
+		});
+		std::sort(expected.begin(), expected.end(), [&](dcon::nation_id a, dcon::nation_id b) {
+			auto fa = fatten(state.world, a);
+			auto fb = fatten(state.world, b);
+			if(provinces_tier && (fa.get_owned_province_count() != 0) != (fb.get_owned_province_count() != 0))
+				return fa.get_owned_province_count() != 0;
+			if(fa.get_is_civilized() != fb.get_is_civilized())
+				return bool(fa.get_is_civilized());
+			auto a_score = score_of(a);
+			auto b_score = score_of(b);
+			if(a_score != b_score)
+				return a_score > b_score;
+			return a.index() > b.index();
+		});
+		REQUIRE(ranked.size() >= expected.size());
+		for(size_t i = 0; i < expected.size(); ++i) {
+			REQUIRE(ranked[i] == expected[i]);
+		}
+	};
+	auto check_all = [&]() {
+		check(state.nations_by_rank, false, [&](dcon::nation_id n) {
+			return state.world.nation_get_military_score(n) + state.world.nation_get_industrial_score(n) + nations::prestige_score(state, n);
+		}, true);
+		for(size_t i = 0; i < expected.size(); ++i) {
+			REQUIRE(state.world.nation_get_rank(expected[i]) == uint16_t(i + 1));
+		}
+		check(state.nations_by_industrial_score, true, [&](dcon::nation_id n) { return float(state.world.nation_get_industrial_score(n)); }, false);
+		check(state.nations_by_military_score, true, [&](dcon::nation_id n) { return float(state.world.nation_get_military_score(n)); }, false);
+		check(state.nations_by_prestige_score, true, [&](dcon::nation_id n) { return nations::prestige_score(state, n); }, false);
+	};
+	check_all();
+
+	// perturb the scores from the previous order: many ties, a few large moves and some nations changing tier
+	std::mt19937 rng(808080);
+	for(int round = 0; round < 4; ++round) {
+		state.world.for_each_nation([&](dcon::nation_id n) {
+			switch(rng() % 4) {
+			case 0: // ties on every score
+				state.world.nation_set_military_score(n, uint16_t(10));
+				state.world.nation_set_industrial_score(n, uint16_t(10));
+				state.world.nation_set_prestige(n, 10.0f - state.world.nation_get_modifier_values(n, sys::national_mod_offsets::permanent_prestige));
+				break;
+			case 1:
+				state.world.nation_set_military_score(n, uint16_t(rng() % 500));
+				state.world.nation_set_industrial_score(n, uint16_t(rng() % 500));
+				state.world.nation_set_prestige(n, float(rng() % 100));
+				break;
+			case 2:
+				state.world.nation_set_is_civilized(n, !state.world.nation_get_is_civilized(n));
+				break;
+			default:
+				break;
+			}
+		});
+		nations::update_rankings(state);
+		nations::update_ui_rankings(state);
+		check_all();
+	}
+}
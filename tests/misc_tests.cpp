@@ -2,6 +2,10 @@
 #include "system_state.hpp"
 #include "date_interface.hpp"
 #include "cyto_any.hpp"
+#include "triple_buffer.hpp"
+#include "gui_list_model.hpp"
+#include <thread>
+#include <filesystem>
 
 TEST_CASE("string pool tests", "[misc_tests]") {
 	std::unique_ptr<sys::state> state = std::make_unique<sys::state>();
@@ -34,6 +38,12 @@ TEST_CASE("string pool tests", "[misc_tests]") {
 
 	REQUIRE(state->to_string_view(la) == "mixed");
 	REQUIRE(state->to_string_view(lb) == "latex");
+
+	state->key_to_text_sequence.insert_or_assign(b, dcon::text_sequence_id(3));
+	state->key_to_text_sequence.insert_or_assign(d, dcon::text_sequence_id(7));
+	REQUIRE(state->key_to_text_sequence.find(std::string_view("1234"))->second == dcon::text_sequence_id(3));
+	REQUIRE(state->key_to_text_sequence.find(std::string("last"))->second == dcon::text_sequence_id(7));
+	REQUIRE(state->key_to_text_sequence.find(std::string_view("123")) == state->key_to_text_sequence.end());
 }
 
 TEST_CASE("date tests", "[misc_tests]") {
@@ -225,3 +235,430 @@ TEST_CASE("cyto payload tests", "[misc_tests]") {
 		REQUIRE(any_cast<void *>(vp_payload) == (void *)nullptr);
 	}
 }
+
+TEST_CASE("image decoding tests", "[misc_tests]") {
+	SECTION("dds") {
+		uint32_t file[32 + 4] = { 0 };
+		file[0] = ('D' << 0) | ('D' << 8) | ('S' << 16) | (' ' << 24);
+		file[1] = 124;
+		file[2] = 0x1007; // caps, height, width, pixel format
+		file[3] = 2;			// height
+		file[4] = 2;			// width
+		file[19] = 32;
+		file[20] = 0x41; // rgb with alpha
+		file[22] = 32;
+		file[27] = 0x1000; // texture
+		for(uint32_t i = 0; i < 4; ++i)
+			file[32 + i] = 0x04010203 + i * 0x10; // stored as b, g, r, a
+		auto image = ogl::decode_dds(reinterpret_cast<uint8_t const*>(file), uint32_t(sizeof(file)));
+		REQUIRE(image.type == ogl::decoded_image::format::dds_uncompressed);
+		REQUIRE(image.size_x == 2);
+		REQUIRE(image.size_y == 2);
+		REQUIRE(image.data_size == 16);
+		REQUIRE(image.mipmaps == 0);
+		REQUIRE(image.data.get()[0] == 0x01);
+		REQUIRE(image.data.get()[1] == 0x02);
+		REQUIRE(image.data.get()[2] == 0x03);
+		REQUIRE(image.data.get()[3] == 0x04);
+		REQUIRE(image.data.get()[12] == 0x01);
+		REQUIRE(image.data.get()[14] == 0x33);
+
+		// truncated pixel data
+		auto truncated = ogl::decode_dds(reinterpret_cast<uint8_t const*>(file), uint32_t(sizeof(file) - 4));
+		REQUIRE(truncated.type == ogl::decoded_image::format::none);
+		REQUIRE(!truncated.data);
+	}
+	SECTION("tga") {
+		uint8_t file[18 + 8] = { 0 };
+		file[2] = 2;		 // uncompressed true color
+		file[12] = 2;		 // width
+		file[14] = 1;		 // height
+		file[16] = 32;	 // bits per pixel
+		file[17] = 0x28; // top left origin, 8 bits of alpha
+		uint8_t const pixels[8] = { 3, 2, 1, 4, 30, 20, 10, 40 };
+		memcpy(file + 18, pixels, 8);
+		auto image = ogl::decode_image(file, uint32_t(sizeof(file)));
+		REQUIRE(image.type == ogl::decoded_image::format::rgba);
+		REQUIRE(image.size_x == 2);
+		REQUIRE(image.size_y == 1);
+		REQUIRE(image.data.get()[0] == 1);
+		REQUIRE(image.data.get()[1] == 2);
+		REQUIRE(image.data.get()[2] == 3);
+		REQUIRE(image.data.get()[3] == 4);
+		REQUIRE(image.data.get()[4] == 10);
+		REQUIRE(image.data.get()[7] == 40);
+	}
+	SECTION("background loader") {
+		simple_fs::file_system fs;
+		add_root(fs, NATIVE("."));
+		ogl::texture_loader loader;
+		loader.start(fs);
+		// more requests than the workers take at once, for files that do not exist
+		uint32_t const count = ogl::texture_loader::max_in_flight * ogl::texture_loader::worker_count + 50;
+		for(uint32_t i = 0; i < count; ++i)
+			loader.submit(dcon::texture_id{ dcon::texture_id::value_base_t(i) }, NATIVE("no_such_image.tga"));
+		REQUIRE(loader.pending() == count);
+
+		std::vector<bool> seen(count, false);
+		uint32_t received = 0;
+		ogl::texture_loader::result r;
+		while(received < count) {
+			if(loader.poll(r)) {
+				REQUIRE(r.image.type == ogl::decoded_image::format::none);
+				REQUIRE(!seen[r.id.index()]);
+				seen[r.id.index()] = true;
+				++received;
+			} else {
+				std::this_thread::yield();
+			}
+		}
+		REQUIRE(loader.pending() == 0);
+		loader.stop();
+		REQUIRE(!loader.running());
+	}
+}
+
+TEST_CASE("atlas packer tests", "[misc_tests]") {
+	struct rect {
+		int32_t x = 0;
+		int32_t y = 0;
+		int32_t w = 0;
+		int32_t h = 0;
+		bool operator==(rect const&) const = default;
+	};
+	int32_t const size = ogl::flag_atlas::layer_size;
+	auto valid = [&](std::vector<rect> const& placed) {
+		for(size_t i = 0; i < placed.size(); ++i) {
+			auto const& a = placed[i];
+			if(a.x < 0 || a.y < 0 || a.x + a.w > size || a.y + a.h > size)
+				return false;
+			for(size_t j = i + 1; j < placed.size(); ++j) {
+				auto const& b = placed[j];
+				if(a.x < b.x + b.w && b.x < a.x + a.w && a.y < b.y + b.h && b.y < a.y + a.h)
+					return false;
+			}
+		}
+		return true;
+	};
+
+	SECTION("flags") {
+		// 93 x 64 flags with their padding
+		int32_t const w = 93 + 2 * ogl::flag_atlas::padding;
+		int32_t const h = 64 + 2 * ogl::flag_atlas::padding;
+		ogl::skyline_packer packer(size, size);
+		std::vector<rect> placed;
+		for(auto p = packer.insert(w, h); p.placed; p = packer.insert(w, h))
+			placed.push_back(rect{ p.x, p.y, w, h });
+
+		REQUIRE(placed.size() == size_t((size / w) * (size / h)));
+		REQUIRE(packer.occupancy() > 0.95f);
+		REQUIRE(valid(placed));
+
+		packer.clear();
+		REQUIRE(packer.used() == 0);
+		auto p = packer.insert(w, h);
+		REQUIRE(p.placed);
+		REQUIRE(p.x == 0);
+		REQUIRE(p.y == 0);
+	}
+	SECTION("mixed sizes") {
+		auto pack = [&](std::vector<rect>& placed) {
+			uint32_t seed = 12345;
+			auto next = [&]() {
+				seed = seed * 1664525u + 1013904223u;
+				return seed >> 16;
+			};
+			ogl::skyline_packer packer(size, size);
+			for(uint32_t i = 0; i < 3000; ++i) {
+				auto w = int32_t(16 + next() % 112);
+				auto h = int32_t(16 + next() % 80);
+				auto p = packer.insert(w, h);
+				if(p.placed)
+					placed.push_back(rect{ p.x, p.y, w, h });
+			}
+			return packer.occupancy();
+		};
+		std::vector<rect> first;
+		std::vector<rect> second;
+		auto occupancy = pack(first);
+		pack(second);
+
+		REQUIRE(occupancy > 0.85f);
+		REQUIRE(valid(first));
+		REQUIRE(first == second);
+	}
+	SECTION("too large") {
+		ogl::skyline_packer packer(size, size);
+		REQUIRE(!packer.insert(size + 1, 10).placed);
+		REQUIRE(!packer.insert(0, 10).placed);
+		REQUIRE(packer.insert(size, size).placed);
+		REQUIRE(!packer.insert(1, 1).placed);
+		REQUIRE(packer.occupancy() == 1.0f);
+	}
+}
+
+TEST_CASE("triple buffer tests", "[misc_tests]") {
+	SECTION("nothing to acquire before a publish") {
+		triple_buffer<int> b;
+		REQUIRE(!b.acquire());
+		b.write_buffer() = 1;
+		b.publish();
+		REQUIRE(b.acquire());
+		REQUIRE(b.read_buffer() == 1);
+		REQUIRE(!b.acquire());
+		REQUIRE(b.read_buffer() == 1);
+	}
+	SECTION("the reader gets the newest copy") {
+		triple_buffer<int> b;
+		for(int i = 1; i <= 5; ++i) {
+			b.write_buffer() = i;
+			b.publish();
+		}
+		REQUIRE(b.acquire());
+		REQUIRE(b.read_buffer() == 5);
+	}
+	SECTION("copies are never torn") {
+		triple_buffer<std::vector<uint32_t>> b;
+		constexpr uint32_t frames = 20000;
+		std::thread writer([&]() {
+			for(uint32_t i = 1; i <= frames; ++i) {
+				auto& v = b.write_buffer();
+				v.assign(64, i);
+				b.publish();
+			}
+		});
+		uint32_t last = 0;
+		bool torn = false;
+		bool backwards = false;
+		while(last < frames) {
+			if(!b.acquire())
+				continue;
+			auto const& v = b.read_buffer();
+			REQUIRE(v.size() == 64);
+			for(auto x : v)
+				torn = torn || x != v[0];
+			backwards = backwards || v[0] <= last;
+			last = v[0];
+		}
+		writer.join();
+		REQUIRE(!torn);
+		REQUIRE(!backwards);
+	}
+}
+
+TEST_CASE("sorted list model tests", "[misc_tests]") {
+	std::vector<float> values{ 5.0f, 1.0f, 3.0f, 1.0f, 4.0f, 2.0f };
+	auto key = [&](uint32_t i) { return values[i]; };
+	ui::sorted_list_model<uint32_t> model;
+	std::vector<uint32_t> rows;
+
+	auto walk = [&]() {
+		auto& c = model.candidates();
+		for(uint32_t i = 0; i < values.size(); ++i)
+			c.push_back(i);
+	};
+
+	walk();
+	REQUIRE(model.update(0, true, key, rows));
+	REQUIRE(model.last_full_sort);
+	REQUIRE(rows == std::vector<uint32_t>{ 1, 3, 5, 2, 4, 0 });
+
+	// nothing changed
+	walk();
+	REQUIRE(!model.update(0, true, key, rows));
+	REQUIRE(!model.last_full_sort);
+
+	// a key moved: repaired in place
+	values[0] = 0.5f;
+	walk();
+	REQUIRE(model.update(0, true, key, rows));
+	REQUIRE(!model.last_full_sort);
+	REQUIRE(model.last_moves == 5);
+	REQUIRE(rows == std::vector<uint32_t>{ 0, 1, 3, 5, 2, 4 });
+
+	// descending is the reverse, ties included
+	walk();
+	REQUIRE(model.update(0, false, key, rows));
+	REQUIRE(model.last_full_sort);
+	REQUIRE(rows == std::vector<uint32_t>{ 4, 2, 5, 3, 1, 0 });
+
+	// a different set of members
+	values.push_back(2.5f);
+	walk();
+	REQUIRE(model.update(0, false, key, rows));
+	REQUIRE(model.last_full_sort);
+	REQUIRE(rows == std::vector<uint32_t>{ 4, 2, 6, 5, 3, 1, 0 });
+}
+
+TEST_CASE("tooltip layout cache tests", "[misc_tests]") {
+	text::layout_cache cache;
+	int sources[text::layout_cache::capacity + 1];
+	auto key_for = [&](uint32_t i) {
+		return text::layout_cache_key{ &sources[i], 0, 0, 100, 1, 1, uint16_t(10), dcon::nation_id{ dcon::nation_id::value_base_t(0) } };
+	};
+
+	REQUIRE(cache.find(key_for(0)) == nullptr);
+	cache.replace(key_for(0)).used_width = 7;
+	auto* e = cache.find(key_for(0));
+	REQUIRE(e != nullptr);
+	REQUIRE(e->used_width == 7);
+	REQUIRE(cache.hits == 1);
+	REQUIRE(cache.misses == 1);
+
+	// anything the layout may depend on changing makes it a different entry
+	auto k = key_for(0);
+	k.content_generation = 2;
+	REQUIRE(cache.find(k) == nullptr);
+	k = key_for(0);
+	k.command_generation = 2;
+	REQUIRE(cache.find(k) == nullptr);
+	k = key_for(0);
+	k.date = 11;
+	REQUIRE(cache.find(k) == nullptr);
+	k = key_for(0);
+	k.player = dcon::nation_id{ dcon::nation_id::value_base_t(1) };
+	REQUIRE(cache.find(k) == nullptr);
+	k = key_for(0);
+	k.x = 1;
+	REQUIRE(cache.find(k) == nullptr);
+	REQUIRE(cache.find(key_for(0)) != nullptr);
+
+	// when full, the least recently used entry is the one replaced
+	for(uint32_t i = 1; i < text::layout_cache::capacity; ++i)
+		cache.replace(key_for(i));
+	REQUIRE(cache.find(key_for(0)) != nullptr);
+	cache.replace(key_for(text::layout_cache::capacity));
+	REQUIRE(cache.find(key_for(0)) != nullptr);
+	REQUIRE(cache.find(key_for(1)) == nullptr);
+	for(uint32_t i = 2; i <= text::layout_cache::capacity; ++i)
+		REQUIRE(cache.find(key_for(i)) != nullptr);
+
+	cache.clear();
+	REQUIRE(cache.find(key_for(0)) == nullptr);
+}
+
+#ifndef _WIN64
+namespace {
+
+std::atomic<uint32_t> sound_allocations = 0;
+
+ma_allocation_callbacks counting_callbacks() {
+	ma_allocation_callbacks c{};
+	c.onMalloc = [](size_t sz, void*) -> void* {
+		sound_allocations.fetch_add(1, std::memory_order::relaxed);
+		return malloc(sz);
+	};
+	c.onRealloc = [](void* p, size_t sz, void*) -> void* {
+		sound_allocations.fetch_add(1, std::memory_order::relaxed);
+		return realloc(p, sz);
+	};
+	c.onFree = [](void* p, void*) { free(p); };
+	return c;
+}
+
+ma_engine_config null_device_config() {
+	auto config = ma_engine_config_init();
+	config.noDevice = MA_TRUE;
+	config.channels = 2;
+	config.sampleRate = 44100;
+	config.allocationCallbacks = counting_callbacks();
+	return config;
+}
+
+// a sine tone, written to a temporary wav file
+std::string write_test_tone(char const* name, uint32_t frames) {
+	auto path = (std::filesystem::temp_directory_path() / name).string();
+	auto config = ma_encoder_config_init(ma_encoding_format_wav, ma_format_f32, 2, 44100);
+	ma_encoder encoder;
+	REQUIRE(ma_encoder_init_file(path.c_str(), &config, &encoder) == MA_SUCCESS);
+	std::vector<float> samples(size_t(frames) * 2);
+	for(uint32_t i = 0; i < frames; ++i)
+		samples[2 * i] = samples[2 * i + 1] = 0.5f * std::sin(float(i) * 0.06f);
+	ma_encoder_write_pcm_frames(&encoder, samples.data(), frames, nullptr);
+	ma_encoder_uninit(&encoder);
+	return path;
+}
+
+float peak_of_next_frames(sound::sound_impl& sound, uint32_t frames) {
+	std::vector<float> out(size_t(frames) * 2);
+	ma_uint64 read = 0;
+	ma_engine_read_pcm_frames(&sound.engine, out.data(), frames, &read);
+	float peak = 0.0f;
+	for(auto v : out)
+		peak = std::max(peak, std::abs(v));
+	return peak;
+}
+
+} // namespace
+
+TEST_CASE("sound asset tests", "[misc_tests]") {
+	auto sound = std::make_unique<sound::sound_impl>(null_device_config());
+
+	sound::audio_instance click;
+	click.filename = write_test_tone("alice_test_click.wav", 2000);
+	sound::audio_instance missing;
+	missing.filename = (std::filesystem::temp_directory_path() / "alice_test_missing.wav").string();
+	sound->load_effect(click);
+	sound->load_effect(missing);
+	REQUIRE(click.clip != nullptr);
+	REQUIRE(click.clip->frame_count == 2000);
+	REQUIRE(missing.clip == nullptr);
+
+	SECTION("effects play from the cache without allocating") {
+		auto before = sound_allocations.load();
+		for(uint32_t i = 0; i < 1000; ++i)
+			sound->override_sound(sound->current_interface_sound, (i % 2 == 0) ? click : missing, 1.0f);
+		sound->override_sound(sound->current_interface_sound, click, 1.0f);
+		REQUIRE(sound_allocations.load() == before);
+
+		REQUIRE(peak_of_next_frames(*sound, 1000) > 0.1f);
+		REQUIRE(peak_of_next_frames(*sound, 2000) < 0.5f);
+		REQUIRE(peak_of_next_frames(*sound, 1000) == 0.0f);
+
+		// played again after it ended
+		sound->override_sound(sound->current_interface_sound, click, 1.0f);
+		REQUIRE(peak_of_next_frames(*sound, 1000) > 0.1f);
+		sound->override_sound(sound->current_interface_sound, missing, 1.0f);
+		REQUIRE(peak_of_next_frames(*sound, 1000) == 0.0f);
+	}
+	SECTION("music streams from the decoder thread") {
+		sound->music_list.emplace_back();
+		sound->music_list.back().filename = write_test_tone("alice_test_music.wav", 44100 * 3);
+		REQUIRE(sound->music_finished());
+		sound->play_music(0, 1.0f);
+		REQUIRE(!sound->music_finished());
+
+		float peak = 0.0f;
+		uint32_t periods = 0;
+		for(; periods < 2000 && !sound->music_finished(); ++periods) {
+			peak = std::max(peak, peak_of_next_frames(*sound, 441));
+			std::this_thread::sleep_for(std::chrono::microseconds(200));
+		}
+		REQUIRE(sound->music_finished());
+		REQUIRE(periods >= 300);
+		REQUIRE(peak > 0.1f);
+	}
+}
+
+TEST_CASE("sound effect performance", "[benchmarks]") {
+	auto sound = std::make_unique<sound::sound_impl>(null_device_config());
+	sound::audio_instance click;
+	click.filename = write_test_tone("alice_test_click.wav", 2000);
+	sound->load_effect(click);
+
+	BENCHMARK_ADVANCED("effect opened from file on every play")
+	(Catch::Benchmark::Chronometer meter) {
+		ma_sound s;
+		meter.measure([&]() {
+			if(ma_sound_init_from_file(&sound->engine, click.filename.c_str(), 0, nullptr, nullptr, &s) == MA_SUCCESS) {
+				ma_sound_start(&s);
+				ma_sound_uninit(&s);
+			}
+		});
+	};
+	BENCHMARK_ADVANCED("effect played from the decoded cache")
+	(Catch::Benchmark::Chronometer meter) {
+		meter.measure([&]() { sound->override_sound(sound->current_effect, click, 1.0f); });
+	};
+}
+#endif
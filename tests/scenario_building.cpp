@@ -1,10 +1,16 @@
+#include <random>
+#include <functional>
 #include "catch.hpp"
 #include "parsers_declarations.hpp"
 #include "dcon_generated.hpp"
 #include "nations.hpp"
+#include "demographics.hpp"
+#include "economy.hpp"
+#include "province.hpp"
 #include "container_types.hpp"
 #include "system_state.hpp"
 #include "serialization.hpp"
+#include "gui_list_model.hpp"
 
 /*
 * parsers::scenario_building_context context(*this);
@@ -1383,6 +1389,27 @@ TEST_CASE("Scenario building", "[req-game-files]") {
 	// Ensure the filesystem state is properly loaded back
 	REQUIRE(simple_fs::extract_state(state->common_fs) == fs_str);
 
+	// The uncompressed, page aligned layout must load the same scenario as the compressed one
+	{
+		sys::write_scenario_file(*state, NATIVE("sb_test_file_mapped.bin"), 1, sys::scenario_layout::mapped);
+		auto mapped_state = std::make_unique<sys::state>();
+		REQUIRE(sys::try_read_scenario_and_save_file(*mapped_state, NATIVE("sb_test_file_mapped.bin")) == true);
+		mapped_state->game_seed = state->game_seed;
+		mapped_state->fill_unsaved_data();
+
+		REQUIRE(mapped_state->scenario_checksum.is_equal(state->scenario_checksum));
+		REQUIRE(simple_fs::extract_state(mapped_state->common_fs) == fs_str);
+
+		auto scenario_space = sys::sizeof_scenario_section(*state);
+		REQUIRE(sys::sizeof_scenario_section(*mapped_state) == scenario_space);
+		std::vector<uint8_t> compressed_section(scenario_space);
+		std::vector<uint8_t> mapped_section(scenario_space);
+		sys::write_scenario_section(compressed_section.data(), *state);
+		sys::write_scenario_section(mapped_section.data(), *mapped_state);
+		REQUIRE(compressed_section == mapped_section);
+		REQUIRE(mapped_state->get_save_checksum().is_equal(state->get_save_checksum()));
+	}
+
 	{
 		auto tag = fatten(state->world, context.map_of_ident_names.find(nations::tag_to_int('N', 'E', 'J'))->second);
 		int32_t non_def_count = 0;
@@ -2034,6 +2061,35 @@ BENCHMARK_ADVANCED("vectorized loop exchanged maximum")(Catch::Benchmark::Chrono
 // ***************************/
 }
 
+TEST_CASE("event trigger prefilter", "[req-game-files]") {
+	auto ws = load_testing_scenario_file();
+	auto& state = *ws;
+
+	// the prefilter may only skip nations / provinces that cannot pass the trigger, so the events that fire must be
+	// exactly those found by evaluating the triggers over everything
+	for(uint32_t k = 0; k < 64; ++k) {
+		for(auto e : state.world.in_free_national_event) {
+			std::vector<event::event_nation_pair> filtered;
+			std::vector<event::event_nation_pair> full;
+			event::find_triggered_events(state, e, filtered, true);
+			event::find_triggered_events(state, e, full, false);
+			std::sort(filtered.begin(), filtered.end());
+			std::sort(full.begin(), full.end());
+			REQUIRE(filtered == full);
+		}
+		for(auto e : state.world.in_free_provincial_event) {
+			std::vector<event::event_prov_pair> filtered;
+			std::vector<event::event_prov_pair> full;
+			event::find_triggered_events(state, e, filtered, true);
+			event::find_triggered_events(state, e, full, false);
+			std::sort(filtered.begin(), filtered.end());
+			std::sort(full.begin(), full.end());
+			REQUIRE(filtered == full);
+		}
+		state.current_date = state.current_date + 97;
+	}
+}
+
 struct test_event_nation_pair {
 	dcon::nation_id n;
 	dcon::free_national_event_id e;
@@ -2173,6 +2229,455 @@ TEST_CASE("event performance", "[benchmarks]") {
 		});
 	};
 }
+
+TEST_CASE("pop layout performance", "[benchmarks]") {
+	auto ws = load_testing_scenario_file();
+	auto& state = *ws;
+
+	std::vector<float> province_sizes(state.world.province_size(), 0.0f);
+	for(auto p : state.world.in_pop) {
+		province_sizes[p.get_province_from_pop_location().id.index()] += p.get_size();
+	}
+
+	// scatter the pops to imitate a layout fragmented by months of pop creation and deletion
+	std::vector<dcon::pop_id> scrambled(state.world.pop_size());
+	for(uint32_t i = 0; i < state.world.pop_size(); ++i) {
+		scrambled[i] = dcon::pop_id{ dcon::pop_id::value_base_t(i) };
+	}
+	std::shuffle(scrambled.begin(), scrambled.end(), std::mt19937(808080));
+	demographics::reorder_pops(state, scrambled);
+
+	BENCHMARK_ADVANCED("demographics passes, scattered pops")
+	(Catch::Benchmark::Chronometer meter) {
+		meter.measure([&]() {
+			demographics::regenerate_from_pop_data(state);
+			demographics::update_militancy(state, 0, 1);
+			demographics::update_consciousness(state, 0, 1);
+			demographics::update_literacy(state, 0, 1);
+		});
+	};
+
+	demographics::compact_pops_by_location(state);
+
+	BENCHMARK_ADVANCED("demographics passes, pops ordered by province")
+	(Catch::Benchmark::Chronometer meter) {
+		meter.measure([&]() {
+			demographics::regenerate_from_pop_data(state);
+			demographics::update_militancy(state, 0, 1);
+			demographics::update_consciousness(state, 0, 1);
+			demographics::update_literacy(state, 0, 1);
+		});
+	};
+
+	for(uint32_t i = 1; i < state.world.pop_size(); ++i) {
+		dcon::pop_id a{ dcon::pop_id::value_base_t(i - 1) };
+		dcon::pop_id b{ dcon::pop_id::value_base_t(i) };
+		REQUIRE(state.world.pop_get_province_from_pop_location(a).index() <= state.world.pop_get_province_from_pop_location(b).index());
+	}
+	std::vector<float> compacted_sizes(state.world.province_size(), 0.0f);
+	for(auto p : state.world.in_province) {
+		for(auto pl : p.get_pop_location()) {
+			compacted_sizes[p.id.index()] += pl.get_pop().get_size();
+		}
+	}
+	for(uint32_t i = 0; i < state.world.province_size(); ++i) {
+		REQUIRE(compacted_sizes[i] == Approx(province_sizes[i]));
+	}
+}
+
+TEST_CASE("province graph performance", "[benchmarks]") {
+	auto ws = load_testing_scenario_file();
+	auto& state = *ws;
+	auto& graph = state.province_definitions.adjacency;
+	auto province_count = state.world.province_size();
+
+	std::vector<dcon::province_id> order;
+	std::vector<uint8_t> visited;
+	auto bfs_relationship = [&]() {
+		order.clear();
+		visited.assign(province_count, 0);
+		for(uint32_t s = 0; s < province_count; ++s) {
+			if(visited[s])
+				continue;
+			visited[s] = 1;
+			order.push_back(dcon::province_id{ dcon::province_id::value_base_t(s) });
+			for(size_t k = order.size() - 1; k < order.size(); ++k) {
+				auto p = order[k];
+				for(auto adj : state.world.province_get_province_adjacency(p)) {
+					auto other = adj.get_connected_provinces(0) == p ? adj.get_connected_provinces(1) : adj.get_connected_provinces(0);
+					if((adj.get_type() & province::border::impassible_bit) == 0 && !visited[other.id.index()]) {
+						visited[other.id.index()] = 1;
+						order.push_back(other);
+					}
+				}
+			}
+		}
+	};
+	auto bfs_graph = [&]() {
+		order.clear();
+		visited.assign(province_count, 0);
+		for(uint32_t s = 0; s < province_count; ++s) {
+			if(visited[s])
+				continue;
+			visited[s] = 1;
+			order.push_back(dcon::province_id{ dcon::province_id::value_base_t(s) });
+			for(size_t k = order.size() - 1; k < order.size(); ++k) {
+				auto p = order[k];
+				for(auto i = graph.offsets[p.index()]; i < graph.offsets[p.index() + 1]; ++i) {
+					auto other = graph.neighbors[i];
+					if((graph.types[i] & province::border::impassible_bit) == 0 && !visited[other.index()]) {
+						visited[other.index()] = 1;
+						order.push_back(other);
+					}
+				}
+			}
+		}
+	};
+
+	bfs_relationship();
+	auto relationship_order = order;
+	bfs_graph();
+	REQUIRE(relationship_order == order);
+
+	// a pair of distant land provinces for the path search: the last province a land-only search from start reaches
+	dcon::province_id start{ 0 };
+	dcon::province_id end = start;
+	order.clear();
+	visited.assign(province_count, 0);
+	visited[start.index()] = 1;
+	order.push_back(start);
+	for(size_t k = 0; k < order.size(); ++k) {
+		auto p = order[k];
+		for(auto adj : state.world.province_get_province_adjacency(p)) {
+			auto other = adj.get_connected_provinces(0) == p ? adj.get_connected_provinces(1) : adj.get_connected_provinces(0);
+			if((adj.get_type() & (province::border::impassible_bit | province::border::coastal_bit)) == 0 && !visited[other.id.index()]) {
+				visited[other.id.index()] = 1;
+				order.push_back(other);
+				end = other;
+			}
+		}
+	}
+	REQUIRE(end != start);
+
+	// the reference path: the same search as make_unowned_land_path, but over the relationship
+	struct search_node {
+		float distance_covered = 0.0f;
+		float distance_to_target = 0.0f;
+		dcon::province_id province;
+		bool operator<(search_node const& other) const noexcept {
+			if(other.distance_covered + other.distance_to_target != distance_covered + distance_to_target)
+				return distance_covered + distance_to_target > other.distance_covered + other.distance_to_target;
+			return other.province.index() > province.index();
+		}
+	};
+	auto reference_path = [&]() {
+		std::vector<search_node> heap;
+		std::vector<dcon::province_id> origins(province_count);
+		std::vector<dcon::province_id> result;
+		heap.push_back(search_node{ 0.0f, province::direct_distance(state, start, end), start });
+		while(!heap.empty()) {
+			std::pop_heap(heap.begin(), heap.end());
+			auto nearest = heap.back();
+			heap.pop_back();
+			for(auto adj : state.world.province_get_province_adjacency(nearest.province)) {
+				auto other = adj.get_connected_provinces(0) == nearest.province ? adj.get_connected_provinces(1) : adj.get_connected_provinces(0);
+				auto bits = adj.get_type();
+				if((bits & province::border::impassible_bit) != 0 || origins[other.id.index()])
+					continue;
+				if(other == end) {
+					result.push_back(end);
+					for(auto i = nearest.province; i && i != start; i = origins[i.index()])
+						result.push_back(i);
+					return result;
+				}
+				if((bits & province::border::coastal_bit) == 0) {
+					heap.push_back(search_node{ nearest.distance_covered + adj.get_distance(), province::direct_distance(state, other, end), other });
+					std::push_heap(heap.begin(), heap.end());
+					origins[other.id.index()] = nearest.province;
+				}
+			}
+		}
+		return result;
+	};
+	auto path = reference_path();
+	REQUIRE(!path.empty());
+	REQUIRE(province::make_unowned_land_path(state, start, end) == path);
+
+	BENCHMARK_ADVANCED("full map bfs over relationship")
+	(Catch::Benchmark::Chronometer meter) {
+		meter.measure([&]() { bfs_relationship(); });
+	};
+	BENCHMARK_ADVANCED("full map bfs over csr graph")
+	(Catch::Benchmark::Chronometer meter) {
+		meter.measure([&]() { bfs_graph(); });
+	};
+	BENCHMARK_ADVANCED("unowned land path over csr graph")
+	(Catch::Benchmark::Chronometer meter) {
+		meter.measure([&]() { return province::make_unowned_land_path(state, start, end).size(); });
+	};
+	REQUIRE(province::make_unowned_land_path(state, start, end) == path);
+}
+
+TEST_CASE("pop consumption kernel performance", "[benchmarks]") {
+	auto ws = load_testing_scenario_file();
+	auto& state = *ws;
+
+	auto ln = state.world.pop_type_make_vectorizable_float_buffer();
+	auto en = state.world.pop_type_make_vectorizable_float_buffer();
+	auto lx = state.world.pop_type_make_vectorizable_float_buffer();
+	float base_demand = state.defines.base_goods_demand;
+	float invention_factor = 1.0f;
+	auto total_commodities = state.world.commodity_size();
+
+	auto clear_buffers = [&]() {
+		state.world.for_each_pop_type([&](dcon::pop_type_id t) {
+			ln.set(t, 0.0f);
+			en.set(t, 0.0f);
+			lx.set(t, 0.0f);
+		});
+	};
+
+	// the old path: every province turns its own pop type totals into commodity demand, one commodity at a time
+	auto scalar_pass = [&]() {
+		for(auto n : state.world.in_nation) {
+			state.world.for_each_commodity([&](dcon::commodity_id c) { state.world.nation_set_real_demand(n, c, 0.0f); });
+			float ln_mul[] = { n.get_modifier_values(sys::national_mod_offsets::poor_life_needs) + 1.0f,
+					n.get_modifier_values(sys::national_mod_offsets::middle_life_needs) + 1.0f,
+					n.get_modifier_values(sys::national_mod_offsets::rich_life_needs) + 1.0f };
+			float en_mul[] = { n.get_modifier_values(sys::national_mod_offsets::poor_everyday_needs) + 1.0f,
+					n.get_modifier_values(sys::national_mod_offsets::middle_everyday_needs) + 1.0f,
+					n.get_modifier_values(sys::national_mod_offsets::rich_everyday_needs) + 1.0f };
+			float lx_mul[] = { n.get_modifier_values(sys::national_mod_offsets::poor_luxury_needs) + 1.0f,
+					n.get_modifier_values(sys::national_mod_offsets::middle_luxury_needs) + 1.0f,
+					n.get_modifier_values(sys::national_mod_offsets::rich_luxury_needs) + 1.0f };
+			for(auto o : n.get_province_ownership()) {
+				clear_buffers();
+				economy::update_pop_consumption(state, n, o.get_province(), ln, en, lx);
+				state.world.for_each_pop_type([&](dcon::pop_type_id t) {
+					auto strata = state.world.pop_type_get_strata(t);
+					for(uint32_t i = 1; i < total_commodities; ++i) {
+						dcon::commodity_id cid{ dcon::commodity_id::value_base_t(i) };
+						auto kf = state.world.commodity_get_key_factory(cid);
+						if(state.world.commodity_get_is_available_from_start(cid) || (kf && state.world.nation_get_active_building(n, kf))) {
+							state.world.nation_get_real_demand(n, cid) += state.world.pop_type_get_life_needs(t, cid) * ln.get(t) * base_demand * ln_mul[strata] * (state.world.nation_get_life_needs_weights(n, cid) + 1.0f);
+							state.world.nation_get_real_demand(n, cid) += state.world.pop_type_get_everyday_needs(t, cid) * en.get(t) * base_demand * invention_factor * en_mul[strata] * (state.world.nation_get_everyday_needs_weights(n, cid) + 1.0f) * economy::en_extra_factor;
+							state.world.nation_get_real_demand(n, cid) += state.world.pop_type_get_luxury_needs(t, cid) * lx.get(t) * base_demand * invention_factor * lx_mul[strata] * (state.world.nation_get_luxury_needs_weights(n, cid) + 1.0f) * economy::lx_extra_factor;
+						}
+					}
+				});
+			}
+		}
+	};
+	auto vector_pass = [&]() {
+		for(auto n : state.world.in_nation) {
+			state.world.for_each_commodity([&](dcon::commodity_id c) { state.world.nation_set_real_demand(n, c, 0.0f); });
+			clear_buffers();
+			for(auto o : n.get_province_ownership()) {
+				economy::update_pop_consumption(state, n, o.get_province(), ln, en, lx);
+			}
+			economy::update_pop_needs_demand(state, n, ln, en, lx, base_demand, invention_factor);
+		}
+	};
+
+	scalar_pass();
+	std::vector<float> scalar_demand;
+	for(auto n : state.world.in_nation) {
+		for(auto c : state.world.in_commodity)
+			scalar_demand.push_back(state.world.nation_get_real_demand(n, c));
+	}
+	vector_pass();
+	uint32_t k = 0;
+	for(auto n : state.world.in_nation) {
+		for(auto c : state.world.in_commodity) {
+			REQUIRE(state.world.nation_get_real_demand(n, c) == Approx(scalar_demand[k]).epsilon(0.001).margin(0.0001));
+			++k;
+		}
+	}
+
+	BENCHMARK_ADVANCED("pop needs demand, scalar per province")
+	(Catch::Benchmark::Chronometer meter) {
+		meter.measure([&]() { scalar_pass(); });
+	};
+	BENCHMARK_ADVANCED("pop needs demand, vectorized per nation")
+	(Catch::Benchmark::Chronometer meter) {
+		meter.measure([&]() { vector_pass(); });
+	};
+}
+TEST_CASE("string pool lookup performance", "[benchmarks]") {
+	auto ws = load_testing_scenario_file();
+	auto& state = *ws;
+
+	// the old lookup: scan forward from the start of the text for its terminating zero
+	auto scanned = [&](dcon::text_key tag) {
+		if(!tag)
+			return std::string_view();
+		auto start = state.text_data.data() + tag.index();
+		auto end = std::find(start, state.text_data.data() + state.text_data.size(), char(0));
+		return std::string_view(start, size_t(end - start));
+	};
+	// what laying out a large tooltip resolves: every text component of every line
+	auto resolve_all = [&](auto&& lookup) {
+		size_t total = 0;
+		for(auto& c : state.text_components) {
+			if(std::holds_alternative<dcon::text_key>(c))
+				total += lookup(std::get<dcon::text_key>(c)).length();
+		}
+		return total;
+	};
+
+	for(auto& c : state.text_components) {
+		if(std::holds_alternative<dcon::text_key>(c)) {
+			auto k = std::get<dcon::text_key>(c);
+			REQUIRE(state.to_string_view(k) == scanned(k));
+		}
+	}
+	for(uint32_t i = 0; i < state.unit_names_indices.size(); ++i) {
+		dcon::unit_name_id n{ dcon::unit_name_id::value_base_t(i) };
+		REQUIRE(state.to_string_view(n) == std::string_view(state.unit_names.data() + state.unit_names_indices[i]));
+	}
+
+	BENCHMARK_ADVANCED("text components, scanned")
+	(Catch::Benchmark::Chronometer meter) {
+		meter.measure([&]() { return resolve_all(scanned); });
+	};
+	BENCHMARK_ADVANCED("text components, indexed terminators")
+	(Catch::Benchmark::Chronometer meter) {
+		meter.measure([&]() { return resolve_all([&](dcon::text_key k) { return state.to_string_view(k); }); });
+	};
+}
+TEST_CASE("trigger interning performance", "[benchmarks]") {
+	auto ws = load_testing_scenario_file();
+	auto& state = *ws;
+
+	// the committed triggers of the test scenario, in the order they were committed (key 0 is the placeholder);
+	// the old search is quadratic, so only a prefix is replayed
+	std::vector<std::vector<uint16_t>> scripts;
+	for(size_t k = 1; k < state.trigger_data_indices.size() && scripts.size() < 4000; ++k) {
+		auto start = state.trigger_data.data() + state.trigger_data_indices[k];
+		scripts.emplace_back(start, start + 1 + trigger::get_trigger_payload_size(start));
+	}
+	REQUIRE(scripts.size() > 0);
+
+	// the old commit: search the whole pool, then search the indices for the start position
+	std::vector<uint16_t> searched_data;
+	std::vector<int32_t> searched_indices;
+	auto commit_searched = [&](std::vector<uint16_t> const& data) {
+		if(searched_indices.empty()) {
+			searched_indices.push_back(0);
+			searched_data.push_back(uint16_t(trigger::always | trigger::no_payload | trigger::association_ne));
+		}
+		auto search_result = std::search(searched_data.data() + 1, searched_data.data() + searched_data.size(),
+				std::boyer_moore_horspool_searcher(data.data(), data.data() + data.size()));
+		if(search_result != searched_data.data() + searched_data.size()) {
+			auto const start = search_result - searched_data.data();
+			auto it = std::find(searched_indices.begin(), searched_indices.end(), int32_t(start));
+			if(it != searched_indices.end())
+				return dcon::trigger_key(dcon::trigger_key::value_base_t(std::distance(searched_indices.begin(), it) - 1));
+			searched_indices.push_back(int32_t(start));
+		} else {
+			searched_indices.push_back(int32_t(searched_data.size()));
+			searched_data.insert(searched_data.end(), data.begin(), data.end());
+		}
+		return dcon::trigger_key(dcon::trigger_key::value_base_t(searched_indices.size() - 1 - 1));
+	};
+	auto replay_searched = [&]() {
+		searched_data.clear();
+		searched_indices.clear();
+		uint32_t total = 0;
+		for(auto& s : scripts)
+			total += commit_searched(s).index();
+		return total;
+	};
+
+	// the indexed commit, into the pools of a scratch state
+	auto scratch = std::make_unique<sys::state>();
+	auto replay_indexed = [&]() {
+		scratch->trigger_data.clear();
+		scratch->trigger_data_indices.clear();
+		uint32_t total = 0;
+		for(auto& s : scripts)
+			total += scratch->commit_trigger_data(s).index();
+		return total;
+	};
+
+	REQUIRE(replay_searched() == replay_indexed());
+	REQUIRE(scratch->trigger_data == searched_data);
+	REQUIRE(scratch->trigger_data_indices == searched_indices);
+
+	BENCHMARK_ADVANCED("trigger interning, searched")
+	(Catch::Benchmark::Chronometer meter) {
+		meter.measure([&]() { return replay_searched(); });
+	};
+	BENCHMARK_ADVANCED("trigger interning, indexed")
+	(Catch::Benchmark::Chronometer meter) {
+		meter.measure([&]() { return replay_indexed(); });
+	};
+}
+
+TEST_CASE("pop list performance", "[benchmarks]") {
+	auto ws = load_testing_scenario_file();
+	auto& state = *ws;
+
+	// every pop in the world, walked the way the population window walks a nation: a worst case for the list
+	auto walk = [&](std::vector<dcon::pop_id>& out) {
+		for(auto p : state.world.in_province) {
+			for(auto pl : p.get_pop_location())
+				out.push_back(pl.get_pop().id);
+		}
+	};
+	auto size_key = [&](dcon::pop_id p) { return -state.world.pop_get_size(p); };
+	auto rebuild = [&](std::vector<dcon::pop_id>& rows) {
+		rows.clear();
+		walk(rows);
+		std::function<bool(dcon::pop_id, dcon::pop_id)> fn = [&](dcon::pop_id a, dcon::pop_id b) {
+			return dcon::fatten(state.world, a).get_size() > dcon::fatten(state.world, b).get_size();
+		};
+		std::stable_sort(rows.begin(), rows.end(), [&](dcon::pop_id a, dcon::pop_id b) { return fn(a, b); });
+	};
+	// move a few pops a little, as a day of growth and promotion does
+	uint32_t drift_round = 0;
+	auto drift = [&]() {
+		++drift_round;
+		for(uint32_t i = drift_round % 97; i < state.world.pop_size(); i += 97) {
+			dcon::pop_id p{ dcon::pop_id::value_base_t(i) };
+			state.world.pop_set_size(p, state.world.pop_get_size(p) * ((i + drift_round) % 2 == 0 ? 1.01f : 0.99f));
+		}
+	};
+
+	std::vector<dcon::pop_id> expected;
+	std::vector<dcon::pop_id> rows;
+	ui::sorted_list_model<dcon::pop_id> model;
+	for(uint32_t round = 0; round < 3; ++round) {
+		rebuild(expected);
+		walk(model.candidates());
+		model.update(0, true, size_key, rows);
+		REQUIRE(rows == expected);
+		drift();
+	}
+	rebuild(expected);
+	walk(model.candidates());
+	model.update(0, false, size_key, rows);
+	std::reverse(expected.begin(), expected.end());
+	REQUIRE(rows == expected);
+
+	BENCHMARK_ADVANCED("pop list, full rebuild")
+	(Catch::Benchmark::Chronometer meter) {
+		meter.measure([&]() {
+			drift();
+			rebuild(rows);
+			return rows.size();
+		});
+	};
+	BENCHMARK_ADVANCED("pop list, incremental model")
+	(Catch::Benchmark::Chronometer meter) {
+		meter.measure([&]() {
+			drift();
+			walk(model.candidates());
+			model.update(0, true, size_key, rows);
+			return rows.size();
+		});
+	};
+}
 //
 //TEST_CASE(".mod overrides", "[req-game-files]") {
 //	parsers::error_handler err("");
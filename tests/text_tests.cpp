@@ -1,5 +1,6 @@
 #include "catch.hpp"
 #include "text.hpp"
+#include "name_search.hpp"
 
 TEST_CASE("text from csv", "[parsers]") {
 	SECTION("sample_lines") {
@@ -46,6 +47,42 @@ TEST_CASE("text from csv", "[parsers]") {
 	}
 }
 
+TEST_CASE("name search index", "[parsers]") {
+	search::name_index index;
+	index.add(search::kind::province, 1, "Berlin");
+	index.add(search::kind::province, 2, "Bern");
+	index.add(search::kind::nation, 3, "\xD6sterreich"); // win1250 O with diaeresis
+	index.add(search::kind::province, 4, "West Berlin");
+	index.add(search::kind::state, 5, "Oberland");
+	index.finish();
+
+	std::array<search::result, 8> out{};
+	uint32_t budget = 1000;
+	auto count = index.query("ber", search::all_kinds, out, 0, budget);
+	REQUIRE(count == 4);
+	REQUIRE(out[0].id == 2); // prefix matches first, shorter names first
+	REQUIRE(out[1].id == 1);
+	REQUIRE(out[2].id == 4); // then a match at the start of a word
+	REQUIRE(out[2].quality == search::match::word_prefix);
+	REQUIRE(out[3].id == 5);
+	REQUIRE(out[3].quality == search::match::substring);
+
+	count = index.query("bern", search::kind_bit(search::kind::province), out, 0, budget);
+	REQUIRE(count == 1);
+	REQUIRE(out[0].quality == search::match::exact);
+
+	char folded[16];
+	auto length = search::fold_name("\xD6STER", folded, 16);
+	count = index.query(std::string_view(folded, length), search::all_kinds, out, 0, budget);
+	REQUIRE(count == 1);
+	REQUIRE(out[0].type == search::kind::nation);
+
+	count = index.query("ber", search::all_kinds, std::span<search::result>(out.data(), 2), 0, budget);
+	REQUIRE(count == 2);
+	REQUIRE(out[0].id == 2);
+	REQUIRE(out[1].id == 1);
+}
+
 #ifndef IGNORE_REAL_FILES_TESTS
 TEST_CASE("text game files parsing", "[parsers]") {
 	SECTION("empty_file_with_types") {